@@ -70,6 +70,8 @@ set(HASH_FILES
     "${VIDEO_CORE}/renderer_opengl/gl_shader_gen.h"
     "${VIDEO_CORE}/shader/shader.cpp"
     "${VIDEO_CORE}/shader/shader.h"
+    "${VIDEO_CORE}/shader/shader_jit_x64_compiler.cpp"
+    "${VIDEO_CORE}/shader/shader_jit_x64_compiler.h"
     "${VIDEO_CORE}/pica.cpp"
     "${VIDEO_CORE}/pica.h"
     "${VIDEO_CORE}/regs_framebuffer.h"
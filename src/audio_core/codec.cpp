@@ -13,8 +13,9 @@
 
 namespace AudioCore::Codec {
 
-StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+void DecodeADPCM(const u8* const data, const std::size_t first_sample,
+                 const std::size_t sample_count, const std::array<s16, 16>& adpcm_coeff,
+                 ADPCMState& state, StereoBuffer16& output) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
@@ -24,16 +25,15 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
     constexpr std::array<int, 16> SIGNED_NIBBLES = {
         {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
 
-    const std::size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    StereoBuffer16 ret(ret_size);
-
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
+    // Decoding may start in the middle of a frame, when a buffer is decoded in several parts
+    std::size_t framei = first_sample / SAMPLES_PER_FRAME;
+    std::size_t samplei = first_sample % SAMPLES_PER_FRAME;
+    std::size_t remaining = sample_count;
+    while (remaining > 0) {
+        const u8* const frame = data + framei * FRAME_LEN;
+        const int frame_header = frame[0];
         const int scale = 1 << (frame_header & 0xF);
         const int idx = (frame_header >> 4) & 0x7;
 
@@ -57,69 +57,59 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
             return (s16)val;
         };
 
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
+        for (; samplei < SAMPLES_PER_FRAME && remaining > 0; samplei++, remaining--) {
+            // The high nibble of each byte comes first
+            const u8 byte = frame[1 + samplei / 2];
+            const int nibble = samplei % 2 == 0 ? byte >> 4 : byte & 0xF;
+            const s16 sample = decode_sample(SIGNED_NIBBLES[nibble]);
+            output.Push({sample, sample});
         }
+        samplei = 0;
+        framei++;
     }
 
     state.yn1 = static_cast<s16>(yn1);
     state.yn2 = static_cast<s16>(yn2);
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count) {
+void DecodePCM8(const unsigned num_channels, const u8* const data, const std::size_t first_sample,
+                const std::size_t sample_count, StereoBuffer16& output) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
     const auto decode_sample = [](u8 sample) {
         return static_cast<s16>(static_cast<u16>(sample) << 8);
     };
 
-    StereoBuffer16 ret(sample_count);
-
+    const u8* const samples = data + first_sample * num_channels;
     if (num_channels == 1) {
         for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(decode_sample(data[i]));
+            const s16 sample = decode_sample(samples[i]);
+            output.Push({sample, sample});
         }
     } else {
         for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = decode_sample(data[i * 2 + 0]);
-            ret[i][1] = decode_sample(data[i * 2 + 1]);
+            output.Push({decode_sample(samples[i * 2 + 0]), decode_sample(samples[i * 2 + 1])});
         }
     }
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count) {
+void DecodePCM16(const unsigned num_channels, const u8* const data, const std::size_t first_sample,
+                 const std::size_t sample_count, StereoBuffer16& output) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret(sample_count);
-
+    const u8* const samples = data + first_sample * num_channels * sizeof(s16);
     if (num_channels == 1) {
         for (std::size_t i = 0; i < sample_count; i++) {
             s16 sample;
-            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
+            std::memcpy(&sample, samples + i * sizeof(s16), sizeof(s16));
+            output.Push({sample, sample});
         }
     } else {
         for (std::size_t i = 0; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
+            StereoBuffer16::Sample sample;
+            std::memcpy(&sample, samples + i * sizeof(s16) * 2, 2 * sizeof(s16));
+            output.Push(sample);
         }
     }
-
-    return ret;
 }
 } // namespace AudioCore::Codec
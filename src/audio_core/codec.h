@@ -6,6 +6,7 @@
 
 #include <array>
 #include "audio_core/audio_types.h"
+#include "audio_core/stereo_buffer.h"
 #include "common/common_types.h"
 
 namespace AudioCore::Codec {
@@ -20,29 +21,36 @@ struct ADPCMState {
 
 /**
  * @param data Pointer to buffer that contains ADPCM data to decode
- * @param sample_count Length of buffer in terms of number of samples
+ * @param first_sample Index of the first sample to decode
+ * @param sample_count Number of samples to decode
  * @param adpcm_coeff ADPCM coefficients
  * @param state ADPCM state, this is updated with new state
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Buffer the decoded stereo signed PCM16 samples are appended to, it must have room
+ * for sample_count samples
  */
-StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state);
+void DecodeADPCM(const u8* const data, const std::size_t first_sample,
+                 const std::size_t sample_count, const std::array<s16, 16>& adpcm_coeff,
+                 ADPCMState& state, StereoBuffer16& output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM8 data to decode
- * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param first_sample Index of the first sample to decode
+ * @param sample_count Number of samples to decode
+ * @param output Buffer the decoded stereo signed PCM16 samples are appended to, it must have room
+ * for sample_count samples
  */
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count);
+void DecodePCM8(const unsigned num_channels, const u8* const data, const std::size_t first_sample,
+                const std::size_t sample_count, StereoBuffer16& output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM16 data to decode
- * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param first_sample Index of the first sample to decode
+ * @param sample_count Number of samples to decode
+ * @param output Buffer the decoded stereo signed PCM16 samples are appended to, it must have room
+ * for sample_count samples
  */
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count);
+void DecodePCM16(const unsigned num_channels, const u8* const data, const std::size_t first_sample,
+                 const std::size_t sample_count, StereoBuffer16& output);
 } // namespace AudioCore::Codec
@@ -0,0 +1,108 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include "audio_core/dsp_kernels.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace AudioCore {
+
+/// Position of the binary point of interpolation fractions
+constexpr u64 fraction_scale = 1 << 24;
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+static void GainMixScalar(QuadFrame32& dest, const StereoFrame16& source,
+                          const std::array<float, 4>& gains) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        // Conversion from stereo (source) to quadraphonic (dest) occurs here.
+        dest[samplei][0] += static_cast<s32>(gains[0] * source[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * source[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * source[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * source[samplei][1]);
+    }
+}
+
+static void DownmixStereoScalar(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    std::transform(
+        dest.begin(), dest.end(), source.begin(), dest.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            // Downmix to stereo
+            s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+            s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+            // Mix into current frame
+            return AddAndClampToS16(accumulator, {left, right});
+        });
+}
+
+static void DownmixMonoScalar(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    std::transform(
+        dest.begin(), dest.end(), source.begin(), dest.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            // Downmix to mono
+            s16 mono = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+            // Mix into current frame
+            return AddAndClampToS16(accumulator, {mono, mono});
+        });
+}
+
+static void InterpolateLinearScalar(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1,
+                                    const u32* fractions, std::array<s16, 2>* output,
+                                    std::size_t count) {
+    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
+    for (std::size_t i = 0; i < count; ++i) {
+        const u64 fraction = fractions[i];
+
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        s64 delta0 = std::clamp<s64>(x1[i][0] - x0[i][0], -32768, 32767);
+        s64 delta1 = std::clamp<s64>(x1[i][1] - x0[i][1], -32768, 32767);
+
+        output[i] = {
+            static_cast<s16>(x0[i][0] + fraction * delta0 / fraction_scale),
+            static_cast<s16>(x0[i][1] + fraction * delta1 / fraction_scale),
+        };
+    }
+}
+
+const DspKernels scalar_dsp_kernels{
+    "Scalar", GainMixScalar, DownmixStereoScalar, DownmixMonoScalar, InterpolateLinearScalar,
+};
+
+const DspKernels& GetBestDspKernels() {
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.avx2)
+        return avx2_dsp_kernels;
+    if (caps.sse2)
+        return sse2_dsp_kernels;
+#endif
+    return scalar_dsp_kernels;
+}
+
+static std::atomic<const DspKernels*> dsp_kernels{&GetBestDspKernels()};
+
+const DspKernels& GetDspKernels() {
+    return *dsp_kernels.load(std::memory_order_relaxed);
+}
+
+void SetDspKernels(const DspKernels& kernels) {
+    dsp_kernels.store(&kernels, std::memory_order_relaxed);
+}
+
+} // namespace AudioCore
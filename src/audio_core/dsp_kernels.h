@@ -0,0 +1,67 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "audio_core/audio_types.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * The per-sample inner loops of the HLE DSP, implemented once per instruction set. Every
+ * implementation produces bit-identical results to the scalar one.
+ */
+struct DspKernels {
+    /// Name of the instruction set, for logging and tests
+    const char* name;
+
+    /**
+     * Mixes a stereo frame into a quadraphonic frame, with a gain per quadraphonic channel.
+     * Channels 0 and 2 take the left channel of the source, channels 1 and 3 the right one:
+     *     dest[i][c] += static_cast<s32>(gains[c] * source[i][c % 2])
+     */
+    void (*gain_mix)(QuadFrame32& dest, const StereoFrame16& source,
+                     const std::array<float, 4>& gains);
+
+    /**
+     * Applies a gain to a quadraphonic frame, downmixes it to stereo and adds it to dest, with
+     * saturation. Channels 0 and 2 are mixed to the left, channels 1 and 3 to the right.
+     */
+    void (*downmix_stereo)(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+    /**
+     * Applies a gain to a quadraphonic frame, downmixes it to mono at half the volume of the sum of
+     * its channels and adds it to both channels of dest, with saturation.
+     */
+    void (*downmix_mono)(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+    /**
+     * Linearly interpolates count samples, the i-th sample being fractions[i] / 2^24 of the way
+     * from x0[i] to x1[i]. The fractions must be lower than 2^24.
+     */
+    void (*interpolate_linear)(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1,
+                               const u32* fractions, std::array<s16, 2>* output,
+                               std::size_t count);
+};
+
+extern const DspKernels scalar_dsp_kernels;
+
+#ifdef ARCHITECTURE_x86_64
+extern const DspKernels sse2_dsp_kernels;
+extern const DspKernels avx2_dsp_kernels;
+#endif
+
+/// Returns the fastest kernels supported by the host CPU
+const DspKernels& GetBestDspKernels();
+
+/// Returns the kernels used by the HLE DSP
+const DspKernels& GetDspKernels();
+
+/// Overrides the kernels used by the HLE DSP, for example to compare implementations
+void SetDspKernels(const DspKernels& kernels);
+
+} // namespace AudioCore
@@ -0,0 +1,148 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <immintrin.h>
+#include "audio_core/dsp_kernels.h"
+
+namespace AudioCore {
+
+static_assert(samples_per_frame % 8 == 0);
+
+/// Loads the four channels of two consecutive quadraphonic samples as floats
+static __m256 LoadQuadSamples(const std::array<s32, 4>* samples) {
+    return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples)));
+}
+
+/**
+ * Restores the order of eight stereo samples, or eight 32 bit values, processed two samples per
+ * vector, which leaves the even samples in the low lane and the odd ones in the high lane
+ */
+static __m256i InterleaveLanes(__m256i samples) {
+    return _mm256_permutevar8x32_epi32(samples, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+static void GainMixAVX2(QuadFrame32& dest, const StereoFrame16& source,
+                        const std::array<float, 4>& gains) {
+    const __m256 gain = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(gains.data()));
+    const __m256i first = _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3);
+    const __m256i second = _mm256_setr_epi32(4, 5, 4, 5, 6, 7, 6, 7);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        // Sign extends four stereo samples, and spreads each of them over four channels
+        const __m256 stereo = _mm256_cvtepi32_ps(
+            _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]))));
+        const __m256 quad01 = _mm256_permutevar8x32_ps(stereo, first);
+        const __m256 quad23 = _mm256_permutevar8x32_ps(stereo, second);
+
+        __m256i* const out = reinterpret_cast<__m256i*>(&dest[i]);
+        _mm256_storeu_si256(
+            out, _mm256_add_epi32(_mm256_loadu_si256(out),
+                                  _mm256_cvttps_epi32(_mm256_mul_ps(gain, quad01))));
+        _mm256_storeu_si256(
+            out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1),
+                                      _mm256_cvttps_epi32(_mm256_mul_ps(gain, quad23))));
+    }
+}
+
+static void DownmixStereoAVX2(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    for (std::size_t i = 0; i < samples_per_frame; i += 8) {
+        const __m256 s01 = _mm256_mul_ps(g, LoadQuadSamples(&source[i]));
+        const __m256 s23 = _mm256_mul_ps(g, LoadQuadSamples(&source[i + 2]));
+        const __m256 s45 = _mm256_mul_ps(g, LoadQuadSamples(&source[i + 4]));
+        const __m256 s67 = _mm256_mul_ps(g, LoadQuadSamples(&source[i + 6]));
+
+        // Channels 0 and 1 are added to channels 2 and 3
+        const __m256 stereo0123 =
+            _mm256_add_ps(_mm256_shuffle_ps(s01, s23, _MM_SHUFFLE(1, 0, 1, 0)),
+                          _mm256_shuffle_ps(s01, s23, _MM_SHUFFLE(3, 2, 3, 2)));
+        const __m256 stereo4567 =
+            _mm256_add_ps(_mm256_shuffle_ps(s45, s67, _MM_SHUFFLE(1, 0, 1, 0)),
+                          _mm256_shuffle_ps(s45, s67, _MM_SHUFFLE(3, 2, 3, 2)));
+        const __m256i stereo = InterleaveLanes(_mm256_packs_epi32(
+            _mm256_cvttps_epi32(stereo0123), _mm256_cvttps_epi32(stereo4567)));
+
+        __m256i* const out = reinterpret_cast<__m256i*>(&dest[i]);
+        _mm256_storeu_si256(out, _mm256_adds_epi16(_mm256_loadu_si256(out), stereo));
+    }
+}
+
+static void DownmixMonoAVX2(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    for (std::size_t i = 0; i < samples_per_frame; i += 8) {
+        const __m256 s01 = LoadQuadSamples(&source[i]);
+        const __m256 s23 = LoadQuadSamples(&source[i + 2]);
+        const __m256 s45 = LoadQuadSamples(&source[i + 4]);
+        const __m256 s67 = LoadQuadSamples(&source[i + 6]);
+
+        // Transposes each lane, so that the channel k of samples 0, 2, 4, 6 is in the low lane of
+        // ck, and the one of samples 1, 3, 5, 7 in its high lane
+        const __m256 t0 = _mm256_unpacklo_ps(s01, s23);
+        const __m256 t1 = _mm256_unpackhi_ps(s01, s23);
+        const __m256 t2 = _mm256_unpacklo_ps(s45, s67);
+        const __m256 t3 = _mm256_unpackhi_ps(s45, s67);
+        const __m256 c0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 c1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 c2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 c3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+        // The channels are added in order, as float addition is not associative
+        __m256 sum = _mm256_add_ps(_mm256_mul_ps(g, c0), _mm256_mul_ps(g, c1));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(g, c2));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(g, c3));
+        const __m256i mono32 = InterleaveLanes(_mm256_cvttps_epi32(_mm256_mul_ps(sum, half)));
+        const __m256i mono16 = _mm256_packs_epi32(mono32, mono32);
+        const __m256i stereo = _mm256_unpacklo_epi16(mono16, mono16);
+
+        __m256i* const out = reinterpret_cast<__m256i*>(&dest[i]);
+        _mm256_storeu_si256(out, _mm256_adds_epi16(_mm256_loadu_si256(out), stereo));
+    }
+}
+
+/// Computes (fraction * delta) >> 24 for eight stereo samples, the same way as ScaleDeltaSSE2
+static __m256i ScaleDeltaAVX2(__m256i fractions, __m256i delta) {
+    __m256i high = _mm256_srli_epi32(fractions, 9);
+    __m256i low = _mm256_and_si256(fractions, _mm256_set1_epi32(0x1FF));
+    // Both channels of a sample share its fraction
+    high = _mm256_or_si256(high, _mm256_slli_epi32(high, 16));
+    low = _mm256_or_si256(low, _mm256_slli_epi32(low, 16));
+
+    const __m256i high_lo = _mm256_mullo_epi16(delta, high);
+    const __m256i high_hi = _mm256_mulhi_epi16(delta, high);
+    const __m256i low_lo = _mm256_mullo_epi16(delta, low);
+    const __m256i low_hi = _mm256_mulhi_epi16(delta, low);
+
+    const __m256i scaled0 = _mm256_srai_epi32(
+        _mm256_add_epi32(_mm256_unpacklo_epi16(high_lo, high_hi),
+                         _mm256_srai_epi32(_mm256_unpacklo_epi16(low_lo, low_hi), 9)),
+        15);
+    const __m256i scaled1 = _mm256_srai_epi32(
+        _mm256_add_epi32(_mm256_unpackhi_epi16(high_lo, high_hi),
+                         _mm256_srai_epi32(_mm256_unpackhi_epi16(low_lo, low_hi), 9)),
+        15);
+    // The unpacks and the pack both work within lanes, so the samples are back in order
+    return _mm256_packs_epi32(scaled0, scaled1);
+}
+
+static void InterpolateLinearAVX2(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1,
+                                  const u32* fractions, std::array<s16, 2>* output,
+                                  std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x0 + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x1 + i));
+        const __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fractions + i));
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        const __m256i delta = _mm256_subs_epi16(b, a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i),
+                            _mm256_add_epi16(a, ScaleDeltaAVX2(f, delta)));
+    }
+    sse2_dsp_kernels.interpolate_linear(x0 + i, x1 + i, fractions + i, output + i, count - i);
+}
+
+const DspKernels avx2_dsp_kernels{
+    "AVX2", GainMixAVX2, DownmixStereoAVX2, DownmixMonoAVX2, InterpolateLinearAVX2,
+};
+
+} // namespace AudioCore
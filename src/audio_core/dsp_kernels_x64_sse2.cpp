@@ -0,0 +1,127 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <emmintrin.h>
+#include "audio_core/dsp_kernels.h"
+
+namespace AudioCore {
+
+static_assert(samples_per_frame % 4 == 0);
+
+/// Loads the four channels of a quadraphonic sample as floats
+static __m128 LoadQuadSample(const std::array<s32, 4>& sample) {
+    return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sample.data())));
+}
+
+static void GainMixSSE2(QuadFrame32& dest, const StereoFrame16& source,
+                        const std::array<float, 4>& gains) {
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    for (std::size_t i = 0; i < samples_per_frame; i += 2) {
+        // Sign extends two stereo samples, and spreads each of them over four channels
+        const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&source[i]));
+        const __m128 stereo =
+            _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+        const __m128 quad0 = _mm_movelh_ps(stereo, stereo);
+        const __m128 quad1 = _mm_movehl_ps(stereo, stereo);
+
+        __m128i* const out = reinterpret_cast<__m128i*>(&dest[i]);
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out),
+                                            _mm_cvttps_epi32(_mm_mul_ps(gain, quad0))));
+        _mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1),
+                                                _mm_cvttps_epi32(_mm_mul_ps(gain, quad1))));
+    }
+}
+
+static void DownmixStereoSSE2(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const __m128 s0 = _mm_mul_ps(g, LoadQuadSample(source[i]));
+        const __m128 s1 = _mm_mul_ps(g, LoadQuadSample(source[i + 1]));
+        const __m128 s2 = _mm_mul_ps(g, LoadQuadSample(source[i + 2]));
+        const __m128 s3 = _mm_mul_ps(g, LoadQuadSample(source[i + 3]));
+
+        // Channels 0 and 1 are added to channels 2 and 3
+        const __m128 stereo01 = _mm_add_ps(_mm_movelh_ps(s0, s1), _mm_movehl_ps(s1, s0));
+        const __m128 stereo23 = _mm_add_ps(_mm_movelh_ps(s2, s3), _mm_movehl_ps(s3, s2));
+        const __m128i stereo =
+            _mm_packs_epi32(_mm_cvttps_epi32(stereo01), _mm_cvttps_epi32(stereo23));
+
+        __m128i* const out = reinterpret_cast<__m128i*>(&dest[i]);
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), stereo));
+    }
+}
+
+static void DownmixMonoSSE2(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128 c0 = LoadQuadSample(source[i]);
+        __m128 c1 = LoadQuadSample(source[i + 1]);
+        __m128 c2 = LoadQuadSample(source[i + 2]);
+        __m128 c3 = LoadQuadSample(source[i + 3]);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        // The channels are added in order, as float addition is not associative
+        __m128 sum = _mm_add_ps(_mm_mul_ps(g, c0), _mm_mul_ps(g, c1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(g, c2));
+        sum = _mm_add_ps(sum, _mm_mul_ps(g, c3));
+        const __m128i mono32 = _mm_cvttps_epi32(_mm_mul_ps(sum, half));
+        const __m128i mono16 = _mm_packs_epi32(mono32, mono32);
+        const __m128i stereo = _mm_unpacklo_epi16(mono16, mono16);
+
+        __m128i* const out = reinterpret_cast<__m128i*>(&dest[i]);
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), stereo));
+    }
+}
+
+/**
+ * Computes (fraction * delta) >> 24 for four stereo samples, in 32 bits. The fractions are split
+ * into their high 15 and low 9 bits, so that both products fit in 16 bit multiplications:
+ *     (fraction * delta) >> 24 == (high * delta + ((low * delta) >> 9)) >> 15
+ */
+static __m128i ScaleDeltaSSE2(__m128i fractions, __m128i delta) {
+    __m128i high = _mm_srli_epi32(fractions, 9);
+    __m128i low = _mm_and_si128(fractions, _mm_set1_epi32(0x1FF));
+    // Both channels of a sample share its fraction
+    high = _mm_or_si128(high, _mm_slli_epi32(high, 16));
+    low = _mm_or_si128(low, _mm_slli_epi32(low, 16));
+
+    const __m128i high_lo = _mm_mullo_epi16(delta, high);
+    const __m128i high_hi = _mm_mulhi_epi16(delta, high);
+    const __m128i low_lo = _mm_mullo_epi16(delta, low);
+    const __m128i low_hi = _mm_mulhi_epi16(delta, low);
+
+    const __m128i scaled0 = _mm_srai_epi32(
+        _mm_add_epi32(_mm_unpacklo_epi16(high_lo, high_hi),
+                      _mm_srai_epi32(_mm_unpacklo_epi16(low_lo, low_hi), 9)),
+        15);
+    const __m128i scaled1 = _mm_srai_epi32(
+        _mm_add_epi32(_mm_unpackhi_epi16(high_lo, high_hi),
+                      _mm_srai_epi32(_mm_unpackhi_epi16(low_lo, low_hi), 9)),
+        15);
+    // The results lie between 0 and delta, so they fit in 16 bits
+    return _mm_packs_epi32(scaled0, scaled1);
+}
+
+static void InterpolateLinearSSE2(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1,
+                                  const u32* fractions, std::array<s16, 2>* output,
+                                  std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x0 + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x1 + i));
+        const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fractions + i));
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        const __m128i delta = _mm_subs_epi16(b, a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                         _mm_add_epi16(a, ScaleDeltaSSE2(f, delta)));
+    }
+    scalar_dsp_kernels.interpolate_linear(x0 + i, x1 + i, fractions + i, output + i, count - i);
+}
+
+const DspKernels sse2_dsp_kernels{
+    "SSE2", GainMixSSE2, DownmixStereoSSE2, DownmixMonoSSE2, InterpolateLinearSSE2,
+};
+
+} // namespace AudioCore
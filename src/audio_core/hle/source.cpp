@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include "audio_core/codec.h"
+#include "audio_core/dsp_kernels.h"
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
@@ -29,14 +30,7 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    GetDspKernels().gain_mix(dest, current_frame, state.gain.at(intermediate_mix_id));
 }
 
 void Source::Reset() {
@@ -177,56 +171,50 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
         // buffer_id (after a check comparing the buffer_id to something, probably to make sure it's
         // the same buffer?), flags2_raw.is_looping, and length.
 
-        // A quick and dirty way of extending the current buffer is to just read the whole thing
-        // again with the new length. Note that this uses the latched physical address instead of
-        // whatever is in config, because that may be invalid.
+        // Extend the current buffer by decoding it again with the new length, from the current
+        // sample. Note that this uses the latched physical address instead of whatever is in
+        // config, because that may be invalid.
         const u8* const memory =
             memory_system->GetPhysicalPointer(state.current_buffer_physical_address & 0xFFFFFFFC);
 
-        // TODO(xperia64): This could potentially be optimized by only decoding the new data and
-        // appending that to the buffer.
         if (memory) {
-            const unsigned num_channels = state.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
             bool valid = false;
             switch (state.format) {
             case Format::PCM8:
                 // TODO(xperia64): This may just work fine like PCM16, but I haven't tested and
                 // couldn't find any test case games
                 UNIMPLEMENTED_MSG("{} not handled for partial buffer updates", "PCM8");
-                // state.current_buffer = Codec::DecodePCM8(num_channels, memory, config.length);
                 break;
             case Format::PCM16:
-                state.current_buffer = Codec::DecodePCM16(num_channels, memory, config.length);
                 valid = true;
                 break;
             case Format::ADPCM:
                 // TODO(xperia64): Are partial embedded buffer updates even valid for ADPCM? What
                 // about the adpcm state?
                 UNIMPLEMENTED_MSG("{} not handled for partial buffer updates", "ADPCM");
-                /* state.current_buffer =
-                    Codec::DecodeADPCM(memory, config.length, state.adpcm_coeffs,
-                   state.adpcm_state); */
                 break;
             default:
                 UNIMPLEMENTED();
                 break;
             }
 
-            // Again, because our interpolation consumes samples instead of using an index, let's
-            // just re-consume the samples up to the current sample number. There may be some
-            // imprecision here with the current sample number, as Detective Pikachu sounds a little
-            // rough at times.
+            // The samples decoded so far are discarded, and decoding resumes at the current sample
+            // number. There may be some imprecision here with the current sample number, as
+            // Detective Pikachu sounds a little rough at times.
             if (valid) {
+                state.current_buffer.Clear();
+                state.current_buffer_format = state.format;
+                state.current_buffer_mono_or_stereo = state.mono_or_stereo;
+                state.current_buffer_length = config.length;
 
                 // TODO(xperia64): Tomodachi life apparently can decrease config.length when the
                 // user skips dialog. I don't know the correct behavior, but to avoid crashing, just
-                // reset the current sample number to 0 and don't try to truncate the buffer
-                if (state.current_buffer.size() < state.current_sample_number) {
+                // reset the current sample number to 0 and play the buffer from its start
+                if (state.current_buffer_length < state.current_sample_number) {
                     state.current_sample_number = 0;
+                    state.current_buffer_decoded = 0;
                 } else {
-                    state.current_buffer.erase(
-                        state.current_buffer.begin(),
-                        std::next(state.current_buffer.begin(), state.current_sample_number));
+                    state.current_buffer_decoded = state.current_sample_number;
                 }
             }
         }
@@ -319,7 +307,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
 void Source::GenerateFrame() {
     current_frame.fill({});
 
-    if (state.current_buffer.empty() && !DequeueBuffer()) {
+    if (state.current_buffer.IsEmpty() && !FillCurrentBuffer()) {
         state.enabled = false;
         state.buffer_update = true;
         state.current_buffer_id = 0;
@@ -330,7 +318,7 @@ void Source::GenerateFrame() {
 
     state.current_sample_number = state.next_sample_number;
     while (frame_position < current_frame.size()) {
-        if (state.current_buffer.empty() && !DequeueBuffer()) {
+        if (state.current_buffer.IsEmpty() && !FillCurrentBuffer()) {
             break;
         }
 
@@ -361,8 +349,17 @@ void Source::GenerateFrame() {
     state.filters.ProcessFrame(current_frame);
 }
 
+bool Source::FillCurrentBuffer() {
+    if (state.current_buffer_decoded < state.current_buffer_length) {
+        DecodeCurrentBuffer();
+        return true;
+    }
+    return DequeueBuffer();
+}
+
 bool Source::DequeueBuffer() {
-    ASSERT_MSG(state.current_buffer.empty(),
+    ASSERT_MSG(state.current_buffer.IsEmpty() &&
+                   state.current_buffer_decoded == state.current_buffer_length,
                "Shouldn't dequeue; we still have data in current_buffer");
 
     if (state.input_queue.empty())
@@ -379,36 +376,29 @@ bool Source::DequeueBuffer() {
     // This physical address masking occurs due to how the DSP DMA hardware is configured by the
     // firmware.
     const u8* const memory = memory_system->GetPhysicalPointer(buf.physical_address & 0xFFFFFFFC);
-    if (memory) {
-        const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
-        switch (buf.format) {
-        case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
-            break;
-        case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
-            break;
-        case Format::ADPCM:
-            DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
-            break;
-        default:
-            UNIMPLEMENTED();
-            break;
-        }
-    } else {
+    if (!memory) {
         LOG_WARNING(Audio_DSP,
                     "source_id={} buffer_id={} length={}: Invalid physical address {:#010x}",
                     source_id, buf.buffer_id, buf.length, buf.physical_address);
-        state.current_buffer.clear();
+        state.current_buffer_length = 0;
+        state.current_buffer_decoded = 0;
         return true;
     }
 
+    state.current_buffer_physical_address = buf.physical_address;
+    state.current_buffer_format = buf.format;
+    state.current_buffer_mono_or_stereo = buf.mono_or_stereo;
+    state.current_buffer_length = buf.length;
+    if (buf.format == Format::ADPCM) {
+        // ADPCM samples are decoded in pairs, so a buffer of an odd length plays an extra sample
+        state.current_buffer_length += buf.length % 2;
+    }
+    state.current_buffer_decoded = 0;
+    DecodeCurrentBuffer();
+
     // the first playthrough starts at play_position, loops start at the beginning of the buffer
     state.current_sample_number = (!buf.has_played) ? buf.play_position : 0;
     state.next_sample_number = state.current_sample_number;
-    state.current_buffer_physical_address = buf.physical_address;
     state.current_buffer_id = buf.buffer_id;
     state.buffer_update = buf.from_queue && !buf.has_played;
 
@@ -417,11 +407,46 @@ bool Source::DequeueBuffer() {
         state.input_queue.push(buf);
     }
 
-    LOG_TRACE(Audio_DSP, "source_id={} buffer_id={} from_queue={} current_buffer.size()={}",
-              source_id, buf.buffer_id, buf.from_queue, state.current_buffer.size());
+    LOG_TRACE(Audio_DSP, "source_id={} buffer_id={} from_queue={} current_buffer_length={}",
+              source_id, buf.buffer_id, buf.from_queue, state.current_buffer_length);
     return true;
 }
 
+void Source::DecodeCurrentBuffer() {
+    const std::size_t sample_count =
+        std::min<std::size_t>(state.current_buffer_length - state.current_buffer_decoded,
+                              state.current_buffer.GetFreeSpace());
+    const u8* const memory =
+        memory_system->GetPhysicalPointer(state.current_buffer_physical_address & 0xFFFFFFFC);
+    if (!memory) {
+        state.current_buffer_decoded = state.current_buffer_length;
+        return;
+    }
+
+    const unsigned num_channels =
+        state.current_buffer_mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    switch (state.current_buffer_format) {
+    case Format::PCM8:
+        Codec::DecodePCM8(num_channels, memory, state.current_buffer_decoded, sample_count,
+                          state.current_buffer);
+        break;
+    case Format::PCM16:
+        Codec::DecodePCM16(num_channels, memory, state.current_buffer_decoded, sample_count,
+                           state.current_buffer);
+        break;
+    case Format::ADPCM:
+        DEBUG_ASSERT(num_channels == 1);
+        Codec::DecodeADPCM(memory, state.current_buffer_decoded, sample_count, state.adpcm_coeffs,
+                           state.adpcm_state, state.current_buffer);
+        break;
+    default:
+        UNIMPLEMENTED();
+        state.current_buffer_decoded = state.current_buffer_length;
+        return;
+    }
+    state.current_buffer_decoded += static_cast<u32>(sample_count);
+}
+
 SourceStatus::Status Source::GetCurrentStatus() {
     SourceStatus::Status ret;
 
@@ -7,7 +7,6 @@
 #include <array>
 #include <vector>
 #include <boost/serialization/array.hpp>
-#include <boost/serialization/deque.hpp>
 #include <boost/serialization/priority_queue.hpp>
 #include <boost/serialization/vector.hpp>
 #include <queue>
@@ -138,7 +137,14 @@ private:
         u32 current_sample_number = 0;
         u32 next_sample_number = 0;
         PAddr current_buffer_physical_address = 0;
-        AudioInterp::StereoBuffer16 current_buffer = {};
+        /// Format of the current buffer, which is decoded as it is played
+        Format current_buffer_format = Format::ADPCM;
+        MonoOrStereo current_buffer_mono_or_stereo = MonoOrStereo::Mono;
+        /// Number of samples of the current buffer, and how many of them were decoded so far
+        u32 current_buffer_length = 0;
+        u32 current_buffer_decoded = 0;
+        /// Decoded samples of the current buffer waiting to be resampled
+        StereoBuffer16 current_buffer = {};
 
         // buffer_id state
 
@@ -172,10 +178,16 @@ private:
             ar& current_sample_number;
             ar& next_sample_number;
             ar& current_buffer_physical_address;
+            ar& current_buffer_format;
+            ar& current_buffer_mono_or_stereo;
+            ar& current_buffer_length;
+            ar& current_buffer_decoded;
             ar& current_buffer;
             ar& buffer_update;
             ar& current_buffer_id;
             ar& adpcm_coeffs;
+            ar& adpcm_state.yn1;
+            ar& adpcm_state.yn2;
             ar& rate_multiplier;
             ar& interpolation_mode;
         }
@@ -189,9 +201,14 @@ private:
     void ParseConfig(SourceConfiguration::Configuration& config, const s16_le (&adpcm_coeffs)[16]);
     /// INTERNAL: Generate the current audio output for this frame based on our internal state.
     void GenerateFrame();
-    /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
-    /// into current_buffer.
+    /// INTERNAL: Dequeues a buffer and decodes its first samples into current_buffer.
     bool DequeueBuffer();
+    /// INTERNAL: Decodes as many of the remaining samples of the current buffer as fit into
+    /// current_buffer.
+    void DecodeCurrentBuffer();
+    /// INTERNAL: Makes sure current_buffer has samples to resample, decoding more of the current
+    /// buffer or dequeuing the next one. Returns false if there are no buffers left.
+    bool FillCurrentBuffer();
     /// INTERNAL: Generates a SourceStatus::Status based on our internal state.
     SourceStatus::Status GetCurrentStatus();
 
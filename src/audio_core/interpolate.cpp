@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include "audio_core/dsp_kernels.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 
@@ -13,64 +14,76 @@ namespace AudioCore::AudioInterp {
 constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
+/// The input samples around each output sample, gathered so that they are interpolated in bulk
+struct Steps {
+    std::array<std::array<s16, 2>, samples_per_frame> x0;
+    std::array<std::array<s16, 2>, samples_per_frame> x1;
+    /// Position of the output samples between x0 and x1, in fixed point
+    std::array<u32, samples_per_frame> fractions;
+    std::size_t count = 0;
+};
+
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
-static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-                            std::size_t& outputi, Function fn) {
+/// The two samples each output sample lies between are gathered in steps.
+static void StepOverSamples(State& state, StereoBuffer16& input, float rate, std::size_t max_steps,
+                            Steps& steps) {
     ASSERT(rate > 0);
+    ASSERT(max_steps <= samples_per_frame);
 
-    if (input.empty())
+    steps.count = 0;
+    if (input.IsEmpty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    // The two historical samples come before the input, without copying them into it.
+    const auto sample = [&state, &input](std::size_t i) -> const StereoBuffer16::Sample& {
+        return i >= 2 ? input[i - 2] : i == 1 ? state.xn1 : state.xn2;
+    };
+    const std::size_t input_size = input.Size() + 2;
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
     u64 fposition = state.fposition;
     std::size_t inputi = 0;
 
-    while (outputi < output.size()) {
+    while (steps.count < max_steps) {
         inputi = static_cast<std::size_t>(fposition / scale_factor);
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
+        if (inputi + 2 >= input_size) {
+            inputi = input_size - 2;
             break;
         }
 
-        u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+        steps.x0[steps.count] = sample(inputi);
+        steps.x1[steps.count] = sample(inputi + 1);
+        steps.fractions[steps.count] = static_cast<u32>(fposition & scale_mask);
+        ++steps.count;
 
         fposition += step_size;
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
+    const StereoBuffer16::Sample xn2 = sample(inputi);
+    const StereoBuffer16::Sample xn1 = sample(inputi + 1);
+    state.xn2 = xn2;
+    state.xn1 = xn1;
     state.fposition = fposition - inputi * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    input.Pop(inputi);
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    Steps steps;
+    StepOverSamples(state, input, rate, output.size() - outputi, steps);
+    std::copy_n(steps.x0.begin(), steps.count, output.begin() + outputi);
+    outputi += steps.count;
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
-    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    Steps steps;
+    StepOverSamples(state, input, rate, output.size() - outputi, steps);
+    GetDspKernels().interpolate_linear(steps.x0.data(), steps.x1.data(), steps.fractions.data(),
+                                       output.data() + outputi, steps.count);
+    outputi += steps.count;
 }
 
 } // namespace AudioCore::AudioInterp
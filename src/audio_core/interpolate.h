@@ -5,15 +5,12 @@
 #pragma once
 
 #include <array>
-#include <deque>
 #include "audio_core/audio_types.h"
+#include "audio_core/stereo_buffer.h"
 #include "common/common_types.h"
 
 namespace AudioCore::AudioInterp {
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
-
 struct State {
     /// Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
@@ -25,7 +22,7 @@ struct State {
 /**
  * No interpolation. This is equivalent to a zero-order hold. There is a two-sample predelay.
  * @param state Interpolation state.
- * @param input Input buffer.
+ * @param input Input buffer. The samples that are stepped over are popped from it.
  * @param rate Stretch factor. Must be a positive non-zero value.
  *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
  * @param output The resampled audio buffer.
@@ -37,7 +34,7 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 /**
  * Linear interpolation. This is equivalent to a first-order hold. There is a two-sample predelay.
  * @param state Interpolation state.
- * @param input Input buffer.
+ * @param input Input buffer. The samples that are stepped over are popped from it.
  * @param rate Stretch factor. Must be a positive non-zero value.
  *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
  * @param output The resampled audio buffer.
@@ -0,0 +1,97 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/split_member.hpp>
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * A fixed capacity FIFO of signed PCM16 stereo samples. Its storage is part of the object, so
+ * samples are decoded into it and consumed from it every audio frame without allocating.
+ */
+class StereoBuffer16 {
+public:
+    using Sample = std::array<s16, 2>;
+
+    /// Number of samples the buffer holds, over six audio frames at the native sample rate
+    static constexpr std::size_t capacity = 1024;
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    bool IsEmpty() const {
+        return size == 0;
+    }
+
+    /// Returns the number of samples that can be pushed before the buffer is full
+    std::size_t GetFreeSpace() const {
+        return capacity - size;
+    }
+
+    /// Returns the i-th oldest sample
+    const Sample& operator[](std::size_t i) const {
+        return samples[(head + i) & mask];
+    }
+
+    /// Appends a sample. The buffer must not be full.
+    void Push(const Sample& sample) {
+        DEBUG_ASSERT(size < capacity);
+        samples[(head + size) & mask] = sample;
+        ++size;
+    }
+
+    /// Discards the count oldest samples
+    void Pop(std::size_t count) {
+        DEBUG_ASSERT(count <= size);
+        head = (head + count) & mask;
+        size -= count;
+    }
+
+    void Clear() {
+        head = 0;
+        size = 0;
+    }
+
+private:
+    static constexpr std::size_t mask = capacity - 1;
+    static_assert((capacity & mask) == 0, "capacity must be a power of two");
+
+    std::array<Sample, capacity> samples;
+    std::size_t head = 0; ///< Index of the oldest sample
+    std::size_t size = 0; ///< Number of samples in the buffer
+
+    template <class Archive>
+    void save(Archive& ar, const unsigned int) const {
+        const u32 count = static_cast<u32>(size);
+        ar << count;
+        for (std::size_t i = 0; i < size; ++i) {
+            ar << (*this)[i];
+        }
+    }
+
+    template <class Archive>
+    void load(Archive& ar, const unsigned int) {
+        u32 count;
+        ar >> count;
+        Clear();
+        for (u32 i = 0; i < count; ++i) {
+            Sample sample;
+            ar >> sample;
+            Push(sample);
+        }
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+    friend class boost::serialization::access;
+};
+
+} // namespace AudioCore
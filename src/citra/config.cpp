@@ -104,6 +104,8 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.use_cpu_fastmem = sdl2_config->GetBoolean("Core", "use_cpu_fastmem", false);
+    Settings::values.use_cpu_threads = sdl2_config->GetBoolean("Core", "use_cpu_threads", false);
     Settings::values.cpu_clock_percentage =
         sdl2_config->GetInteger("Core", "cpu_clock_percentage", 100);
 
@@ -121,6 +123,16 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", true);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.shader_jit_cache_size =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "shader_jit_cache_size", 128));
+    Settings::values.use_disk_shader_jit_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_shader_jit_cache", true);
+    Settings::values.async_shader_jit =
+        sdl2_config->GetBoolean("Renderer", "async_shader_jit", false);
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "sw_rasterizer_threads", 0));
+    Settings::values.vertex_shader_threads =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "vertex_shader_threads", 0));
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
     Settings::values.use_disk_shader_cache =
@@ -256,6 +268,10 @@ void Config::ReadValues() {
     // Debugging
     Settings::values.record_frame_times =
         sdl2_config->GetBoolean("Debugging", "record_frame_times", false);
+    Settings::values.profile_hle_services =
+        sdl2_config->GetBoolean("Debugging", "profile_hle_services", false);
+    Settings::values.guest_profiler_interval =
+        static_cast<u32>(sdl2_config->GetInteger("Debugging", "guest_profiler_interval", 0));
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
     Settings::values.gdbstub_port =
         static_cast<u16>(sdl2_config->GetInteger("Debugging", "gdbstub_port", 24689));
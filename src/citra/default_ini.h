@@ -91,6 +91,18 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether the CPU JIT accesses the emulated memory directly through a host mapping of the whole
+# emulated address space ("fastmem"), instead of looking up the page table. Only used on hosts
+# supporting it, such as Linux and macOS on x86-64. Ignored on Windows.
+# 0 (default): Off, 1: On
+use_cpu_fastmem =
+
+# Whether to run each emulated CPU core on a host thread of its own. Requires the CPU JIT and is
+# only used with the software renderer, outside of movie recording and playback.
+# Experimental: guest code synchronizing cores without system calls may misbehave.
+# 0 (default): Run all cores on the CPU thread, 1: Run the cores in parallel
+use_cpu_threads =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance of the game at the risk of freezing.
 # Overclocking may fix lag that happens on console, but also comes with the risk of freezing.
@@ -122,6 +134,31 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Maximum memory in MiB held by shaders compiled by the shader JIT. The least recently used shaders
+# are evicted when it is exceeded. Each shader takes up about 300 KiB.
+# 0: No limit, 128 (default): 128 MiB
+shader_jit_cache_size =
+
+# Reduce stuttering by storing the shaders compiled by the shader JIT to disk and loading them on
+# the next boot of the game
+# 0: Off, 1 (default): On
+use_disk_shader_jit_cache =
+
+# Compile shaders with the shader JIT on a background thread. Until a shader is compiled, it runs on
+# the interpreter, which gives the same output more slowly instead of pausing the game.
+# 0 (default): Off, 1: On
+async_shader_jit =
+
+# Number of threads the software renderer rasterizes with. Triangles are sorted into screen tiles
+# that are drawn in parallel, with output identical to single-threaded rendering.
+# 0 (default), 1: Single-threaded, Otherwise the number of threads
+sw_rasterizer_threads =
+
+# Number of threads that shade vertices when the hardware shader is not used. Large draws without a
+# geometry shader are split into chunks that are shaded in parallel.
+# 0 (default), 1: Single-threaded, Otherwise the number of threads
+vertex_shader_threads =
+
 # Forces VSync on the display thread. Usually doesn't impact performance, but on some drivers it can
 # so only turn this off if you notice a speed difference.
 # 0: Off, 1 (default): On
@@ -298,6 +335,13 @@ log_filter = *:Info
 [Debugging]
 # Record frame time data, can be found in the log directory. Boolean value
 record_frame_times =
+# Profile the calls to HLE services. The call counts, latencies and bytes moved per service function
+# are saved as CSV and JSON in the log directory when emulation stops. Boolean value
+profile_hle_services =
+# Emulated CPU cycles between samples of the running guest code, 0 (default) disables sampling.
+# The CPU runs 268111 cycles per millisecond. The samples are saved as collapsed stacks, as read by
+# flamegraph.pl, in the log directory when emulation stops.
+guest_profiler_interval =
 # Port for listening to GDB connections.
 use_gdbstub=false
 gdbstub_port=24689
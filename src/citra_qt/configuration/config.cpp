@@ -292,6 +292,10 @@ void Config::ReadCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     Settings::values.use_cpu_jit = ReadSetting(QStringLiteral("use_cpu_jit"), true).toBool();
+    Settings::values.use_cpu_fastmem =
+        ReadSetting(QStringLiteral("use_cpu_fastmem"), false).toBool();
+    Settings::values.use_cpu_threads =
+        ReadSetting(QStringLiteral("use_cpu_threads"), false).toBool();
     Settings::values.cpu_clock_percentage =
         ReadSetting(QStringLiteral("cpu_clock_percentage"), 100).toInt();
 
@@ -312,6 +316,10 @@ void Config::ReadDebuggingValues() {
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     Settings::values.record_frame_times =
         qt_config->value(QStringLiteral("record_frame_times"), false).toBool();
+    Settings::values.profile_hle_services =
+        qt_config->value(QStringLiteral("profile_hle_services"), false).toBool();
+    Settings::values.guest_profiler_interval =
+        qt_config->value(QStringLiteral("guest_profiler_interval"), 0).toUInt();
     Settings::values.use_gdbstub = ReadSetting(QStringLiteral("use_gdbstub"), false).toBool();
     Settings::values.gdbstub_port = ReadSetting(QStringLiteral("gdbstub_port"), 24689).toInt();
 
@@ -478,6 +486,16 @@ void Config::ReadRendererValues() {
     Settings::values.shaders_accurate_mul =
         ReadSetting(QStringLiteral("shaders_accurate_mul"), true).toBool();
     Settings::values.use_shader_jit = ReadSetting(QStringLiteral("use_shader_jit"), true).toBool();
+    Settings::values.shader_jit_cache_size =
+        static_cast<u16>(ReadSetting(QStringLiteral("shader_jit_cache_size"), 128).toInt());
+    Settings::values.use_disk_shader_jit_cache =
+        ReadSetting(QStringLiteral("use_disk_shader_jit_cache"), true).toBool();
+    Settings::values.async_shader_jit =
+        ReadSetting(QStringLiteral("async_shader_jit"), false).toBool();
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u16>(ReadSetting(QStringLiteral("sw_rasterizer_threads"), 0).toInt());
+    Settings::values.vertex_shader_threads =
+        static_cast<u16>(ReadSetting(QStringLiteral("vertex_shader_threads"), 0).toInt());
     Settings::values.use_disk_shader_cache =
         ReadSetting(QStringLiteral("use_disk_shader_cache"), true).toBool();
     Settings::values.use_vsync_new = ReadSetting(QStringLiteral("use_vsync_new"), true).toBool();
@@ -842,6 +860,8 @@ void Config::SaveCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     WriteSetting(QStringLiteral("use_cpu_jit"), Settings::values.use_cpu_jit, true);
+    WriteSetting(QStringLiteral("use_cpu_fastmem"), Settings::values.use_cpu_fastmem, false);
+    WriteSetting(QStringLiteral("use_cpu_threads"), Settings::values.use_cpu_threads, false);
     WriteSetting(QStringLiteral("cpu_clock_percentage"), Settings::values.cpu_clock_percentage,
                  100);
 
@@ -861,6 +881,10 @@ void Config::SaveDebuggingValues() {
 
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     qt_config->setValue(QStringLiteral("record_frame_times"), Settings::values.record_frame_times);
+    qt_config->setValue(QStringLiteral("profile_hle_services"),
+                        Settings::values.profile_hle_services);
+    qt_config->setValue(QStringLiteral("guest_profiler_interval"),
+                        Settings::values.guest_profiler_interval);
     WriteSetting(QStringLiteral("use_gdbstub"), Settings::values.use_gdbstub, false);
     WriteSetting(QStringLiteral("gdbstub_port"), Settings::values.gdbstub_port, 24689);
 
@@ -981,6 +1005,15 @@ void Config::SaveRendererValues() {
     WriteSetting(QStringLiteral("shaders_accurate_mul"), Settings::values.shaders_accurate_mul,
                  true);
     WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit, true);
+    WriteSetting(QStringLiteral("shader_jit_cache_size"), Settings::values.shader_jit_cache_size,
+                 128);
+    WriteSetting(QStringLiteral("use_disk_shader_jit_cache"),
+                 Settings::values.use_disk_shader_jit_cache, true);
+    WriteSetting(QStringLiteral("async_shader_jit"), Settings::values.async_shader_jit, false);
+    WriteSetting(QStringLiteral("sw_rasterizer_threads"), Settings::values.sw_rasterizer_threads,
+                 0);
+    WriteSetting(QStringLiteral("vertex_shader_threads"), Settings::values.vertex_shader_threads,
+                 0);
     WriteSetting(QStringLiteral("use_disk_shader_cache"), Settings::values.use_disk_shader_cache,
                  true);
     WriteSetting(QStringLiteral("use_vsync_new"), Settings::values.use_vsync_new, true);
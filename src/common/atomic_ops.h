@@ -0,0 +1,59 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * Atomically replaces the value at pointer with value if it still equals expected.
+ * @returns Whether the value was replaced
+ */
+#ifdef _MSC_VER
+
+inline bool AtomicCompareAndSwap(volatile u8* pointer, u8 value, u8 expected) {
+    const u8 result = _InterlockedCompareExchange8(reinterpret_cast<volatile char*>(pointer),
+                                                   static_cast<char>(value),
+                                                   static_cast<char>(expected));
+    return result == expected;
+}
+
+inline bool AtomicCompareAndSwap(volatile u16* pointer, u16 value, u16 expected) {
+    const u16 result = _InterlockedCompareExchange16(reinterpret_cast<volatile short*>(pointer),
+                                                     static_cast<short>(value),
+                                                     static_cast<short>(expected));
+    return result == expected;
+}
+
+inline bool AtomicCompareAndSwap(volatile u32* pointer, u32 value, u32 expected) {
+    const u32 result = _InterlockedCompareExchange(reinterpret_cast<volatile long*>(pointer),
+                                                   static_cast<long>(value),
+                                                   static_cast<long>(expected));
+    return result == expected;
+}
+
+inline bool AtomicCompareAndSwap(volatile u64* pointer, u64 value, u64 expected) {
+    const u64 result = _InterlockedCompareExchange64(reinterpret_cast<volatile __int64*>(pointer),
+                                                     static_cast<__int64>(value),
+                                                     static_cast<__int64>(expected));
+    return result == expected;
+}
+
+#else
+
+template <typename T>
+inline bool AtomicCompareAndSwap(volatile T* pointer, T value, T expected) {
+    static_assert(sizeof(T) <= 8, "Unsupported operand size");
+    return __sync_bool_compare_and_swap(pointer, expected, value);
+}
+
+#endif
+
+} // namespace Common
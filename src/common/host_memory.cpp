@@ -0,0 +1,483 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fmt/format.h>
+#endif
+#include "common/assert.h"
+#include "common/host_memory.h"
+#include "common/logging/log.h"
+
+namespace Common {
+
+/// Emulated pages are mapped one by one, so the host pages must be of the same size
+constexpr std::size_t EMULATED_PAGE_SIZE = 0x1000;
+
+/// Number of 64-bit words of a bitmap with one bit per page of a memory
+static std::size_t NumPageWords(std::size_t size) {
+    return (size / EMULATED_PAGE_SIZE + 63) / 64;
+}
+
+static bool IsPageSet(const std::atomic<u64>* bits, std::size_t page) {
+    return (bits[page / 64].load(std::memory_order_relaxed) >> (page % 64)) & 1;
+}
+
+static void SetPage(std::atomic<u64>* bits, std::size_t page) {
+    bits[page / 64].fetch_or(u64{1} << (page % 64), std::memory_order_relaxed);
+}
+
+/// Returns the offsets of all pages of a memory, which all count as written when not tracked
+static std::vector<std::size_t> GetAllPages(std::size_t size) {
+    std::vector<std::size_t> pages;
+    pages.reserve(size / EMULATED_PAGE_SIZE);
+    for (std::size_t offset = 0; offset < size; offset += EMULATED_PAGE_SIZE) {
+        pages.push_back(offset);
+    }
+    return pages;
+}
+
+#ifndef _WIN32
+
+static bool IsHostPageSizeSupported() {
+    return sysconf(_SC_PAGESIZE) == static_cast<long>(EMULATED_PAGE_SIZE);
+}
+
+/// Creates an anonymous shared memory object. Returns -1 on failure.
+static int CreateSharedMemoryObject() {
+#if defined(__linux__)
+    return memfd_create("citra_host_memory", MFD_CLOEXEC);
+#else
+    static std::atomic<u32> counter{0};
+    const std::string name = fmt::format("/citra_host_memory_{}_{}", getpid(), counter++);
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1) {
+        shm_unlink(name.c_str());
+    }
+    return fd;
+#endif
+}
+
+/**
+ * Tracks the pages written to host memory by write-protecting the pages not written yet, both
+ * where the memory is mapped and where fastmem arenas alias it. The first write to such a page
+ * faults, and the fault handler marks the page as written and makes it writable again before the
+ * write is retried. Faults at any other address are passed on to the previous handler, such as
+ * the one of the JIT which handles the faults of fastmem accesses.
+ */
+class WriteTracker {
+public:
+    /// Installs the fault handler, if it wasn't yet. Returns whether it is installed.
+    static bool InstallFaultHandler() {
+        static const bool installed = [] {
+            struct sigaction action {};
+            action.sa_sigaction = HandleFault;
+            action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            return sigaction(SIGSEGV, &action, &previous_segv_action) == 0 &&
+                   sigaction(SIGBUS, &action, &previous_bus_action) == 0;
+        }();
+        return installed;
+    }
+
+    static bool Register(HostMemory& memory) {
+        return Register(tracked_memories, &memory);
+    }
+
+    static void Unregister(HostMemory& memory) {
+        Replace<HostMemory>(tracked_memories, &memory, nullptr);
+    }
+
+    static bool Register(FastmemArena& arena) {
+        return Register(fastmem_arenas, &arena);
+    }
+
+    static void Unregister(FastmemArena& arena) {
+        Replace<FastmemArena>(fastmem_arenas, &arena, nullptr);
+    }
+
+    /// Swaps the registrations of two memories, after their tracking state was swapped
+    static void Swap(HostMemory& a, HostMemory& b) {
+        for (auto& slot : tracked_memories) {
+            HostMemory* const memory = slot.load(std::memory_order_relaxed);
+            if (memory == &a) {
+                slot.store(&b);
+            } else if (memory == &b) {
+                slot.store(&a);
+            }
+        }
+    }
+
+    /**
+     * Write-protects the pages of a range of memory, mapped at mapping, that weren't written since
+     * the memory started tracking writes. Consecutive pages are protected at once.
+     */
+    static void ProtectUnwritten(u8* mapping, const HostMemory& memory, std::size_t offset,
+                                 std::size_t length) {
+        const auto is_written = [&](std::size_t page) {
+            return IsPageSet(memory.written_pages.get(), (offset + page) / EMULATED_PAGE_SIZE);
+        };
+        std::size_t page = 0;
+        while (page != length) {
+            if (is_written(page)) {
+                page += EMULATED_PAGE_SIZE;
+                continue;
+            }
+            std::size_t run_end = page + EMULATED_PAGE_SIZE;
+            while (run_end != length && !is_written(run_end)) {
+                run_end += EMULATED_PAGE_SIZE;
+            }
+            const int result = mprotect(mapping + page, run_end - page, PROT_READ);
+            ASSERT_MSG(result == 0, "Failed to write-protect {:#x} bytes: {}", run_end - page,
+                       std::strerror(errno));
+            page = run_end;
+        }
+    }
+
+private:
+    static constexpr std::size_t MAX_REGISTERED = 16;
+
+    template <typename T>
+    using Registry = std::array<std::atomic<T*>, MAX_REGISTERED>;
+
+    template <typename T>
+    static bool Register(Registry<T>& registry, T* object) {
+        return Replace<T>(registry, nullptr, object);
+    }
+
+    template <typename T>
+    static bool Replace(Registry<T>& registry, T* old_object, T* new_object) {
+        for (auto& slot : registry) {
+            T* expected = old_object;
+            if (slot.compare_exchange_strong(expected, new_object)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Finds the tracked memory containing an address
+    static HostMemory* FindMemory(const u8* address) {
+        for (const auto& slot : tracked_memories) {
+            HostMemory* const memory = slot.load(std::memory_order_acquire);
+            if (memory && address >= memory->pointer && address < memory->pointer + memory->size) {
+                return memory;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Marks a page of a tracked memory as written, and makes it writable where it is mapped
+    static void MarkWritten(HostMemory& memory, std::size_t offset) {
+        SetPage(memory.written_pages.get(), offset / EMULATED_PAGE_SIZE);
+        mprotect(memory.pointer + offset, EMULATED_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    }
+
+    /// Handles a write to a write-protected page. Returns false if the page isn't tracked.
+    static bool HandleWrite(u8* page) {
+        if (HostMemory* const memory = FindMemory(page)) {
+            MarkWritten(*memory, static_cast<std::size_t>(page - memory->pointer));
+            return true;
+        }
+
+        for (const auto& slot : fastmem_arenas) {
+            const FastmemArena* const arena = slot.load(std::memory_order_acquire);
+            if (!arena || page < arena->base || page >= arena->base + FastmemArena::ARENA_SIZE) {
+                continue;
+            }
+            if (!arena->page_pointers) {
+                return false;
+            }
+            // Arenas mirror page tables, which tell the memory each page of the arena aliases
+            const std::size_t arena_page =
+                static_cast<std::size_t>(page - arena->base) / EMULATED_PAGE_SIZE;
+            const u8* const backing = arena->page_pointers[arena_page];
+            HostMemory* const memory = FindMemory(backing);
+            if (!memory) {
+                return false;
+            }
+            MarkWritten(*memory, static_cast<std::size_t>(backing - memory->pointer));
+            mprotect(page, EMULATED_PAGE_SIZE, PROT_READ | PROT_WRITE);
+            return true;
+        }
+        return false;
+    }
+
+    static void HandleFault(int sig, siginfo_t* info, void* context) {
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(info->si_addr);
+        u8* const page = reinterpret_cast<u8*>(address & ~(EMULATED_PAGE_SIZE - 1));
+        if (HandleWrite(page)) {
+            return;
+        }
+
+        const struct sigaction& previous =
+            sig == SIGSEGV ? previous_segv_action : previous_bus_action;
+        if (previous.sa_flags & SA_SIGINFO) {
+            previous.sa_sigaction(sig, info, context);
+        } else if (previous.sa_handler == SIG_DFL || previous.sa_handler == SIG_IGN) {
+            // Returning faults again, this time with the default action
+            signal(sig, SIG_DFL);
+        } else {
+            previous.sa_handler(sig);
+        }
+    }
+
+    static inline Registry<HostMemory> tracked_memories{};
+    static inline Registry<FastmemArena> fastmem_arenas{};
+    static inline struct sigaction previous_segv_action {};
+    static inline struct sigaction previous_bus_action {};
+};
+
+HostMemory::HostMemory(std::size_t size_) : size{size_} {
+    fd = CreateSharedMemoryObject();
+    if (fd != -1 && ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr != MAP_FAILED) {
+            pointer = static_cast<u8*>(ptr);
+            return;
+        }
+    }
+
+    LOG_WARNING(Common_Memory, "Failed to create shared host memory: {}", std::strerror(errno));
+    if (fd != -1) {
+        close(fd);
+        fd = -1;
+    }
+    fallback = std::make_unique<u8[]>(size);
+    pointer = fallback.get();
+}
+
+HostMemory::~HostMemory() {
+    if (written_pages) {
+        WriteTracker::Unregister(*this);
+    }
+    if (fd != -1) {
+        munmap(pointer, size);
+        close(fd);
+    }
+}
+
+bool HostMemory::TrackWrites() {
+    if (!CanAlias() || !IsHostPageSizeSupported() || !WriteTracker::InstallFaultHandler()) {
+        return false;
+    }
+    if (!written_pages) {
+        written_pages = std::make_unique<std::atomic<u64>[]>(NumPageWords(size));
+        if (!WriteTracker::Register(*this)) {
+            LOG_WARNING(Common_Memory, "Too many host memories track their writes");
+            written_pages.reset();
+            return false;
+        }
+    }
+
+    for (std::size_t word = 0; word < NumPageWords(size); ++word) {
+        written_pages[word].store(0, std::memory_order_relaxed);
+    }
+    if (mprotect(pointer, size, PROT_READ) != 0) {
+        LOG_ERROR(Common_Memory, "Failed to write-protect host memory: {}", std::strerror(errno));
+        WriteTracker::Unregister(*this);
+        written_pages.reset();
+        return false;
+    }
+    return true;
+}
+
+void HostMemory::StopTrackingWrites() {
+    if (!written_pages) {
+        return;
+    }
+    // Made writable first, so that no write faults once the memory is no longer registered
+    const int result = mprotect(pointer, size, PROT_READ | PROT_WRITE);
+    ASSERT_MSG(result == 0, "Failed to unprotect host memory: {}", std::strerror(errno));
+    WriteTracker::Unregister(*this);
+    written_pages.reset();
+}
+
+std::vector<std::size_t> HostMemory::GetWrittenPages() const {
+    if (!written_pages) {
+        return GetAllPages(size);
+    }
+    std::vector<std::size_t> pages;
+    for (std::size_t word = 0; word < NumPageWords(size); ++word) {
+        u64 bits = written_pages[word].load(std::memory_order_relaxed);
+        for (std::size_t page = word * 64; bits != 0; ++page, bits >>= 1) {
+            if (bits & 1) {
+                pages.push_back(page * EMULATED_PAGE_SIZE);
+            }
+        }
+    }
+    return pages;
+}
+
+void HostMemory::TakeContents(HostMemory& other) {
+    ASSERT(size == other.size);
+    if (!CanAlias() || !other.CanAlias()) {
+        // The other memory doesn't track writes then, so all of its pages count as written anyway
+        std::memcpy(pointer, other.pointer, size);
+        return;
+    }
+
+    // Swaps the shared memory objects, and maps each at the address of the other memory
+    std::swap(fd, other.fd);
+    std::swap(written_pages, other.written_pages);
+    WriteTracker::Swap(*this, other);
+    for (HostMemory* memory : {this, &other}) {
+        void* ptr = mmap(memory->pointer, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                         memory->fd, 0);
+        ASSERT_MSG(ptr != MAP_FAILED, "Failed to map host memory again: {}", std::strerror(errno));
+        if (memory->written_pages) {
+            WriteTracker::ProtectUnwritten(memory->pointer, *memory, 0, size);
+        }
+    }
+}
+
+FastmemArena::FastmemArena(u8* const* page_pointers_) : page_pointers{page_pointers_} {
+    if (!IsHostPageSizeSupported()) {
+        LOG_WARNING(Common_Memory, "Fastmem is not supported with host pages of {} bytes",
+                    sysconf(_SC_PAGESIZE));
+        return;
+    }
+    void* ptr = mmap(nullptr, ARENA_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                     -1, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_WARNING(Common_Memory, "Failed to reserve the fastmem arena: {}", std::strerror(errno));
+        return;
+    }
+    base = static_cast<u8*>(ptr);
+    if (!WriteTracker::Register(*this)) {
+        LOG_WARNING(Common_Memory, "Too many fastmem arenas, writes through this one are slower");
+    }
+}
+
+FastmemArena::~FastmemArena() {
+    if (base) {
+        WriteTracker::Unregister(*this);
+        munmap(base, ARENA_SIZE);
+    }
+}
+
+bool FastmemArena::Map(std::size_t offset, const HostMemory& memory, std::size_t memory_offset,
+                       std::size_t length) {
+    ASSERT(IsValid() && memory.CanAlias());
+    ASSERT(offset + length <= ARENA_SIZE && memory_offset + length <= memory.size);
+    void* ptr = mmap(base + offset, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                     memory.fd, static_cast<off_t>(memory_offset));
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Failed to map {:#x} bytes at offset {:#x}: {}", length, offset,
+                  std::strerror(errno));
+        Unmap(offset, length);
+        return false;
+    }
+    if (memory.written_pages) {
+        WriteTracker::ProtectUnwritten(base + offset, memory, memory_offset, length);
+    }
+    return true;
+}
+
+void FastmemArena::Unmap(std::size_t offset, std::size_t length) {
+    ASSERT(IsValid() && offset + length <= ARENA_SIZE);
+    void* ptr = mmap(base + offset, length, PROT_NONE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    ASSERT_MSG(ptr != MAP_FAILED, "Failed to unmap {:#x} bytes at offset {:#x}: {}", length,
+               offset, std::strerror(errno));
+}
+
+#else
+
+// Windows tracks the pages written to memory allocated with MEM_WRITE_WATCH itself. The bitmap of
+// written pages only holds the pages written before the memory took its contents over.
+
+HostMemory::HostMemory(std::size_t size_) : size{size_} {
+    pointer = static_cast<u8*>(
+        VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_WRITE_WATCH, PAGE_READWRITE));
+    if (!pointer) {
+        LOG_WARNING(Common_Memory, "Failed to allocate write-watched host memory");
+        fallback = std::make_unique<u8[]>(size);
+        pointer = fallback.get();
+    }
+}
+
+HostMemory::~HostMemory() {
+    if (!fallback) {
+        VirtualFree(pointer, 0, MEM_RELEASE);
+    }
+}
+
+bool HostMemory::TrackWrites() {
+    if (fallback || ResetWriteWatch(pointer, size) != 0) {
+        written_pages.reset();
+        return false;
+    }
+    if (!written_pages) {
+        written_pages = std::make_unique<std::atomic<u64>[]>(NumPageWords(size));
+    }
+    for (std::size_t word = 0; word < NumPageWords(size); ++word) {
+        written_pages[word].store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void HostMemory::StopTrackingWrites() {
+    written_pages.reset();
+}
+
+std::vector<std::size_t> HostMemory::GetWrittenPages() const {
+    if (!written_pages) {
+        return GetAllPages(size);
+    }
+    std::vector<PVOID> addresses(size / EMULATED_PAGE_SIZE);
+    ULONG_PTR count = addresses.size();
+    DWORD granularity;
+    if (GetWriteWatch(0, pointer, size, addresses.data(), &count, &granularity) != 0) {
+        LOG_ERROR(Common_Memory, "Failed to get the pages written to host memory");
+        return GetAllPages(size);
+    }
+
+    std::vector<bool> written(size / EMULATED_PAGE_SIZE);
+    for (std::size_t page = 0; page < written.size(); ++page) {
+        written[page] = IsPageSet(written_pages.get(), page);
+    }
+    for (ULONG_PTR i = 0; i < count; ++i) {
+        const auto offset = static_cast<std::size_t>(static_cast<u8*>(addresses[i]) - pointer);
+        for (std::size_t page = offset; page < offset + granularity && page < size;
+             page += EMULATED_PAGE_SIZE) {
+            written[page / EMULATED_PAGE_SIZE] = true;
+        }
+    }
+
+    std::vector<std::size_t> pages;
+    for (std::size_t page = 0; page < written.size(); ++page) {
+        if (written[page]) {
+            pages.push_back(page * EMULATED_PAGE_SIZE);
+        }
+    }
+    return pages;
+}
+
+void HostMemory::TakeContents(HostMemory& other) {
+    ASSERT(size == other.size);
+    std::memcpy(pointer, other.pointer, size);
+    if (!other.written_pages || !TrackWrites()) {
+        written_pages.reset();
+        return;
+    }
+    // Copying wrote every page, so the written pages of the other memory are recorded instead
+    for (const std::size_t offset : other.GetWrittenPages()) {
+        SetPage(written_pages.get(), offset / EMULATED_PAGE_SIZE);
+    }
+}
+
+#endif
+
+} // namespace Common
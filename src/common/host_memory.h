@@ -0,0 +1,136 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Zero-initialized host memory backed by an anonymous shared memory object, so that its pages can
+ * be mapped again at other addresses with a FastmemArena. Where shared memory objects aren't
+ * supported, this falls back to a regular allocation which can't be aliased.
+ */
+class HostMemory {
+public:
+    explicit HostMemory(std::size_t size);
+    ~HostMemory();
+
+    HostMemory(const HostMemory&) = delete;
+    HostMemory& operator=(const HostMemory&) = delete;
+
+    u8* GetPointer() {
+        return pointer;
+    }
+
+    const u8* GetPointer() const {
+        return pointer;
+    }
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+    /// Returns whether the memory can be mapped into a FastmemArena
+    bool CanAlias() const {
+        return fd != -1;
+    }
+
+    /**
+     * Starts tracking which pages of the memory are written, through any of its mappings and from
+     * any thread, forgetting the pages written so far. Fastmem arenas mapping the memory must map
+     * it again.
+     * @returns whether writes can be tracked on this host. If not, all pages count as written.
+     */
+    bool TrackWrites();
+
+    /**
+     * Stops tracking writes, after which all pages count as written. Fastmem arenas mapping the
+     * memory must map it again.
+     */
+    void StopTrackingWrites();
+
+    /// Returns the offsets of the pages written since TrackWrites was last called, in order
+    std::vector<std::size_t> GetWrittenPages() const;
+
+    /**
+     * Takes over the contents of another memory of the same size, along with the pages written to
+     * it, in place of its own. Both memories stay at their addresses, and the other one is left
+     * with unspecified contents. Fastmem arenas mapping either memory must be mapped again.
+     */
+    void TakeContents(HostMemory& other);
+
+private:
+    friend class FastmemArena;
+    friend class WriteTracker;
+
+    u8* pointer = nullptr;
+    std::size_t size;
+    int fd = -1;
+    std::unique_ptr<u8[]> fallback;
+
+    /// One bit per page written since TrackWrites, only allocated while writes are tracked
+    std::unique_ptr<std::atomic<u64>[]> written_pages;
+};
+
+#ifndef _WIN32
+/**
+ * A reservation of 4 GiB of host address space mirroring an emulated 32-bit address space. Pages
+ * of HostMemory are mapped at the offset of the emulated addresses they back, so that emulated
+ * code can access them directly at base + address. All other pages are inaccessible, so accessing
+ * them faults.
+ */
+class FastmemArena {
+public:
+    static constexpr u64 ARENA_SIZE = 0x100000000;
+
+    /**
+     * @param page_pointers Host pointers to the memory backing each page of the arena, which must
+     *                      be kept up to date, so that writes through the arena to memory whose
+     *                      writes are tracked can be told apart.
+     */
+    explicit FastmemArena(u8* const* page_pointers);
+    ~FastmemArena();
+
+    FastmemArena(const FastmemArena&) = delete;
+    FastmemArena& operator=(const FastmemArena&) = delete;
+
+    /// Returns whether the address space could be reserved. Only then can memory be mapped.
+    bool IsValid() const {
+        return base != nullptr;
+    }
+
+    u8* GetBase() const {
+        return base;
+    }
+
+    /**
+     * Maps a range of host memory into the arena, replacing what was mapped there before. If writes
+     * to the memory are tracked, the pages not written yet are write-protected until they are.
+     * @param offset Offset in the arena to map the memory at. Must be page-aligned.
+     * @param memory Memory to map. Must be aliasable.
+     * @param memory_offset Offset of the range in the memory. Must be page-aligned.
+     * @param length Length of the range. Must be page-aligned.
+     * @returns whether the memory was mapped. If not, the range is left inaccessible.
+     */
+    bool Map(std::size_t offset, const HostMemory& memory, std::size_t memory_offset,
+             std::size_t length);
+
+    /// Makes a range of the arena inaccessible again. All parameters must be page-aligned.
+    void Unmap(std::size_t offset, std::size_t length);
+
+private:
+    friend class WriteTracker;
+
+    u8* base = nullptr;
+    u8* const* page_pointers;
+};
+#endif
+
+} // namespace Common
@@ -0,0 +1,87 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(std::size_t num_threads, std::string name_) : name(std::move(name_)) {
+    const std::size_t num_workers = num_threads > 1 ? num_threads - 1 : 0;
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    work_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func) {
+    if (workers.empty() || count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock{mutex};
+        job = &func;
+        job_count = count;
+        next_item = 0;
+        pending_workers = workers.size();
+        ++generation;
+    }
+    work_cv.notify_all();
+
+    RunItems();
+
+    std::unique_lock lock{mutex};
+    done_cv.wait(lock, [this] { return pending_workers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    SetCurrentThreadName(name.c_str());
+
+    std::size_t last_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock{mutex};
+            work_cv.wait(lock, [&] { return stop || generation != last_generation; });
+            if (stop) {
+                return;
+            }
+            last_generation = generation;
+        }
+
+        RunItems();
+
+        {
+            std::lock_guard lock{mutex};
+            if (--pending_workers == 0) {
+                done_cv.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::RunItems() {
+    // job and job_count are only written while no worker is inside RunItems
+    for (std::size_t i = next_item++; i < job_count; i = next_item++) {
+        (*job)(i);
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,66 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed set of worker threads used for fork-join style data parallelism. Work is submitted with
+ * ParallelFor, which blocks the calling thread (and makes it take part in the work) until every
+ * item has been processed. Only one thread may submit work to a pool at a time.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads Total number of threads that process work, including the calling thread.
+     *                    A value of 0 or 1 runs all work inline on the calling thread.
+     * @param name Debugger-visible name of the worker threads
+     */
+    explicit ThreadPool(std::size_t num_threads, std::string name = "ThreadPool");
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Returns the total number of threads processing work, including the calling thread.
+    std::size_t NumThreads() const {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Calls func(i) for every i in [0, count), distributing the calls over the pool. Items are
+     * handed out in increasing order, but may complete in any order.
+     */
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func);
+
+private:
+    void WorkerLoop();
+    void RunItems();
+
+    std::vector<std::thread> workers;
+    std::string name;
+
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    bool stop = false;
+    std::size_t generation = 0;     ///< Incremented each time a new job is submitted
+    std::size_t pending_workers = 0; ///< Workers that have not finished the current job yet
+
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::size_t job_count = 0;
+    std::atomic<std::size_t> next_item{0};
+};
+
+} // namespace Common
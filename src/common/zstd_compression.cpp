@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <utility>
 #include <zstd.h>
 
 #include "common/assert.h"
@@ -48,4 +49,110 @@ std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
     return decompressed;
 }
 
+std::vector<u8> DecompressDataZSTD(const u8* compressed, std::size_t compressed_size,
+                                   std::size_t max_size) {
+    const unsigned long long decompressed_size =
+        ZSTD_getFrameContentSize(compressed, compressed_size);
+    if (decompressed_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+        decompressed_size == ZSTD_CONTENTSIZE_ERROR || decompressed_size > max_size) {
+        return {};
+    }
+    std::vector<u8> decompressed(static_cast<std::size_t>(decompressed_size));
+
+    const std::size_t uncompressed_result_size =
+        ZSTD_decompress(decompressed.data(), decompressed.size(), compressed, compressed_size);
+
+    if (ZSTD_isError(uncompressed_result_size) ||
+        uncompressed_result_size != decompressed.size()) {
+        // Decompression failed
+        return {};
+    }
+    return decompressed;
+}
+
+ZSTDStreamCompressor::ZSTDStreamCompressor(Sink sink_, s32 compression_level)
+    : sink(std::move(sink_)), context(ZSTD_createCCtx()), out_buffer(ZSTD_CStreamOutSize()) {
+    compression_level = std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+    // The checksum lets readers detect damaged data before acting on any of it
+    if (!context ||
+        ZSTD_isError(ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, compression_level)) ||
+        ZSTD_isError(ZSTD_CCtx_setParameter(context, ZSTD_c_checksumFlag, 1))) {
+        failed = true;
+    }
+}
+
+ZSTDStreamCompressor::ZSTDStreamCompressor(Sink sink_)
+    : ZSTDStreamCompressor(std::move(sink_), ZSTD_CLEVEL_DEFAULT) {}
+
+ZSTDStreamCompressor::~ZSTDStreamCompressor() {
+    ZSTD_freeCCtx(context);
+}
+
+bool ZSTDStreamCompressor::Write(const u8* source, std::size_t source_size) {
+    return Compress(source, source_size, false);
+}
+
+bool ZSTDStreamCompressor::Finish() {
+    return Compress(nullptr, 0, true);
+}
+
+bool ZSTDStreamCompressor::Compress(const u8* source, std::size_t source_size, bool end) {
+    if (failed) {
+        return false;
+    }
+
+    ZSTD_inBuffer input{source, source_size, 0};
+    std::size_t remaining;
+    do {
+        ZSTD_outBuffer output{out_buffer.data(), out_buffer.size(), 0};
+        remaining =
+            ZSTD_compressStream2(context, &output, &input, end ? ZSTD_e_end : ZSTD_e_continue);
+        if (ZSTD_isError(remaining) || (output.pos != 0 && !sink(out_buffer.data(), output.pos))) {
+            failed = true;
+            return false;
+        }
+        // When ending the stream, the remaining count is the amount of data left to flush
+    } while (input.pos != input.size || (end && remaining != 0));
+    return true;
+}
+
+ZSTDStreamDecompressor::ZSTDStreamDecompressor(Source source_)
+    : source(std::move(source_)), context(ZSTD_createDCtx()), in_buffer(ZSTD_DStreamInSize()) {
+    failed = context == nullptr;
+}
+
+ZSTDStreamDecompressor::~ZSTDStreamDecompressor() {
+    ZSTD_freeDCtx(context);
+}
+
+std::size_t ZSTDStreamDecompressor::Read(u8* destination, std::size_t destination_size) {
+    ZSTD_outBuffer output{destination, destination_size, 0};
+    while (output.pos < output.size && !finished && !failed) {
+        ZSTD_inBuffer input{in_buffer.data(), in_size, in_pos};
+        const std::size_t out_pos = output.pos;
+        const std::size_t result = ZSTD_decompressStream(context, &output, &input);
+        if (ZSTD_isError(result)) {
+            failed = true;
+            break;
+        }
+
+        const bool made_progress = input.pos != in_pos || output.pos != out_pos;
+        in_pos = input.pos;
+        if (made_progress) {
+            // A result of 0 means that a frame was completed and fully flushed
+            frame_pending = result != 0;
+            continue;
+        }
+
+        // No progress without new compressed data
+        in_size = source(in_buffer.data(), in_buffer.size());
+        in_pos = 0;
+        if (in_size == 0) {
+            finished = true;
+            failed = frame_pending;
+        }
+    }
+    return output.pos;
+}
+
 } // namespace Common::Compression
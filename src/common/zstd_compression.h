@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "common/common_types.h"
 
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
 namespace Common::Compression {
 
 /**
@@ -42,4 +46,103 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed);
 
+/**
+ * Decompresses a source memory region with Zstandard and returns the uncompressed data in a vector,
+ * refusing to decompress more than a maximum size. Meant for data received from untrusted peers.
+ *
+ * @param compressed the compressed source memory region.
+ * @param compressed_size the size in bytes of the compressed source memory region.
+ * @param max_size the maximum size in bytes of the uncompressed data.
+ *
+ * @return the decompressed data, empty if it is invalid or larger than max_size.
+ */
+[[nodiscard]] std::vector<u8> DecompressDataZSTD(const u8* compressed, std::size_t compressed_size,
+                                                 std::size_t max_size);
+
+/**
+ * Compresses data with Zstandard while it is written, passing the compressed data to a sink in
+ * chunks. Neither the uncompressed nor the compressed data is ever held in memory as a whole.
+ * Frames carry a checksum of their content, which the decompressor verifies.
+ */
+class ZSTDStreamCompressor {
+public:
+    /// Receives a chunk of compressed data. Returns false if the data could not be stored.
+    using Sink = std::function<bool(const u8* data, std::size_t size)>;
+
+    /**
+     * @param sink the sink receiving the compressed data.
+     * @param compression_level the used compression level. Should be between 1 and 22.
+     */
+    ZSTDStreamCompressor(Sink sink, s32 compression_level);
+
+    /// Creates a compressor with the default compression level
+    explicit ZSTDStreamCompressor(Sink sink);
+
+    ~ZSTDStreamCompressor();
+
+    ZSTDStreamCompressor(const ZSTDStreamCompressor&) = delete;
+    ZSTDStreamCompressor& operator=(const ZSTDStreamCompressor&) = delete;
+
+    /**
+     * Compresses a source memory region. Compressed data may be held back until later writes.
+     *
+     * @return false if compression failed or the sink failed to store the data.
+     */
+    bool Write(const u8* source, std::size_t source_size);
+
+    /**
+     * Compresses the data held back and ends the stream. No data may be written afterwards.
+     *
+     * @return false if compression failed or the sink failed to store the data.
+     */
+    bool Finish();
+
+private:
+    bool Compress(const u8* source, std::size_t source_size, bool end);
+
+    Sink sink;
+    ZSTD_CCtx_s* context;
+    std::vector<u8> out_buffer;
+    bool failed = false;
+};
+
+/**
+ * Decompresses data with Zstandard while it is read, pulling the compressed data from a source in
+ * chunks.
+ */
+class ZSTDStreamDecompressor {
+public:
+    /// Reads up to size bytes of compressed data. Returns the number of bytes, 0 at the end.
+    using Source = std::function<std::size_t(u8* data, std::size_t size)>;
+
+    explicit ZSTDStreamDecompressor(Source source);
+    ~ZSTDStreamDecompressor();
+
+    ZSTDStreamDecompressor(const ZSTDStreamDecompressor&) = delete;
+    ZSTDStreamDecompressor& operator=(const ZSTDStreamDecompressor&) = delete;
+
+    /**
+     * Decompresses data into a destination memory region.
+     *
+     * @return the number of bytes decompressed. Less than destination_size only at the end of the
+     *         data or if decompression failed.
+     */
+    std::size_t Read(u8* destination, std::size_t destination_size);
+
+    /// Returns true if the compressed data was invalid or ended in the middle of a frame
+    bool IsFailed() const {
+        return failed;
+    }
+
+private:
+    Source source;
+    ZSTD_DCtx_s* context;
+    std::vector<u8> in_buffer;
+    std::size_t in_size = 0;
+    std::size_t in_pos = 0;
+    bool frame_pending = false;
+    bool finished = false;
+    bool failed = false;
+};
+
 } // namespace Common::Compression
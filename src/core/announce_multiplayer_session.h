@@ -29,6 +29,8 @@ class AnnounceMultiplayerSession : NonCopyable {
 public:
     using CallbackHandle = std::shared_ptr<std::function<void(const Common::WebResult&)>>;
     AnnounceMultiplayerSession();
+    /// Announces the given room instead of the room of the global network instance
+    explicit AnnounceMultiplayerSession(std::weak_ptr<Network::Room> room);
     ~AnnounceMultiplayerSession();
 
     /**
@@ -84,6 +86,9 @@ private:
     std::set<CallbackHandle> error_callbacks;
     std::unique_ptr<std::thread> announce_multiplayer_thread;
 
+    /// The announced room
+    std::weak_ptr<Network::Room> announced_room;
+
     /// Backend interface that logs fields
     std::unique_ptr<AnnounceMultiplayerRoom::Backend> backend;
 
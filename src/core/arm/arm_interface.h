@@ -226,6 +226,9 @@ public:
     /// Prepare core for thread reschedule (if needed to correctly handle state)
     virtual void PrepareReschedule() = 0;
 
+    /// Clears the address marked by the last exclusive load, so that the next exclusive store fails
+    virtual void ClearExclusiveState() = 0;
+
     virtual void PurgeState() = 0;
 
     Core::Timing::Timer& GetTimer() {
@@ -240,10 +243,10 @@ public:
         return id;
     }
 
-protected:
-    // This us used for serialization. Returning nullptr is valid if page tables are not used.
+    // This is used for serialization. Returning nullptr is valid if page tables are not used.
     virtual std::shared_ptr<Memory::PageTable> GetPageTable() const = 0;
 
+protected:
     std::shared_ptr<Core::Timing::Timer> timer;
 
 private:
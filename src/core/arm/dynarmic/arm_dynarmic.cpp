@@ -6,14 +6,17 @@
 #include <dynarmic/A32/a32.h>
 #include <dynarmic/A32/context.h>
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
+#include "core/arm/dynarmic/arm_exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 class DynarmicThreadContext final : public ARM_Interface::ThreadContext {
 public:
@@ -100,6 +103,22 @@ public:
         memory.Write64(vaddr, value);
     }
 
+    bool MemoryWriteExclusive8(VAddr vaddr, std::uint8_t value, std::uint8_t expected) override {
+        return memory.WriteExclusive8(vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive16(VAddr vaddr, std::uint16_t value,
+                                std::uint16_t expected) override {
+        return memory.WriteExclusive16(vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive32(VAddr vaddr, std::uint32_t value,
+                                std::uint32_t expected) override {
+        return memory.WriteExclusive32(vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive64(VAddr vaddr, std::uint64_t value,
+                                std::uint64_t expected) override {
+        return memory.WriteExclusive64(vaddr, value, expected);
+    }
+
     void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {
         // Should never happen.
         UNREACHABLE_MSG("InterpeterFallback reached with pc = 0x{:08x}, code = 0x{:08x}, num = {}",
@@ -150,8 +169,10 @@ public:
 };
 
 ARM_Dynarmic::ARM_Dynarmic(Core::System* system, Memory::MemorySystem& memory, u32 id,
-                           std::shared_ptr<Core::Timing::Timer> timer)
+                           std::shared_ptr<Core::Timing::Timer> timer,
+                           Core::ExclusiveMonitor& exclusive_monitor)
     : ARM_Interface(id, timer), system(*system), memory(memory),
+      exclusive_monitor(static_cast<Core::DynarmicExclusiveMonitor&>(exclusive_monitor)),
       cb(std::make_unique<DynarmicUserCallbacks>(*this)) {
     SetPageTable(memory.GetCurrentPageTable());
 }
@@ -281,6 +302,11 @@ void ARM_Dynarmic::PrepareReschedule() {
     }
 }
 
+void ARM_Dynarmic::ClearExclusiveState() {
+    jit->ClearExclusiveState();
+    exclusive_monitor.ClearExclusive(GetID());
+}
+
 void ARM_Dynarmic::ClearInstructionCache() {
     for (const auto& j : jits) {
         j.second->ClearCache();
@@ -326,6 +352,19 @@ std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.callbacks = cb.get();
     config.page_table = &current_page_table->GetPointerArray();
+    // Exclusive stores check the monitor shared by all cores, then write with a compare-and-swap,
+    // so that they stay atomic when the cores run on different host threads
+    config.processor_id = GetID();
+    config.global_monitor = &exclusive_monitor.monitor;
+    if (Settings::values.use_cpu_fastmem) {
+        // Accesses faulting in the arena are caught by dynarmic, which then recompiles the block
+        // to go through the page table and the memory callbacks instead
+        config.fastmem_pointer = memory.GetFastmemBase(*current_page_table);
+        config.recompile_on_fastmem_failure = true;
+        if (!config.fastmem_pointer) {
+            LOG_WARNING(Core_ARM11, "Fastmem is not supported on this host, disabling it");
+        }
+    }
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
     config.define_unpredictable_behaviour = true;
     return std::make_unique<Dynarmic::A32::Jit>(config);
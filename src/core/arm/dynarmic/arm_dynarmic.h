@@ -17,15 +17,18 @@ class MemorySystem;
 } // namespace Memory
 
 namespace Core {
+class DynarmicExclusiveMonitor;
+class ExclusiveMonitor;
 class System;
-}
+} // namespace Core
 
 class DynarmicUserCallbacks;
 
 class ARM_Dynarmic final : public ARM_Interface {
 public:
     ARM_Dynarmic(Core::System* system, Memory::MemorySystem& memory, u32 id,
-                 std::shared_ptr<Core::Timing::Timer> timer);
+                 std::shared_ptr<Core::Timing::Timer> timer,
+                 Core::ExclusiveMonitor& exclusive_monitor);
     ~ARM_Dynarmic() override;
 
     void Run() override;
@@ -49,6 +52,7 @@ public:
     void LoadContext(const std::unique_ptr<ThreadContext>& arg) override;
 
     void PrepareReschedule() override;
+    void ClearExclusiveState() override;
 
     void ClearInstructionCache() override;
     void InvalidateCacheRange(u32 start_address, std::size_t length) override;
@@ -64,6 +68,7 @@ private:
     friend class DynarmicUserCallbacks;
     Core::System& system;
     Memory::MemorySystem& memory;
+    Core::DynarmicExclusiveMonitor& exclusive_monitor;
     std::unique_ptr<DynarmicUserCallbacks> cb;
     std::unique_ptr<Dynarmic::A32::Jit> MakeJit();
 
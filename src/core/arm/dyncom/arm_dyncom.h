@@ -50,6 +50,7 @@ public:
 
     void SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) override;
     void PrepareReschedule() override;
+    void ClearExclusiveState() override;
     void PurgeState() override;
 
 protected:
@@ -0,0 +1,23 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/arm/exclusive_monitor.h"
+#ifdef ARCHITECTURE_x86_64
+#include "core/arm/dynarmic/arm_exclusive_monitor.h"
+#endif
+
+namespace Core {
+
+ExclusiveMonitor::~ExclusiveMonitor() = default;
+
+std::unique_ptr<ExclusiveMonitor> MakeExclusiveMonitor(std::size_t num_cores) {
+#ifdef ARCHITECTURE_x86_64
+    return std::make_unique<DynarmicExclusiveMonitor>(num_cores);
+#else
+    // The interpreter only runs the cores one at a time, on the emulation thread
+    return nullptr;
+#endif
+}
+
+} // namespace Core
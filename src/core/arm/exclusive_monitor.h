@@ -0,0 +1,31 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace Core {
+
+/**
+ * The global exclusive monitor shared by all CPU cores. It tracks the addresses marked by the
+ * exclusive loads of each core, so that exclusive stores stay atomic when the cores run on
+ * different host threads.
+ */
+class ExclusiveMonitor {
+public:
+    virtual ~ExclusiveMonitor();
+
+    /// Clears the address marked by a core, so that its next exclusive store fails
+    virtual void ClearExclusive(std::size_t core_index) = 0;
+};
+
+/**
+ * Creates the exclusive monitor used by the CPU cores of this host.
+ * @returns The monitor, or nullptr when the cores do not need one
+ */
+std::unique_ptr<ExclusiveMonitor> MakeExclusiveMonitor(std::size_t num_cores);
+
+} // namespace Core
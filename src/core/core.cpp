@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <utility>
 #include <boost/serialization/array.hpp>
@@ -17,6 +19,7 @@
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #endif
 #include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/exclusive_monitor.h"
 #include "core/cheats/cheats.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -27,10 +30,13 @@
 #include "core/custom_tex_cache.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/global.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/service/call_profiler.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hle/service/pm/pm_app.h"
@@ -41,6 +47,7 @@
 #include "core/hw/lcd.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
+#include "core/multi_core_runner.h"
 #include "core/rpc/rpc_server.h"
 #include "core/settings.h"
 #include "network/network.h"
@@ -122,6 +129,19 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         frame_limiter.WaitOnce();
         return ResultStatus::Success;
     }
+    case Signal::SaveDelta: {
+        LOG_INFO(Core, "Begin delta save");
+        try {
+            System::SaveDeltaState(param);
+            LOG_INFO(Core, "Delta save completed");
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error saving: {}", e.what());
+            status_details = e.what();
+            return ResultStatus::ErrorSavestate;
+        }
+        frame_limiter.WaitOnce();
+        return ResultStatus::Success;
+    }
     case Signal::Save: {
         LOG_INFO(Core, "Begin save");
         try {
@@ -195,27 +215,31 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
-        for (auto& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            auto start_ticks = cpu_core->GetTimer().GetTicks();
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
-            // If we don't have a currently active thread then don't execute instructions,
-            // instead advance to the next event and try to yield to the next thread
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (tight_loop) {
-                    cpu_core->Run();
+        if (CanRunCoresInParallel(tight_loop)) {
+            RunCoresInParallel(max_slice);
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                auto start_ticks = cpu_core->GetTimer().GetTicks();
+                LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                          cpu_core->GetTimer().GetDowncount());
+                running_core = cpu_core.get();
+                kernel->SetRunningCPU(running_core);
+                // If we don't have a currently active thread then don't execute instructions,
+                // instead advance to the next event and try to yield to the next thread
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
                 } else {
-                    cpu_core->Step();
+                    if (tight_loop) {
+                        cpu_core->Run();
+                    } else {
+                        cpu_core->Step();
+                    }
                 }
+                max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
             }
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
         }
     }
 
@@ -307,6 +331,9 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
                   static_cast<u32>(load_result));
     }
     perf_stats = std::make_unique<PerfStats>(title_id);
+    call_profiler = std::make_unique<Service::CallProfiler>(title_id);
+    guest_profiler = std::make_unique<Core::GuestProfiler>(
+        *this, title_id, Settings::values.guest_profiler_interval);
     custom_tex_cache = std::make_unique<Core::CustomTexCache>();
 
     if (Settings::values.custom_textures) {
@@ -351,6 +378,84 @@ void System::Reschedule() {
     }
 }
 
+bool System::DeferSVC(u32 immediate) {
+    if (!multi_core_runner) {
+        return false;
+    }
+    const std::optional<std::size_t> core_id = multi_core_runner->DeferSVC(immediate);
+    if (!core_id) {
+        return false;
+    }
+    // The core continues after the system call once the CPU thread has executed it
+    cpu_cores[*core_id]->PrepareReschedule();
+    return true;
+}
+
+bool System::CanRunCoresInParallel(bool tight_loop) const {
+    if (!multi_core_runner || !tight_loop || GDBStub::IsServerEnabled()) {
+        return false;
+    }
+
+    // Exclusive loads and stores are only atomic across host threads through the shared monitor
+    if (!exclusive_monitor) {
+        return false;
+    }
+
+    // Cores running in parallel race for the emulated memory, which breaks the determinism
+    // required to record and replay movies
+    if (Movie::GetInstance().GetPlayMode() != Movie::PlayMode::None) {
+        return false;
+    }
+
+    // Accesses to memory cached by the hardware renderer call into the renderer, which must only
+    // happen on the CPU thread
+    if (Settings::values.use_hw_renderer) {
+        return false;
+    }
+
+    // Memory accesses outside the page table of a core use the page table of the current
+    // process, which is only correct if all cores run the same process
+    const auto page_table = cpu_cores[0]->GetPageTable();
+    return std::all_of(cpu_cores.begin(), cpu_cores.end(), [&page_table](const auto& cpu_core) {
+        return cpu_core->GetPageTable() == page_table;
+    });
+}
+
+void System::RunCoresInParallel(s64 max_slice) {
+    // Idle cores are handled up front as this touches kernel state
+    u32 idle_cores = 0;
+    for (auto& cpu_core : cpu_cores) {
+        cpu_core->GetTimer().SetNextSlice(max_slice);
+        LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                  cpu_core->GetTimer().GetDowncount());
+        running_core = cpu_core.get();
+        kernel->SetRunningCPU(running_core);
+        if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+            cpu_core->GetTimer().Idle();
+            PrepareReschedule();
+            idle_cores |= 1u << cpu_core->GetID();
+        }
+    }
+
+    multi_core_runner->RunSlice([this, idle_cores](std::size_t core_id) {
+        if ((idle_cores & (1u << core_id)) == 0) {
+            cpu_cores[core_id]->Run();
+        }
+    });
+
+    // System calls are executed in core order. Cores that stopped early for a system call are
+    // behind the others now and catch up on the next iterations of the loop.
+    for (auto& cpu_core : cpu_cores) {
+        const std::optional<u32> svc = multi_core_runner->TakePendingSVC(cpu_core->GetID());
+        running_core = cpu_core.get();
+        kernel->SetRunningCPU(running_core);
+        if (svc) {
+            Kernel::SVCContext{*this}.CallSVC(*svc);
+        }
+    }
+}
+
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mode, u8 n3ds_mode,
                                   u32 num_cores) {
     LOG_DEBUG(HW_Memory, "initialized OK");
@@ -364,9 +469,15 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     if (Settings::values.use_cpu_jit) {
 #ifdef ARCHITECTURE_x86_64
+        exclusive_monitor = MakeExclusiveMonitor(num_cores);
         for (u32 i = 0; i < num_cores; ++i) {
-            cpu_cores.push_back(
-                std::make_shared<ARM_Dynarmic>(this, *memory, i, timing->GetTimer(i)));
+            cpu_cores.push_back(std::make_shared<ARM_Dynarmic>(
+                this, *memory, i, timing->GetTimer(i), *exclusive_monitor));
+        }
+        // Running the cores on threads of their own relies on the JIT stopping right after a
+        // system call
+        if (Settings::values.use_cpu_threads && num_cores > 1) {
+            multi_core_runner = std::make_unique<MultiCoreRunner>(num_cores);
         }
 #else
         for (u32 i = 0; i < num_cores; ++i) {
@@ -486,6 +597,14 @@ const Cheats::CheatEngine& System::CheatEngine() const {
     return *cheat_engine;
 }
 
+Service::CallProfiler& System::CallProfiler() {
+    return *call_profiler;
+}
+
+Core::GuestProfiler& System::GuestProfiler() {
+    return *guest_profiler;
+}
+
 VideoDumper::Backend& System::VideoDumper() {
     return *video_dumper;
 }
@@ -532,15 +651,21 @@ void System::Shutdown(bool is_deserializing) {
     if (!is_deserializing) {
         GDBStub::Shutdown();
         perf_stats.reset();
+        call_profiler.reset();
+        guest_profiler.reset();
         cheat_engine.reset();
         app_loader.reset();
+        delta_base_id = 0;
+        delta_base_captured = false;
     }
     telemetry_session.reset();
     rpc_server.reset();
     archive_manager.reset();
     service_manager.reset();
     dsp_core.reset();
+    multi_core_runner.reset();
     cpu_cores.clear();
+    exclusive_monitor.reset();
     kernel.reset();
     timing.reset();
 
@@ -575,15 +700,22 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
     }
     ar& num_cores;
 
+    std::unique_ptr<Memory::MemorySystem> base_memory;
     if (Archive::is_loading::value) {
         // When loading, we want to make sure any lingering state gets cleared out before we begin.
         // Shutdown, but persist a few things between loads...
         Shutdown(true);
 
+        // A delta savestate only stores the memory pages written since its base, just loaded
+        if (loading_delta_state) {
+            base_memory = std::move(memory);
+        }
+
         // Re-initialize everything like it was before
         auto system_mode = this->app_loader->LoadKernelSystemMode();
         auto n3ds_mode = this->app_loader->LoadKernelN3dsMode();
         Init(*m_emu_window, *system_mode.first, *n3ds_mode.first, num_cores);
+        memory->SetLoadDeltaBase(base_memory.get());
     }
 
     // flush on save, don't flush on load
@@ -619,6 +751,7 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
         Service::GSP::SetGlobalModule(*this);
         memory->SetDSP(*dsp_core);
         cheat_engine->Connect();
+        guest_profiler->Connect();
         VideoCore::g_renderer->Sync();
     }
 }
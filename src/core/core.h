@@ -37,6 +37,7 @@ class RPCServer;
 }
 
 namespace Service {
+class CallProfiler;
 namespace SM {
 class ServiceManager;
 }
@@ -61,6 +62,9 @@ class RendererBase;
 
 namespace Core {
 
+class ExclusiveMonitor;
+class GuestProfiler;
+class MultiCoreRunner;
 class Timing;
 
 class System {
@@ -120,7 +124,7 @@ public:
     /// Shutdown and then load again
     void Reset();
 
-    enum class Signal : u32 { None, Shutdown, Reset, Save, Load };
+    enum class Signal : u32 { None, Shutdown, Reset, Save, Load, SaveDelta };
 
     bool SendSignal(Signal signal, u32 param = 0);
 
@@ -166,6 +170,13 @@ public:
     /// Prepare the core emulation for a reschedule
     void PrepareReschedule();
 
+    /**
+     * Called on entry to a system call. While the cores run on threads of their own, the calling
+     * core is stopped and the system call is executed by the CPU thread at the end of the slice.
+     * @returns true if the system call was deferred and must not be executed by the caller
+     */
+    bool DeferSVC(u32 immediate);
+
     PerfStats::Results GetAndResetPerfStats();
 
     /**
@@ -249,6 +260,12 @@ public:
     /// Gets a const reference to the cheat engine
     const Cheats::CheatEngine& CheatEngine() const;
 
+    /// Gets a reference to the HLE service call profiler
+    Service::CallProfiler& CallProfiler();
+
+    /// Gets a reference to the guest code profiler
+    Core::GuestProfiler& GuestProfiler();
+
     /// Gets a reference to the custom texture cache system
     Core::CustomTexCache& CustomTexCache();
 
@@ -304,7 +321,22 @@ public:
         return registered_image_interface;
     }
 
-    void SaveState(u32 slot) const;
+    /// Saves a full savestate, which becomes the base of subsequent delta savestates if enabled
+    void SaveState(u32 slot);
+
+    /**
+     * Enables or disables saving delta savestates, which is off by default. While enabled, each
+     * full savestate saved or loaded becomes the base of delta savestates, and the memory pages
+     * written after it are tracked, at the cost of a page fault on the first write to each page.
+     */
+    void SetDeltaStatesEnabled(bool enabled);
+
+    /**
+     * Saves a delta savestate, which only contains the memory pages written since the last
+     * full savestate was saved or loaded with delta savestates enabled. Loading it requires the
+     * slot of that savestate.
+     */
+    void SaveDeltaState(u32 slot) const;
 
     void LoadState(u32 slot);
 
@@ -322,6 +354,12 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Returns whether the next slice may run the cores on threads of their own
+    bool CanRunCoresInParallel(bool tight_loop) const;
+
+    /// Runs a slice of max_slice ticks on all cores in parallel
+    void RunCoresInParallel(s64 max_slice);
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -329,6 +367,12 @@ private:
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
 
+    /// Exclusive monitor shared by the JIT cores, only created when the JIT is used
+    std::unique_ptr<ExclusiveMonitor> exclusive_monitor;
+
+    /// Host threads of the cores, only created if use_cpu_threads is enabled
+    std::unique_ptr<MultiCoreRunner> multi_core_runner;
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -348,6 +392,12 @@ private:
     /// Cheats manager
     std::unique_ptr<Cheats::CheatEngine> cheat_engine;
 
+    /// HLE service call profiler
+    std::unique_ptr<Service::CallProfiler> call_profiler;
+
+    /// Guest code profiler
+    std::unique_ptr<Core::GuestProfiler> guest_profiler;
+
     /// Video dumper backend
     std::unique_ptr<VideoDumper::Backend> video_dumper;
 
@@ -366,6 +416,16 @@ private:
     std::unique_ptr<Kernel::KernelSystem> kernel;
     std::unique_ptr<Timing> timing;
 
+    /// ID and slot of the full savestate delta savestates are saved on top of, the ID is 0 if none
+    u64 delta_base_id = 0;
+    u32 delta_base_slot = 0;
+    /// Whether delta savestates are enabled, and whether the pages written since the base are
+    /// tracked
+    bool delta_states_enabled = false;
+    bool delta_base_captured = false;
+    /// Set while loading a delta savestate, whose memory is loaded on top of the current one
+    bool loading_delta_state = false;
+
 private:
     static System s_instance;
 
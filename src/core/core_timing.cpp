@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <iterator>
 #include <tuple>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -47,16 +48,18 @@ TimingEventType* Timing::RegisterEvent(const std::string& name, TimedCallback ca
     return event_type;
 }
 
-void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type, u64 userdata,
-                           std::size_t core_id) {
+Timing::EventHandle Timing::ScheduleEvent(s64 cycles_into_future,
+                                          const TimingEventType* event_type, u64 userdata,
+                                          std::size_t core_id) {
     ASSERT(event_type != nullptr);
-    Timing::Timer* timer = nullptr;
     if (core_id == std::numeric_limits<std::size_t>::max()) {
-        timer = current_timer;
-    } else {
-        ASSERT(core_id < timers.size());
-        timer = timers.at(core_id).get();
+        const auto it = std::find_if(timers.begin(), timers.end(), [this](const auto& timer) {
+            return timer.get() == current_timer;
+        });
+        core_id = static_cast<std::size_t>(std::distance(timers.begin(), it));
     }
+    ASSERT(core_id < timers.size());
+    Timing::Timer* timer = timers[core_id].get();
 
     s64 timeout = timer->GetTicks() + cycles_into_future;
     if (current_timer == timer) {
@@ -64,42 +67,38 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
         if (!timer->is_timer_sane)
             timer->ForceExceptionCheck(cycles_into_future);
 
-        timer->event_queue.emplace_back(
-            Event{timeout, timer->event_fifo_id++, userdata, event_type});
-        std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-    } else {
-        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                   userdata, event_type});
+        const auto handle =
+            timer->event_queue.Insert(Event{timeout, timer->event_fifo_id++, userdata, event_type});
+        return {core_id, handle};
     }
+
+    timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
+                               userdata, event_type});
+    return {};
 }
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
+        // Events from other cores still in ts_queue have to be removed as well
+        timer->MoveEvents();
+        timer->event_queue.RemoveIf(
             [&](const Event& e) { return e.type == event_type && e.userdata == userdata; });
+    }
+}
 
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+bool Timing::UnscheduleEvent(const EventHandle& handle) {
+    if (!handle.IsValid()) {
+        return false;
     }
-    // TODO:remove events from ts_queue
+    ASSERT(handle.core_id < timers.size());
+    return timers[handle.core_id]->event_queue.Remove(handle.wheel_handle);
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->MoveEvents();
+        timer->event_queue.RemoveIf([&](const Event& e) { return e.type == event_type; });
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::SetCurrentTimer(std::size_t core_id) {
@@ -159,14 +158,12 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 void Timing::Timer::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Insert(ev);
     }
 }
 
-s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
+s64 Timing::Timer::GetMaxSliceLength() {
+    if (const Event* next_event = event_queue.Peek()) {
         ASSERT(next_event->time - executed_ticks > 0);
         return next_event->time - executed_ticks;
     }
@@ -184,10 +181,11 @@ void Timing::Timer::Advance() {
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    // Events are never scheduled into the past of the timer, except for negative delays
+    event_queue.SetTime(executed_ticks);
+
+    while (!event_queue.Empty() && event_queue.Peek()->time <= executed_ticks) {
+        const Event evt = event_queue.Pop();
         if (evt.type->callback != nullptr) {
             evt.type->callback(evt.userdata, executed_ticks - evt.time);
         } else {
@@ -202,9 +200,9 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
     slice_length = max_slice_length;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (const Event* next_event = event_queue.Peek()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+            std::min<s64>(next_event->time - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length;
@@ -29,6 +29,7 @@
 #include "common/logging/log.h"
 #include "common/threadsafe_queue.h"
 #include "core/global.h"
+#include "core/timing_wheel.h"
 
 // The timing we get from the assembly is 268,111,855.956 Hz
 // It is possible that this number isn't just an integer because the compiler could have
@@ -171,6 +172,20 @@ public:
         BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
+    /**
+     * Refers to an event scheduled with ScheduleEvent. Events scheduled from another core than the
+     * target core are queued until the target core advances, and get an invalid handle. Handles
+     * are not preserved by savestates.
+     */
+    struct EventHandle {
+        std::size_t core_id = 0;
+        TimingWheelHandle wheel_handle;
+
+        bool IsValid() const {
+            return wheel_handle.IsValid();
+        }
+    };
+
     // currently Service::HID::pad_update_ticks is the smallest interval for an event that gets
     // always scheduled. Therfore we use this as orientation for the MAX_SLICE_LENGTH
     // For performance bigger slice length are desired, though this will lead to cores desync
@@ -184,7 +199,7 @@ public:
         Timer();
         ~Timer();
 
-        s64 GetMaxSliceLength() const;
+        s64 GetMaxSliceLength();
 
         void Advance();
 
@@ -205,11 +220,9 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accomodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+        // Events ordered by time and fifo_order. Unlike a heap, the timing wheel allows removing
+        // arbitrary events in constant time.
+        TimingWheel<Event> event_queue;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
         // to the event_queue by the emu thread
@@ -238,12 +251,24 @@ public:
             // TODO(SaveState): Remove the next two lines when we break compatibility
             s64 x;
             ar& x; // to keep compatibility with old save states that stored global_timer
-            ar& event_queue;
+            // Events are stored as a vector, like the heap that preceded the timing wheel
+            std::vector<Event> events;
+            if (Archive::is_saving::value) {
+                events = event_queue.GetEvents();
+            }
+            ar& events;
             ar& event_fifo_id;
             ar& slice_length;
             ar& downcount;
             ar& executed_ticks;
             ar& idled_cycles;
+            if (Archive::is_loading::value) {
+                event_queue.Clear();
+                event_queue.SetTime(executed_ticks);
+                for (const Event& event : events) {
+                    event_queue.Insert(event);
+                }
+            }
         }
         friend class boost::serialization::access;
     };
@@ -257,11 +282,18 @@ public:
      */
     TimingEventType* RegisterEvent(const std::string& name, TimedCallback callback);
 
-    void ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type, u64 userdata = 0,
-                       std::size_t core_id = std::numeric_limits<std::size_t>::max());
+    EventHandle ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
+                              u64 userdata = 0,
+                              std::size_t core_id = std::numeric_limits<std::size_t>::max());
 
     void UnscheduleEvent(const TimingEventType* event_type, u64 userdata);
 
+    /**
+     * Unschedules the event referred to by the handle in constant time.
+     * @returns false if the handle is invalid or the event already fired or was unscheduled
+     */
+    bool UnscheduleEvent(const EventHandle& handle);
+
     /// We only permit one event of each type in the queue at a time.
     void RemoveEvent(const TimingEventType* event_type);
 
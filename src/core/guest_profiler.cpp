@@ -0,0 +1,180 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/guest_profiler.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/service/ldr_ro/ldr_ro.h"
+#include "core/hle/service/sm/sm.h"
+
+namespace Core {
+
+/// Module name used for the addresses outside of any known module
+constexpr u32 UNKNOWN_MODULE = 0;
+
+GuestProfiler::GuestProfiler(System& system_, u64 title_id, u32 interval)
+    : system(system_), title_id(title_id), interval(interval) {
+    InternModuleName("[unknown]");
+    Connect();
+}
+
+GuestProfiler::~GuestProfiler() {
+    if (!event) {
+        return;
+    }
+    system.CoreTiming().RemoveEvent(event);
+
+    const std::vector<Stack> sampled_stacks = GetStacks();
+    if (sampled_stacks.empty()) {
+        return;
+    }
+
+    const std::time_t t = std::time(nullptr);
+    const std::string& path = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+    // %F Date format expanded is "%Y-%m-%d"
+    const std::string filename = fmt::format("{}/{:%F-%H-%M}_{:016X}_guest_profile.folded", path,
+                                             *std::localtime(&t), title_id);
+    FileUtil::IOFile(filename, "w").WriteString(FormatCollapsed(sampled_stacks));
+    LOG_INFO(Core, "Saved the guest code profile to {}", filename);
+}
+
+void GuestProfiler::Connect() {
+    if (interval == 0) {
+        return;
+    }
+    auto& timing = system.CoreTiming();
+    event = timing.RegisterEvent("GuestProfiler::sample", [this](u64 core_id, s64 cycles_late) {
+        SampleCallback(core_id, cycles_late);
+    });
+    // A loaded savestate may already have the event scheduled, with a different interval
+    timing.RemoveEvent(event);
+    for (u32 core_id = 0; core_id < system.GetNumCores(); ++core_id) {
+        timing.ScheduleEvent(interval, event, core_id, core_id);
+    }
+    InvalidateModules();
+}
+
+void GuestProfiler::InvalidateModules() {
+    modules_dirty.store(true, std::memory_order_relaxed);
+}
+
+void GuestProfiler::SetModules(std::vector<Module> new_modules) {
+    std::sort(new_modules.begin(), new_modules.end(),
+              [](const Module& a, const Module& b) { return a.address < b.address; });
+
+    std::lock_guard lock{mutex};
+    modules.clear();
+    modules.reserve(new_modules.size());
+    for (Module& module : new_modules) {
+        const u32 name_index = InternModuleName(module.name);
+        modules.emplace_back(std::move(module), name_index);
+    }
+}
+
+void GuestProfiler::AddSample(u32 pc, u32 lr) {
+    std::lock_guard lock{mutex};
+    // Clear the Thumb bit of return addresses
+    const auto [caller_module, caller_offset] = Resolve(lr & ~1u);
+    const auto [callee_module, callee_offset] = Resolve(pc);
+    ++stacks[{caller_module, caller_offset, callee_module, callee_offset}];
+}
+
+std::vector<GuestProfiler::Stack> GuestProfiler::GetStacks() const {
+    std::vector<Stack> sampled_stacks;
+    {
+        std::lock_guard lock{mutex};
+        sampled_stacks.reserve(stacks.size());
+        for (const auto& [key, count] : stacks) {
+            const auto [caller_module, caller_offset, callee_module, callee_offset] = key;
+            sampled_stacks.push_back({{module_names[caller_module], caller_offset},
+                                      {module_names[callee_module], callee_offset},
+                                      count});
+        }
+    }
+    std::stable_sort(sampled_stacks.begin(), sampled_stacks.end(),
+                     [](const Stack& a, const Stack& b) { return a.count > b.count; });
+    return sampled_stacks;
+}
+
+void GuestProfiler::Reset() {
+    std::lock_guard lock{mutex};
+    stacks.clear();
+}
+
+std::string GuestProfiler::FormatCollapsed(const std::vector<Stack>& stacks) {
+    std::string collapsed;
+    for (const Stack& stack : stacks) {
+        collapsed += fmt::format("{}+0x{:x};{}+0x{:x} {}\n", stack.caller.module,
+                                 stack.caller.offset, stack.callee.module, stack.callee.offset,
+                                 stack.count);
+    }
+    return collapsed;
+}
+
+void GuestProfiler::SampleCallback(u64 core_id, s64 cycles_late) {
+    if (modules_dirty.exchange(false, std::memory_order_relaxed)) {
+        RefreshModules();
+    }
+
+    const ARM_Interface& core = system.GetCore(static_cast<u32>(core_id));
+    AddSample(core.GetPC(), core.GetReg(14));
+
+    system.CoreTiming().ScheduleEvent(interval - cycles_late, event, core_id, core_id);
+}
+
+void GuestProfiler::RefreshModules() {
+    std::vector<Module> new_modules;
+    const auto process = system.Kernel().GetCurrentProcess();
+    if (process && process->codeset) {
+        const auto& code = process->codeset->CodeSegment();
+        new_modules.push_back({process->codeset->name, code.addr, code.size});
+
+        const auto ro = system.ServiceManager().GetService<Service::LDR::RO>("ldr:ro");
+        if (ro) {
+            for (auto& cro : ro->GetLoadedModules(*process)) {
+                new_modules.push_back({std::move(cro.name), cro.code_address, cro.code_size});
+            }
+        }
+    }
+    SetModules(std::move(new_modules));
+}
+
+u32 GuestProfiler::InternModuleName(const std::string& name) {
+    std::string frame_name = name.empty() ? "[unnamed]" : name;
+    // Semicolons and spaces delimit the frames and the count of collapsed stacks
+    std::replace(frame_name.begin(), frame_name.end(), ';', '_');
+    std::replace(frame_name.begin(), frame_name.end(), ' ', '_');
+
+    const auto [it, inserted] =
+        module_name_indices.try_emplace(frame_name, static_cast<u32>(module_names.size()));
+    if (inserted) {
+        module_names.push_back(std::move(frame_name));
+    }
+    return it->second;
+}
+
+std::pair<u32, u32> GuestProfiler::Resolve(VAddr address) const {
+    const auto it = std::upper_bound(modules.begin(), modules.end(), address,
+                                     [](VAddr value, const std::pair<Module, u32>& module) {
+                                         return value < module.first.address;
+                                     });
+    if (it != modules.begin()) {
+        const auto& [module, name_index] = *std::prev(it);
+        if (address - module.address < module.size) {
+            return {name_index, address - module.address};
+        }
+    }
+    return {UNKNOWN_MODULE, address};
+}
+
+} // namespace Core
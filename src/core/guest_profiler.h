@@ -0,0 +1,110 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+class System;
+struct TimingEventType;
+
+/**
+ * Sampling profiler for the emulated code. Every interval emulated cycles, the PC and LR of each
+ * CPU core are sampled by a Core::Timing event, and attributed to the code of the current process
+ * or to one of the CROs loaded through ldr:ro. The samples are written to the log directory as
+ * collapsed stacks, as read by flamegraph.pl and speedscope, when the profiler is destroyed, which
+ * happens when emulation stops. LR only holds the return address until it is spilled, so the
+ * stacks are two frames deep and their caller frame is only reliable for leaf functions.
+ */
+class GuestProfiler {
+public:
+    /// The code of a module, loaded at [address, address + size)
+    struct Module {
+        std::string name;
+        VAddr address;
+        u32 size;
+    };
+
+    /// A code location, as an offset in a module
+    struct Frame {
+        std::string module;
+        u32 offset;
+    };
+
+    /// The number of samples taken at a location
+    struct Stack {
+        Frame caller;
+        Frame callee;
+        u64 count;
+    };
+
+    /**
+     * @param interval Emulated cycles between samples, profiling is disabled if it is 0
+     */
+    GuestProfiler(System& system, u64 title_id, u32 interval);
+    ~GuestProfiler();
+
+    /// Registers and schedules the sampling event. Called again after loading a savestate.
+    void Connect();
+
+    /// Marks the loaded modules out of date, to be read again before attributing the next sample
+    void InvalidateModules();
+
+    /// Replaces the loaded modules samples are attributed to
+    void SetModules(std::vector<Module> new_modules);
+
+    /// Records a sample of the emulated code
+    void AddSample(u32 pc, u32 lr);
+
+    /// Returns all the stacks sampled so far, sorted by sample count
+    std::vector<Stack> GetStacks() const;
+
+    /// Discards all the recorded samples
+    void Reset();
+
+    /// Formats stacks as collapsed stacks, one "caller;callee count" line per stack
+    static std::string FormatCollapsed(const std::vector<Stack>& stacks);
+
+private:
+    /// Indices of the modules and offsets of a caller and callee frame
+    using StackKey = std::tuple<u32, u32, u32, u32>;
+
+    void SampleCallback(u64 core_id, s64 cycles_late);
+
+    /// Reads the modules loaded in the current process
+    void RefreshModules();
+
+    /// Returns the index of the name of a module, adding it if needed
+    u32 InternModuleName(const std::string& name);
+
+    /// Returns the index of the module name and the offset in the module of an address
+    std::pair<u32, u32> Resolve(VAddr address) const;
+
+    System& system;
+    u64 title_id;
+    u32 interval;
+    TimingEventType* event = nullptr;
+
+    std::atomic<bool> modules_dirty{true};
+
+    mutable std::mutex mutex;
+    /// Loaded modules, sorted by address
+    std::vector<std::pair<Module, u32>> modules;
+    /// Names of all the modules seen so far, never removed as the stacks refer to them
+    std::vector<std::string> module_names;
+    std::unordered_map<std::string, u32> module_name_indices;
+    std::map<StackKey, u64> stacks;
+};
+
+} // namespace Core
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <mutex>
 #include <vector>
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -16,6 +17,54 @@
 
 namespace Kernel {
 
+/**
+ * Recycles the static buffers of finished requests, so that translating a request doesn't have to
+ * allocate them again.
+ */
+class StaticBufferPool {
+public:
+    /// Gets a zero-filled buffer of the given size, reusing a pooled one if possible
+    std::vector<u8> Acquire(std::size_t size) {
+        std::vector<u8> buffer;
+        {
+            std::lock_guard lock{mutex};
+            const auto it = std::find_if(free_buffers.rbegin(), free_buffers.rend(),
+                                         [size](const auto& b) { return b.capacity() >= size; });
+            if (it != free_buffers.rend()) {
+                buffer = std::move(*it);
+                free_buffers.erase(std::next(it).base());
+            }
+        }
+        buffer.resize(size);
+        return buffer;
+    }
+
+    /// Returns a buffer to the pool, unless it holds no memory or too much
+    void Release(std::vector<u8>&& buffer) {
+        if (buffer.capacity() == 0 || buffer.capacity() > MaxPooledCapacity) {
+            return;
+        }
+        buffer.clear();
+        std::lock_guard lock{mutex};
+        if (free_buffers.size() < MaxPooledBuffers) {
+            free_buffers.push_back(std::move(buffer));
+        }
+    }
+
+    static StaticBufferPool& Get() {
+        // Never destroyed, as requests may still be destroyed while shutting down
+        static auto* pool = new StaticBufferPool;
+        return *pool;
+    }
+
+private:
+    static constexpr std::size_t MaxPooledBuffers = 2 * IPC::MAX_STATIC_BUFFERS;
+    static constexpr std::size_t MaxPooledCapacity = 0x10000;
+
+    std::mutex mutex;
+    std::vector<std::vector<u8>> free_buffers;
+};
+
 class HLERequestContext::ThreadCallback : public Kernel::WakeupCallback {
 
 public:
@@ -101,7 +150,11 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
     cmd_buf[0] = 0;
 }
 
-HLERequestContext::~HLERequestContext() = default;
+HLERequestContext::~HLERequestContext() {
+    for (auto& buffer : static_buffers) {
+        StaticBufferPool::Get().Release(std::move(buffer));
+    }
+}
 
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
@@ -122,6 +175,7 @@ const std::vector<u8>& HLERequestContext::GetStaticBuffer(u8 buffer_id) const {
 }
 
 void HLERequestContext::AddStaticBuffer(u8 buffer_id, std::vector<u8> data) {
+    StaticBufferPool::Get().Release(std::move(static_buffers[buffer_id]));
     static_buffers[buffer_id] = std::move(data);
 }
 
@@ -176,8 +230,8 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into a pooled vector and store it.
+            std::vector<u8> data = StaticBufferPool::Get().Acquire(buffer_info.size);
             kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
 
             AddStaticBuffer(buffer_info.buffer_id, std::move(data));
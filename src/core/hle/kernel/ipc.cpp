@@ -100,13 +100,11 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
         case IPC::DescriptorType::StaticBuffer: {
             IPC::StaticBufferDescInfo bufferInfo{descriptor};
             VAddr static_buffer_src_address = cmd_buf[i];
-
-            std::vector<u8> data(bufferInfo.size);
-            memory.ReadBlock(*src_process, static_buffer_src_address, data.data(), data.size());
+            const u32 size = bufferInfo.size;
 
             // Grab the address that the target thread set up to receive the response static buffer
-            // and write our data there. The static buffers area is located right after the command
-            // buffer area.
+            // and copy our data there directly. The static buffers area is located right after the
+            // command buffer area.
             struct StaticBuffer {
                 IPC::StaticBufferDescInfo descriptor;
                 VAddr address;
@@ -123,10 +121,10 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
 
             // Note: The real kernel doesn't seem to have any error recovery mechanisms for this
             // case.
-            ASSERT_MSG(target_buffer.descriptor.size >= data.size(),
-                       "Static buffer data is too big");
+            ASSERT_MSG(target_buffer.descriptor.size >= size, "Static buffer data is too big");
 
-            memory.WriteBlock(*dst_process, target_buffer.address, data.data(), data.size());
+            memory.CopyBlock(*dst_process, *src_process, target_buffer.address,
+                             static_buffer_src_address, size);
 
             cmd_buf[i++] = target_buffer.address;
             break;
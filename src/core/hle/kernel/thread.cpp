@@ -151,6 +151,8 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
         }
 
         cpu->LoadContext(new_thread->context);
+        // The new thread must not complete an exclusive store started by the previous one
+        cpu->ClearExclusiveState();
         cpu->SetCP15Register(CP15_THREAD_URO, new_thread->GetTLSAddress());
     } else {
         current_thread = nullptr;
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <vector>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/archives.h"
@@ -214,7 +216,10 @@ bool Module::LoadLegacySharedFont() {
     FileUtil::CreateFullPath(filepath); // Create path if not already created
     FileUtil::IOFile file(filepath, "rb");
     if (file.IsOpen()) {
-        file.ReadBytes(shared_font_mem->GetPointer(), file.GetSize());
+        // The host can't read files straight into memory whose writes are tracked
+        std::vector<u8> font(file.GetSize());
+        file.ReadBytes(font.data(), font.size());
+        std::memcpy(shared_font_mem->GetPointer(), font.data(), font.size());
         return true;
     }
 
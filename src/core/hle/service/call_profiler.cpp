@@ -0,0 +1,237 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/hle/ipc.h"
+#include "core/hle/service/call_profiler.h"
+#include "core/settings.h"
+
+namespace Service {
+
+std::atomic<bool> CallProfiler::enabled{false};
+
+void CallProfiler::LatencyHistogram::Add(u64 ns) {
+    ++buckets[GetBucket(ns)];
+}
+
+u64 CallProfiler::LatencyHistogram::GetPercentile(double percentile, u64 count) const {
+    const u64 target = std::max<u64>(1, static_cast<u64>(std::ceil(percentile * count)));
+    u64 seen = 0;
+    for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= target) {
+            return GetBucketMiddle(bucket);
+        }
+    }
+    return 0;
+}
+
+std::size_t CallProfiler::LatencyHistogram::GetBucket(u64 ns) {
+    if (ns < 16) {
+        return static_cast<std::size_t>(ns);
+    }
+    unsigned exponent = 4;
+    while ((ns >> (exponent + 1)) != 0) {
+        ++exponent;
+    }
+    const u64 sub_bucket = (ns >> (exponent - 3)) & 7;
+    return 16 + (exponent - 4) * 8 + static_cast<std::size_t>(sub_bucket);
+}
+
+u64 CallProfiler::LatencyHistogram::GetBucketMiddle(std::size_t bucket) {
+    if (bucket < 16) {
+        return bucket;
+    }
+    const std::size_t exponent = (bucket - 16) / 8 + 4;
+    const u64 sub_bucket = (bucket - 16) % 8;
+    const u64 width = u64{1} << (exponent - 3);
+    return (8 + sub_bucket) * width + width / 2;
+}
+
+CallProfiler::CallProfiler(u64 title_id) : title_id(title_id) {}
+
+CallProfiler::~CallProfiler() {
+    if (!Settings::values.profile_hle_services) {
+        return;
+    }
+    const std::vector<Stats> stats = GetStats();
+    if (stats.empty()) {
+        return;
+    }
+
+    const std::time_t t = std::time(nullptr);
+    const std::string& path = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+    // %F Date format expanded is "%Y-%m-%d"
+    const std::string filename =
+        fmt::format("{}/{:%F-%H-%M}_{:016X}_hle_calls", path, *std::localtime(&t), title_id);
+    FileUtil::IOFile(filename + ".csv", "w").WriteString(FormatCSV(stats));
+    FileUtil::IOFile(filename + ".json", "w").WriteString(FormatJSON(stats));
+    LOG_INFO(Service, "Saved the HLE call profile to {}.csv/.json", filename);
+}
+
+u64 CallProfiler::GetPayloadSize(const u32* cmd_buf, bool count_mapped_buffers) {
+    const IPC::Header header{cmd_buf[0]};
+    const std::size_t untranslated_size = 1u + header.normal_params_size;
+    const std::size_t command_size = untranslated_size + header.translate_params_size;
+    if (command_size > IPC::COMMAND_BUFFER_LENGTH) {
+        return 0;
+    }
+
+    u64 bytes = command_size * sizeof(u32);
+    std::size_t i = untranslated_size;
+    while (i < command_size) {
+        const u32 descriptor = cmd_buf[i++];
+        switch (IPC::GetDescriptorType(descriptor)) {
+        case IPC::DescriptorType::CopyHandle:
+        case IPC::DescriptorType::MoveHandle:
+            i += IPC::HandleNumberFromDesc(descriptor);
+            break;
+        case IPC::DescriptorType::CallingPid:
+            i += 1;
+            break;
+        case IPC::DescriptorType::StaticBuffer:
+            bytes += IPC::StaticBufferDescInfo{descriptor}.size;
+            i += 1;
+            break;
+        case IPC::DescriptorType::MappedBuffer:
+            if (count_mapped_buffers) {
+                bytes += IPC::MappedBufferDescInfo{descriptor}.size;
+            }
+            i += 1;
+            break;
+        default:
+            return bytes;
+        }
+    }
+    return bytes;
+}
+
+CallProfiler::Call CallProfiler::BeginCall(const void* service, const std::string& service_name,
+                                           const char* function_name, const u32* cmd_buf) {
+    const u32 header = cmd_buf[0];
+    // Mapped buffers are only counted in requests, as replies describe them again to unmap them
+    const u64 bytes = GetPayloadSize(cmd_buf, true);
+
+    std::unique_lock lock{mutex};
+    auto [it, inserted] = records.try_emplace({service, header});
+    Record& record = it->second;
+    if (inserted) {
+        record.service = service_name;
+        record.function = function_name;
+        record.header = header;
+#if MICROPROFILE_ENABLED
+        const std::string scope_name = fmt::format("{}::{}", service_name, function_name);
+        record.microprofile_token = MicroProfileGetToken("HLE", scope_name.c_str(),
+                                                         MP_RGB(200, 120, 40),
+                                                         MicroProfileTokenTypeCpu);
+#endif
+    }
+    record.bytes += bytes;
+    lock.unlock();
+
+    Call call{&record, {}, 0};
+#if MICROPROFILE_ENABLED
+    call.microprofile_tick = MicroProfileEnter(record.microprofile_token);
+#endif
+    call.start = Clock::now();
+    return call;
+}
+
+void CallProfiler::EndCall(const Call& call, const u32* cmd_buf) {
+    const auto end = Clock::now();
+#if MICROPROFILE_ENABLED
+    MicroProfileLeave(call.record->microprofile_token, call.microprofile_tick);
+#endif
+    const u64 ns = static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - call.start).count());
+    const u64 bytes = GetPayloadSize(cmd_buf, false);
+
+    std::lock_guard lock{mutex};
+    Record& record = *call.record;
+    ++record.calls;
+    record.total_ns += ns;
+    record.max_ns = std::max(record.max_ns, ns);
+    record.bytes += bytes;
+    record.histogram.Add(ns);
+}
+
+std::vector<CallProfiler::Stats> CallProfiler::GetStats() const {
+    std::vector<Stats> stats;
+    {
+        std::lock_guard lock{mutex};
+        stats.reserve(records.size());
+        for (const auto& [key, record] : records) {
+            if (record.calls == 0) {
+                continue;
+            }
+            stats.push_back({record.service, record.function, record.header, record.calls,
+                             record.total_ns, record.histogram.GetPercentile(0.5, record.calls),
+                             record.histogram.GetPercentile(0.99, record.calls), record.max_ns,
+                             record.bytes});
+        }
+    }
+    std::sort(stats.begin(), stats.end(),
+              [](const Stats& a, const Stats& b) { return a.total_ns > b.total_ns; });
+    return stats;
+}
+
+void CallProfiler::Reset() {
+    std::lock_guard lock{mutex};
+    // Keep the records, as calls in progress point to them
+    for (auto& [key, record] : records) {
+        record.calls = 0;
+        record.total_ns = 0;
+        record.max_ns = 0;
+        record.bytes = 0;
+        record.histogram = {};
+    }
+}
+
+std::string CallProfiler::FormatCSV(const std::vector<Stats>& stats) {
+    std::string csv = "service,function,header,calls,total_ns,mean_ns,p50_ns,p99_ns,max_ns,bytes\n";
+    for (const Stats& s : stats) {
+        csv += fmt::format("{},{},0x{:08X},{},{},{},{},{},{},{}\n", s.service, s.function, s.header,
+                           s.calls, s.total_ns, s.total_ns / s.calls, s.p50_ns, s.p99_ns, s.max_ns,
+                           s.bytes);
+    }
+    return csv;
+}
+
+static std::string EscapeJSON(const std::string& str) {
+    std::string escaped;
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string CallProfiler::FormatJSON(const std::vector<Stats>& stats) {
+    std::string json = "[\n";
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        const Stats& s = stats[i];
+        json += fmt::format(
+            "  {{\"service\": \"{}\", \"function\": \"{}\", \"header\": {}, \"calls\": {}, "
+            "\"total_ns\": {}, \"p50_ns\": {}, \"p99_ns\": {}, \"max_ns\": {}, \"bytes\": {}}}{}\n",
+            EscapeJSON(s.service), EscapeJSON(s.function), s.header, s.calls, s.total_ns,
+            s.p50_ns, s.p99_ns, s.max_ns, s.bytes, i + 1 == stats.size() ? "" : ",");
+    }
+    json += "]\n";
+    return json;
+}
+
+} // namespace Service
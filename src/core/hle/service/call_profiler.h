@@ -0,0 +1,131 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Service {
+
+/**
+ * Records statistics about the calls to HLE service functions: call counts, host latency and bytes
+ * moved, per service and command header. Profiling is toggled globally with SetEnabled, and costs
+ * a single relaxed atomic load per call while disabled. Each profiled call is also shown as a
+ * MicroProfile scope in the "HLE" group. The statistics recorded while the profile_hle_services
+ * setting is set are written as CSV and JSON to the log directory when the profiler is destroyed,
+ * which happens when emulation stops.
+ */
+class CallProfiler {
+    struct Record;
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Statistics of the calls to a service function
+    struct Stats {
+        std::string service;
+        std::string function;
+        u32 header;
+        u64 calls;
+        u64 total_ns;
+        u64 p50_ns;
+        u64 p99_ns;
+        u64 max_ns;
+        /// Bytes of the command buffers, static buffers and mapped buffers of the calls
+        u64 bytes;
+    };
+
+    /// A call in progress, returned by BeginCall and passed back to EndCall
+    struct Call {
+        Record* record;
+        Clock::time_point start;
+        u64 microprofile_tick;
+    };
+
+    explicit CallProfiler(u64 title_id);
+    ~CallProfiler();
+
+    static bool IsEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void SetEnabled(bool enable) {
+        enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts timing a call to a service function.
+     * @param service Identifies the service, only the service name is kept
+     * @param cmd_buf Command buffer of the request, translated for the service
+     */
+    Call BeginCall(const void* service, const std::string& service_name,
+                   const char* function_name, const u32* cmd_buf);
+
+    /**
+     * Finishes timing a call to a service function.
+     * @param cmd_buf Command buffer of the reply, to be translated for the client
+     */
+    void EndCall(const Call& call, const u32* cmd_buf);
+
+    /// Returns the statistics of all the functions called so far, sorted by total latency
+    std::vector<Stats> GetStats() const;
+
+    /// Discards all the recorded statistics
+    void Reset();
+
+    /// Formats statistics as CSV, with a header row
+    static std::string FormatCSV(const std::vector<Stats>& stats);
+
+    /// Formats statistics as a JSON array of objects
+    static std::string FormatJSON(const std::vector<Stats>& stats);
+
+private:
+    /**
+     * Histogram of latencies in nanoseconds. Latencies below 16ns have a bucket each, larger ones
+     * are split in 8 buckets per power of two, so percentiles are within 12.5% of the true value.
+     */
+    class LatencyHistogram {
+    public:
+        void Add(u64 ns);
+        u64 GetPercentile(double percentile, u64 count) const;
+
+    private:
+        static std::size_t GetBucket(u64 ns);
+        static u64 GetBucketMiddle(std::size_t bucket);
+
+        std::array<u64, 16 + 60 * 8> buckets{};
+    };
+
+    struct Record {
+        std::string service;
+        std::string function;
+        u32 header = 0;
+        u64 calls = 0;
+        u64 total_ns = 0;
+        u64 max_ns = 0;
+        u64 bytes = 0;
+        LatencyHistogram histogram;
+        u64 microprofile_token = 0;
+    };
+
+    /// Returns the number of bytes a command buffer and the buffers it describes amount to
+    static u64 GetPayloadSize(const u32* cmd_buf, bool count_mapped_buffers);
+
+    static std::atomic<bool> enabled;
+
+    u64 title_id;
+
+    mutable std::mutex mutex;
+    std::map<std::pair<const void*, u32>, Record> records;
+};
+
+} // namespace Service
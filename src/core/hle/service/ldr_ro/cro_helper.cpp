@@ -1471,6 +1471,19 @@ void CROHelper::Unregister(VAddr crs_address) {
     SetPreviousModule(0);
 }
 
+std::vector<VAddr> CROHelper::GetRegisteredModules() const {
+    std::vector<VAddr> modules;
+    // the next and the previous of the static module are the heads of the auto-link and the
+    // non-auto-link module lists
+    for (VAddr current : {NextModule(), PreviousModule()}) {
+        while (current != 0) {
+            modules.push_back(current);
+            current = CROHelper(current, process, system).NextModule();
+        }
+    }
+    return modules;
+}
+
 u32 CROHelper::GetFixEnd(u32 fix_level) const {
     u32 end = CRO_HEADER_SIZE;
     end = std::max<u32>(end, GetField(CodeOffset) + GetField(CodeSize));
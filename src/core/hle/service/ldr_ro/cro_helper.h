@@ -6,6 +6,7 @@
 
 #include <array>
 #include <tuple>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/result.h"
@@ -140,6 +141,12 @@ public:
      */
     std::tuple<VAddr, u32> GetExecutablePages() const;
 
+    /**
+     * Gets the addresses of the modules registered to this static module, auto-link modules first.
+     * @returns the addresses of the registered modules, in registration order within each list.
+     */
+    std::vector<VAddr> GetRegisteredModules() const;
+
 private:
     const VAddr module_address; ///< the virtual address of this module
     Kernel::Process& process;   ///< the owner process of this module
@@ -8,6 +8,7 @@
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/guest_profiler.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/ldr_ro/cro_helper.h"
@@ -138,6 +139,7 @@ void RO::Initialize(Kernel::HLERequestContext& ctx) {
     }
 
     slot->loaded_crs = crs_address;
+    slot->process_id = process->process_id;
 
     rb.Push(RESULT_SUCCESS);
 }
@@ -325,6 +327,7 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
         }
     }
 
+    system.GuestProfiler().InvalidateModules();
     system.InvalidateCacheRange(cro_address, cro_size);
 
     LOG_INFO(Service_LDR, "CRO \"{}\" loaded at 0x{:08X}, fixed_end=0x{:08X}", cro.ModuleName(),
@@ -398,6 +401,7 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
         LOG_ERROR(Service_LDR, "Error unmapping CRO {:08X}", result.raw);
     }
 
+    system.GuestProfiler().InvalidateModules();
     system.InvalidateCacheRange(cro_address, fixed_size);
 
     rb.Push(result);
@@ -510,10 +514,32 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
         LOG_ERROR(Service_LDR, "Error unmapping CRS {:08X}", result.raw);
     }
 
+    system.GuestProfiler().InvalidateModules();
     slot->loaded_crs = 0;
+    slot->process_id = 0;
     rb.Push(result);
 }
 
+std::vector<RO::LoadedModule> RO::GetLoadedModules(Kernel::Process& process) const {
+    std::vector<LoadedModule> modules;
+    for (const auto& session : connected_sessions) {
+        const auto* slot = static_cast<const ClientSlot*>(session.data.get());
+        // Other processes' modules live at addresses that mean nothing in this one
+        if (slot->loaded_crs == 0 || slot->process_id != process.process_id) {
+            continue;
+        }
+        const CROHelper crs(slot->loaded_crs, process, system);
+        for (VAddr cro_address : crs.GetRegisteredModules()) {
+            const CROHelper cro(cro_address, process, system);
+            const auto [code_address, code_size] = cro.GetExecutablePages();
+            if (code_size != 0) {
+                modules.push_back({cro.ModuleName(), code_address, code_size});
+            }
+        }
+    }
+    return modules;
+}
+
 RO::RO(Core::System& system) : ServiceFramework("ldr:ro", 2), system(system) {
     static const FunctionInfo functions[] = {
         {0x000100C2, &RO::Initialize, "Initialize"},
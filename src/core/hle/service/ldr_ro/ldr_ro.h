@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
 #include "core/hle/service/service.h"
 
 namespace Core {
@@ -14,13 +16,17 @@ namespace Service::LDR {
 
 struct ClientSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     VAddr loaded_crs = 0; ///< the virtual address of the static module
+    u32 process_id = 0;   ///< the id of the process the static module is loaded in
 
 private:
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
+    void serialize(Archive& ar, const unsigned int file_version) {
         ar& boost::serialization::base_object<Kernel::SessionRequestHandler::SessionDataBase>(
             *this);
         ar& loaded_crs;
+        if (file_version > 0) {
+            ar& process_id;
+        }
     }
     friend class boost::serialization::access;
 };
@@ -29,6 +35,20 @@ class RO final : public ServiceFramework<RO, ClientSlot> {
 public:
     explicit RO(Core::System& system);
 
+    /// The code pages of a loaded CRO
+    struct LoadedModule {
+        std::string name;
+        VAddr code_address;
+        u32 code_size;
+    };
+
+    /**
+     * Lists the CROs loaded by the clients of the service in a process, walking the module lists
+     * of their CRS.
+     * @param process the process to list the CROs of
+     */
+    std::vector<LoadedModule> GetLoadedModules(Kernel::Process& process) const;
+
 private:
     /**
      * RO::Initialize service function
@@ -176,3 +196,4 @@ void InstallInterfaces(Core::System& system);
 SERVICE_CONSTRUCT(Service::LDR::RO)
 BOOST_CLASS_EXPORT_KEY(Service::LDR::RO)
 BOOST_CLASS_EXPORT_KEY(Service::LDR::ClientSlot)
+BOOST_CLASS_VERSION(Service::LDR::ClientSlot, 1)
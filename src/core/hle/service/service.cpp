@@ -13,6 +13,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/call_profiler.h"
 #include "core/hle/service/ac/ac.h"
 #include "core/hle/service/act/act.h"
 #include "core/hle/service/am/am.h"
@@ -177,7 +178,16 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+    if (!CallProfiler::IsEnabled()) {
+        handler_invoker(this, info->handler_callback, context);
+        return;
+    }
+
+    auto& profiler = Core::System::GetInstance().CallProfiler();
+    const auto call =
+        profiler.BeginCall(this, GetServiceName(), info->name, context.CommandBuffer());
     handler_invoker(this, info->handler_callback, context);
+    profiler.EndCall(call, context.CommandBuffer());
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(u32 header) const {
@@ -2,14 +2,20 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <map>
+#include <stdexcept>
+#include <boost/container/static_vector.hpp>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
 #include "audio_core/dsp_interface.h"
 #include "common/archives.h"
 #include "common/assert.h"
+#include "common/atomic_ops.h"
 #include "common/common_types.h"
+#include "common/host_memory.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
@@ -51,6 +57,29 @@ public:
         return false;
     }
 
+    /// Marks a physical page as holding data that the rasterizer has modified but not flushed yet
+    void MarkDirty(PAddr addr, bool dirty) {
+        if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
+            vram_dirty[(addr - VRAM_PADDR) / PAGE_SIZE] = dirty;
+        } else if (addr >= FCRAM_PADDR && addr < FCRAM_N3DS_PADDR_END) {
+            fcram_dirty[(addr - FCRAM_PADDR) / PAGE_SIZE] = dirty;
+        }
+    }
+
+    /// Returns whether reading the page at the virtual address needs a rasterizer flush first
+    bool IsDirty(VAddr addr) const {
+        if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
+            return vram_dirty[(addr - VRAM_VADDR) / PAGE_SIZE];
+        }
+        if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
+            return fcram_dirty[(addr - LINEAR_HEAP_VADDR) / PAGE_SIZE];
+        }
+        if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
+            return fcram_dirty[(addr - NEW_LINEAR_HEAP_VADDR) / PAGE_SIZE];
+        }
+        return false;
+    }
+
 private:
     bool* At(VAddr addr) {
         if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
@@ -69,6 +98,10 @@ private:
     std::array<bool, LINEAR_HEAP_SIZE / PAGE_SIZE> linear_heap{};
     std::array<bool, NEW_LINEAR_HEAP_SIZE / PAGE_SIZE> new_linear_heap{};
 
+    // Not serialized, as the rasterizer cache is cleared when saving or loading a state
+    std::array<bool, VRAM_SIZE / PAGE_SIZE> vram_dirty{};
+    std::array<bool, FCRAM_N3DS_SIZE / PAGE_SIZE> fcram_dirty{};
+
     static_assert(sizeof(bool) == 1);
     friend class boost::serialization::access;
     template <typename Archive>
@@ -79,13 +112,17 @@ private:
     }
 };
 
+/// Regions covered by delta savestates, in the order their pages are numbered in
+constexpr std::array<Region, 3> DELTA_REGIONS{Region::VRAM, Region::FCRAM, Region::N3DS};
+constexpr std::size_t DELTA_NUM_PAGES =
+    (VRAM_SIZE + FCRAM_N3DS_SIZE + N3DS_EXTRA_RAM_SIZE) / PAGE_SIZE;
+
 class MemorySystem::Impl {
 public:
-    // Visual Studio would try to allocate these on compile time if they are std::array, which would
-    // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // Backed by shared memory, so that the fastmem arenas can alias them
+    Common::HostMemory fcram{Memory::FCRAM_N3DS_SIZE};
+    Common::HostMemory vram{Memory::VRAM_SIZE};
+    Common::HostMemory n3ds_extra_ram{Memory::N3DS_EXTRA_RAM_SIZE};
 
     std::shared_ptr<PageTable> current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
@@ -98,18 +135,23 @@ public:
     std::shared_ptr<BackingMem> n3ds_extra_ram_mem;
     std::shared_ptr<BackingMem> dsp_mem;
 
+    /// Set while saving a delta savestate
+    bool save_delta = false;
+    /// Memory whose RAM a delta savestate is loaded on top of, set while loading one
+    Impl* load_delta_base = nullptr;
+
     Impl();
 
     const u8* GetPtr(Region r) const {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram.GetPointer();
         case Region::DSP:
             return dsp->GetDspMemory().data();
         case Region::FCRAM:
-            return fcram.get();
+            return fcram.GetPointer();
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram.GetPointer();
         default:
             UNREACHABLE();
         }
@@ -118,18 +160,135 @@ public:
     u8* GetPtr(Region r) {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram.GetPointer();
         case Region::DSP:
             return dsp->GetDspMemory().data();
         case Region::FCRAM:
-            return fcram.get();
+            return fcram.GetPointer();
+        case Region::N3DS:
+            return n3ds_extra_ram.GetPointer();
+        default:
+            UNREACHABLE();
+        }
+    }
+
+#ifndef _WIN32
+    /// Fastmem arenas of the page tables the CPU JIT accesses directly
+    std::map<const PageTable*, std::unique_ptr<Common::FastmemArena>> fastmem_arenas;
+
+    /// Finds the aliasable host memory containing a page, and the offset of the page in it
+    std::pair<const Common::HostMemory*, std::size_t> FindHostMemory(const u8* page) const {
+        for (const Common::HostMemory* memory : {&fcram, &vram, &n3ds_extra_ram}) {
+            const u8* begin = memory->GetPointer();
+            if (memory->CanAlias() && page >= begin && page < begin + memory->GetSize()) {
+                const std::size_t offset = static_cast<std::size_t>(page - begin);
+                if (offset & PAGE_MASK) {
+                    break;
+                }
+                return {memory, offset};
+            }
+        }
+        return {nullptr, 0};
+    }
+
+    /// Mirrors a range of pages of the page table in its fastmem arena, if it has one
+    void UpdateFastmem(const PageTable& page_table, u32 base, u32 size) {
+        const auto it = fastmem_arenas.find(&page_table);
+        if (it == fastmem_arenas.end()) {
+            return;
+        }
+        Common::FastmemArena& arena = *it->second;
+        const auto& pointers = page_table.GetPointerArray();
+
+        const u32 end = base + size;
+        while (base != end) {
+            const auto [memory, offset] = FindHostMemory(pointers[base]);
+
+            // Map runs of pages contiguous in the same memory at once to save system calls
+            u32 run_end = base + 1;
+            while (run_end != end) {
+                const auto [next_memory, next_offset] = FindHostMemory(pointers[run_end]);
+                if (next_memory != memory ||
+                    (memory && next_offset != offset + (run_end - base) * PAGE_SIZE)) {
+                    break;
+                }
+                ++run_end;
+            }
+
+            const std::size_t arena_offset = std::size_t{base} * PAGE_SIZE;
+            const std::size_t length = std::size_t{run_end - base} * PAGE_SIZE;
+            if (memory) {
+                arena.Map(arena_offset, *memory, offset, length);
+            } else {
+                arena.Unmap(arena_offset, length);
+            }
+            base = run_end;
+        }
+    }
+    /// Queues a page of a registered page table, by index in page_table_list, for FlushFastmem
+    void QueueFastmemUpdate(std::size_t table, u32 page) {
+        if (!fastmem_arenas.empty()) {
+            fastmem_queue.emplace_back(table, page);
+        }
+    }
+
+    /// Mirrors the queued pages in the fastmem arenas, one range of consecutive pages at a time
+    void FlushFastmem() {
+        if (fastmem_queue.empty()) {
+            return;
+        }
+        std::sort(fastmem_queue.begin(), fastmem_queue.end());
+        auto it = fastmem_queue.begin();
+        const auto end = std::unique(fastmem_queue.begin(), fastmem_queue.end());
+        while (it != end) {
+            const auto [table, base] = *it;
+            auto run_end = it + 1;
+            u32 size = 1;
+            while (run_end != end && run_end->first == table && run_end->second == base + size) {
+                ++run_end;
+                ++size;
+            }
+            UpdateFastmem(*page_table_list[table], base, size);
+            it = run_end;
+        }
+        // Cleared rather than freed, so that queueing doesn't allocate once warmed up
+        fastmem_queue.clear();
+    }
+
+    /// Pages queued by QueueFastmemUpdate
+    std::vector<std::pair<std::size_t, u32>> fastmem_queue;
+#else
+    // Fastmem isn't supported on Windows
+    void UpdateFastmem(const PageTable& page_table, u32 base, u32 size) {}
+    void QueueFastmemUpdate(std::size_t table, u32 page) {}
+    void FlushFastmem() {}
+#endif
+
+    Common::HostMemory& GetHostMemory(Region r) {
+        switch (r) {
+        case Region::VRAM:
+            return vram;
+        case Region::FCRAM:
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
     }
 
+    /// Gets a page by its index in the regions covered by delta savestates
+    u8* GetDeltaPage(std::size_t page) {
+        for (const Region region : DELTA_REGIONS) {
+            const std::size_t region_pages = GetSize(region) / PAGE_SIZE;
+            if (page < region_pages) {
+                return GetPtr(region) + page * PAGE_SIZE;
+            }
+            page -= region_pages;
+        }
+        UNREACHABLE();
+    }
+
     u32 GetSize(Region r) const {
         switch (r) {
         case Region::VRAM:
@@ -151,11 +310,15 @@ private:
     void serialize(Archive& ar, const unsigned int file_version) {
         bool save_n3ds_ram = Settings::values.is_new_3ds;
         ar& save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        if (Archive::is_saving::value ? save_delta : load_delta_base != nullptr) {
+            SerializeWrittenPages(ar);
+        } else {
+            ar& boost::serialization::make_binary_object(vram.GetPointer(), Memory::VRAM_SIZE);
+            ar& boost::serialization::make_binary_object(
+                fcram.GetPointer(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
+            ar& boost::serialization::make_binary_object(
+                n3ds_extra_ram.GetPointer(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        }
         ar& cache_marker;
         ar& page_table_list;
         // dsp is set from Core::System at startup
@@ -164,6 +327,40 @@ private:
         ar& vram_mem;
         ar& n3ds_extra_ram_mem;
         ar& dsp_mem;
+#ifndef _WIN32
+        if (Archive::is_loading::value) {
+            // The page tables have been replaced, their arenas are rebuilt when the JIT asks again
+            fastmem_arenas.clear();
+        }
+#endif
+    }
+
+    /// Saves the pages written since the base was captured, or loads them on top of the base
+    template <class Archive>
+    void SerializeWrittenPages(Archive& ar) {
+        std::vector<u32> pages;
+        if (Archive::is_saving::value) {
+            u32 first_page = 0;
+            for (const Region region : DELTA_REGIONS) {
+                for (const std::size_t offset : GetHostMemory(region).GetWrittenPages()) {
+                    pages.push_back(first_page + static_cast<u32>(offset / PAGE_SIZE));
+                }
+                first_page += GetSize(region) / PAGE_SIZE;
+            }
+        } else {
+            for (const Region region : DELTA_REGIONS) {
+                GetHostMemory(region).TakeContents(load_delta_base->GetHostMemory(region));
+            }
+            load_delta_base = nullptr;
+        }
+
+        ar& pages;
+        for (const u32 page : pages) {
+            if (page >= DELTA_NUM_PAGES) {
+                throw std::runtime_error("Invalid page in delta savestate");
+            }
+            ar& boost::serialization::make_binary_object(GetDeltaPage(page), PAGE_SIZE);
+        }
     }
 };
 
@@ -210,6 +407,40 @@ void MemorySystem::serialize(Archive& ar, const unsigned int file_version) {
 
 SERIALIZE_IMPL(MemorySystem)
 
+void MemorySystem::CaptureDeltaBase() {
+    for (const Region region : DELTA_REGIONS) {
+        if (!impl->GetHostMemory(region).TrackWrites()) {
+            LOG_WARNING(HW_Memory, "Writes can't be tracked on this host, delta savestates will "
+                                   "store all of the memory");
+        }
+    }
+#ifndef _WIN32
+    // The fastmem arenas alias the RAM, so they are write-protected as well
+    for (const auto& [page_table, arena] : impl->fastmem_arenas) {
+        impl->UpdateFastmem(*page_table, 0, static_cast<u32>(PAGE_TABLE_NUM_ENTRIES));
+    }
+#endif
+}
+
+void MemorySystem::ReleaseDeltaBase() {
+    for (const Region region : DELTA_REGIONS) {
+        impl->GetHostMemory(region).StopTrackingWrites();
+    }
+#ifndef _WIN32
+    for (const auto& [page_table, arena] : impl->fastmem_arenas) {
+        impl->UpdateFastmem(*page_table, 0, static_cast<u32>(PAGE_TABLE_NUM_ENTRIES));
+    }
+#endif
+}
+
+void MemorySystem::SetSaveDelta(bool save_delta) {
+    impl->save_delta = save_delta;
+}
+
+void MemorySystem::SetLoadDeltaBase(MemorySystem* base) {
+    impl->load_delta_base = base ? base->impl.get() : nullptr;
+}
+
 void MemorySystem::SetCurrentPageTable(std::shared_ptr<PageTable> page_table) {
     impl->current_page_table = page_table;
 }
@@ -226,6 +457,7 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
     RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
+    const u32 start = base;
     u32 end = base + size;
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
@@ -243,6 +475,8 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
         if (memory != nullptr && memory.GetSize() > PAGE_SIZE)
             memory += PAGE_SIZE;
     }
+
+    impl->UpdateFastmem(page_table, start, size);
 }
 
 void MemorySystem::MapMemoryRegion(PageTable& page_table, VAddr base, u32 size, MemoryRef target) {
@@ -288,6 +522,27 @@ void MemorySystem::UnregisterPageTable(std::shared_ptr<PageTable> page_table) {
     if (it != impl->page_table_list.end()) {
         impl->page_table_list.erase(it);
     }
+#ifndef _WIN32
+    impl->fastmem_arenas.erase(page_table.get());
+#endif
+}
+
+u8* MemorySystem::GetFastmemBase(const PageTable& page_table) {
+#ifdef _WIN32
+    // Aliasing memory on Windows needs placeholder mappings, which the write-watched RAM can't use
+    return nullptr;
+#else
+    auto it = impl->fastmem_arenas.find(&page_table);
+    if (it == impl->fastmem_arenas.end()) {
+        auto arena = std::make_unique<Common::FastmemArena>(page_table.GetPointerArray().data());
+        if (!arena->IsValid() || !impl->fcram.CanAlias()) {
+            return nullptr;
+        }
+        it = impl->fastmem_arenas.emplace(&page_table, std::move(arena)).first;
+        impl->UpdateFastmem(page_table, 0, static_cast<u32>(PAGE_TABLE_NUM_ENTRIES));
+    }
+    return it->second->GetBase();
+#endif
 }
 
 /**
@@ -326,7 +581,10 @@ T MemorySystem::Read(const VAddr vaddr) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Flush);
+        // Pages the rasterizer has not modified can be read without flushing it
+        if (impl->cache_marker.IsDirty(vaddr)) {
+            RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Flush);
+        }
 
         T value;
         std::memcpy(&value, GetPointerForRasterizerCache(vaddr), sizeof(T));
@@ -373,6 +631,38 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
     }
 }
 
+template <typename T>
+bool MemorySystem::WriteExclusive(const VAddr vaddr, const T data, const T expected) {
+    u8* page_pointer = impl->current_page_table->pointers[vaddr >> PAGE_BITS];
+    if (page_pointer) {
+        const auto volatile_pointer =
+            reinterpret_cast<volatile T*>(&page_pointer[vaddr & PAGE_MASK]);
+        return Common::AtomicCompareAndSwap(volatile_pointer, data, expected);
+    }
+
+    PageType type = impl->current_page_table->attributes[vaddr >> PAGE_BITS];
+    switch (type) {
+    case PageType::Unmapped:
+        LOG_ERROR(HW_Memory, "unmapped Write{} 0x{:08X} @ 0x{:08X} at PC 0x{:08X}",
+                  sizeof(data) * 8, static_cast<u32>(data), vaddr, Core::GetRunningCore().GetPC());
+        return true;
+    case PageType::Memory:
+        ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
+        return true;
+    case PageType::RasterizerCachedMemory: {
+        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
+        const auto volatile_pointer =
+            reinterpret_cast<volatile T*>(GetPointerForRasterizerCache(vaddr).GetPtr());
+        return Common::AtomicCompareAndSwap(volatile_pointer, data, expected);
+    }
+    case PageType::Special:
+        WriteMMIO<T>(GetMMIOHandler(*impl->current_page_table, vaddr), vaddr, data);
+        return true;
+    default:
+        UNREACHABLE();
+    }
+}
+
 bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     auto& page_table = *process.vm_manager.page_table;
 
@@ -503,8 +793,11 @@ MemoryRef MemorySystem::GetPhysicalRef(PAddr address) const {
     return {target_mem, offset_into_region};
 }
 
+/// A rasterizer-accessible PAddr is mapped at most at two VAddr, one in each linear heap
+using RasterizerVAddrs = boost::container::static_vector<VAddr, 2>;
+
 /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
-static std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr) {
+static RasterizerVAddrs PhysicalToVirtualAddressForRasterizer(PAddr addr) {
     if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
         return {addr - VRAM_PADDR + VRAM_VADDR};
     }
@@ -535,7 +828,8 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     for (unsigned i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
         for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
             impl->cache_marker.Mark(vaddr, cached);
-            for (auto page_table : impl->page_table_list) {
+            for (std::size_t table = 0; table < impl->page_table_list.size(); ++table) {
+                PageTable* const page_table = impl->page_table_list[table].get();
                 PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
 
                 if (cached) {
@@ -548,6 +842,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                     case PageType::Memory:
                         page_type = PageType::RasterizerCachedMemory;
                         page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
+                        impl->QueueFastmemUpdate(table, vaddr >> PAGE_BITS);
                         break;
                     default:
                         UNREACHABLE();
@@ -563,6 +858,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         page_type = PageType::Memory;
                         page_table->pointers[vaddr >> PAGE_BITS] =
                             GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
+                        impl->QueueFastmemUpdate(table, vaddr >> PAGE_BITS);
                         break;
                     }
                     default:
@@ -572,6 +868,25 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
             }
         }
     }
+    // Pages whose type changed are mirrored in the fastmem arenas once all of them are known
+    impl->FlushFastmem();
+}
+
+void MemorySystem::RasterizerMarkRegionDirty(PAddr start, u32 size, bool dirty) {
+    if (size == 0) {
+        return;
+    }
+
+    const u64 end = u64{start} + size;
+    const auto MarkRange = [&](PAddr region_start, PAddr region_end) {
+        const u64 overlap_start = std::max<u64>(start, region_start);
+        const u64 overlap_end = std::min<u64>(end, region_end);
+        for (u64 paddr = overlap_start & ~PAGE_MASK; paddr < overlap_end; paddr += PAGE_SIZE) {
+            impl->cache_marker.MarkDirty(static_cast<PAddr>(paddr), dirty);
+        }
+    };
+    MarkRange(VRAM_PADDR, VRAM_PADDR_END);
+    MarkRange(FCRAM_PADDR, FCRAM_N3DS_PADDR_END);
 }
 
 void RasterizerFlushRegion(PAddr start, u32 size) {
@@ -700,8 +1015,10 @@ void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_add
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
+            if (impl->cache_marker.IsDirty(current_vaddr)) {
+                RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
+                                             FlushMode::Flush);
+            }
             std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
             break;
         }
@@ -732,6 +1049,22 @@ void MemorySystem::Write64(const VAddr addr, const u64 data) {
     Write<u64_le>(addr, data);
 }
 
+bool MemorySystem::WriteExclusive8(const VAddr addr, const u8 data, const u8 expected) {
+    return WriteExclusive<u8>(addr, data, expected);
+}
+
+bool MemorySystem::WriteExclusive16(const VAddr addr, const u16 data, const u16 expected) {
+    return WriteExclusive<u16_le>(addr, data, expected);
+}
+
+bool MemorySystem::WriteExclusive32(const VAddr addr, const u32 data, const u32 expected) {
+    return WriteExclusive<u32_le>(addr, data, expected);
+}
+
+bool MemorySystem::WriteExclusive64(const VAddr addr, const u64 data, const u64 expected) {
+    return WriteExclusive<u64_le>(addr, data, expected);
+}
+
 void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_addr,
                               const void* src_buffer, const std::size_t size) {
     auto& page_table = *process.vm_manager.page_table;
@@ -872,8 +1205,10 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
+            if (impl->cache_marker.IsDirty(current_vaddr)) {
+                RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
+                                             FlushMode::Flush);
+            }
             WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
                        copy_amount);
             break;
@@ -931,18 +1266,19 @@ void WriteMMIO<u64>(MMIORegionPointer mmio_handler, VAddr addr, const u64 data)
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) const {
-    ASSERT(pointer >= impl->fcram.get() && pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return static_cast<u32>(pointer - impl->fcram.get());
+    ASSERT(pointer >= impl->fcram.GetPointer() &&
+           pointer <= impl->fcram.GetPointer() + Memory::FCRAM_N3DS_SIZE);
+    return static_cast<u32>(pointer - impl->fcram.GetPointer());
 }
 
 u8* MemorySystem::GetFCRAMPointer(std::size_t offset) {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram.GetPointer() + offset;
 }
 
 const u8* MemorySystem::GetFCRAMPointer(std::size_t offset) const {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram.GetPointer() + offset;
 }
 
 MemoryRef MemorySystem::GetFCRAMRef(std::size_t offset) const {
@@ -129,6 +129,10 @@ struct PageTable {
         return pointers.raw;
     }
 
+    const std::array<u8*, PAGE_TABLE_NUM_ENTRIES>& GetPointerArray() const {
+        return pointers.raw;
+    }
+
     void Clear();
 
 private:
@@ -327,6 +331,16 @@ public:
     void Write32(VAddr addr, u32 data);
     void Write64(VAddr addr, u64 data);
 
+    /**
+     * Atomically writes data to addr if the memory there still holds expected, which is the value
+     * read by the matching exclusive load.
+     * @returns Whether the write happened
+     */
+    bool WriteExclusive8(VAddr addr, u8 data, u8 expected);
+    bool WriteExclusive16(VAddr addr, u16 data, u16 expected);
+    bool WriteExclusive32(VAddr addr, u32 data, u32 expected);
+    bool WriteExclusive64(VAddr addr, u64 data, u64 expected);
+
     void ReadBlock(const Kernel::Process& process, VAddr src_addr, void* dest_buffer,
                    std::size_t size);
     void WriteBlock(const Kernel::Process& process, VAddr dest_addr, const void* src_buffer,
@@ -369,14 +383,50 @@ public:
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Marks each page touching the region as holding data that the rasterizer has modified and not
+     * flushed yet. Only reads of such cached pages need to flush the rasterizer first, reads of
+     * the other cached pages access the memory directly.
+     */
+    void RasterizerMarkRegionDirty(PAddr start, u32 size, bool dirty);
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(std::shared_ptr<PageTable> page_table);
 
     /// Unregisters page table for rasterizer cache marking
     void UnregisterPageTable(std::shared_ptr<PageTable> page_table);
 
+    /**
+     * Gets the fastmem arena of a registered page table, creating it if needed. The arena mirrors
+     * the page table: the pages backed by FCRAM, VRAM or the N3DS extra RAM are mapped at
+     * base + address, while all other pages (unmapped, special, rasterizer-cached or backed by
+     * other memory) fault when accessed, so that such accesses can fall back to the page table.
+     * @returns the base of the arena, or nullptr if fastmem isn't supported on this host.
+     */
+    u8* GetFastmemBase(const PageTable& page_table);
+
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /**
+     * Starts tracking the pages of the emulated RAM written from now on, through any pointer to it.
+     * Delta savestates only store these pages, on top of the RAM as it is now. Where the host can't
+     * track writes, all pages count as written.
+     */
+    void CaptureDeltaBase();
+
+    /// Stops tracking the pages written since CaptureDeltaBase
+    void ReleaseDeltaBase();
+
+    /// While set, serializing the memory only saves the pages written since CaptureDeltaBase
+    void SetSaveDelta(bool save_delta);
+
+    /**
+     * Makes the next deserialization of the memory take over the RAM of base, along with the pages
+     * written to it, and only load the pages a delta savestate stores on top of it. The RAM of base
+     * must hold the savestate the delta savestate was saved on top of.
+     */
+    void SetLoadDeltaBase(MemorySystem* base);
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -384,6 +434,9 @@ private:
     template <typename T>
     void Write(const VAddr vaddr, const T data);
 
+    template <typename T>
+    bool WriteExclusive(const VAddr vaddr, const T data, const T expected);
+
     /**
      * Gets the pointer for virtual memory where the page is marked as RasterizerCachedMemory.
      * This is used to access the memory where the page pointer is nullptr due to rasterizer cache.
@@ -0,0 +1,73 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <utility>
+#include "common/assert.h"
+#include "core/multi_core_runner.h"
+
+namespace Core {
+
+/// Core executed by the calling thread while it is running a slice
+static thread_local std::optional<std::size_t> slice_core;
+
+MultiCoreRunner::MultiCoreRunner(std::size_t num_cores)
+    : start_barrier(num_cores), end_barrier(num_cores), pending_svcs(num_cores) {
+    ASSERT(num_cores > 0);
+    workers.reserve(num_cores - 1);
+    for (std::size_t core_id = 1; core_id < num_cores; ++core_id) {
+        workers.emplace_back([this, core_id] { WorkerLoop(core_id); });
+    }
+}
+
+MultiCoreRunner::~MultiCoreRunner() {
+    stop = true;
+    start_barrier.Sync();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void MultiCoreRunner::RunSlice(const std::function<void(std::size_t)>& run_core) {
+    slice_function = &run_core;
+    start_barrier.Sync();
+
+    slice_core = 0;
+    run_core(0);
+    slice_core.reset();
+
+    end_barrier.Sync();
+    slice_function = nullptr;
+}
+
+std::optional<std::size_t> MultiCoreRunner::DeferSVC(u32 immediate) {
+    if (!slice_core) {
+        return std::nullopt;
+    }
+    auto& pending_svc = pending_svcs[*slice_core];
+    ASSERT_MSG(!pending_svc, "Core {} made a second system call in the same slice", *slice_core);
+    pending_svc = immediate;
+    return slice_core;
+}
+
+std::optional<u32> MultiCoreRunner::TakePendingSVC(std::size_t core_id) {
+    return std::exchange(pending_svcs[core_id], std::nullopt);
+}
+
+void MultiCoreRunner::WorkerLoop(std::size_t core_id) {
+    const std::string name = "CPU Core " + std::to_string(core_id);
+    Common::SetCurrentThreadName(name.c_str());
+    slice_core = core_id;
+
+    while (true) {
+        start_barrier.Sync();
+        if (stop) {
+            return;
+        }
+        (*slice_function)(core_id);
+        end_barrier.Sync();
+    }
+}
+
+} // namespace Core
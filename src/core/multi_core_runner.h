@@ -0,0 +1,61 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread.h"
+
+namespace Core {
+
+/**
+ * Runs the slices of the emulated CPU cores on host threads of their own. Core 0 runs on the
+ * thread calling RunSlice and every other core on a dedicated worker thread, with barriers at the
+ * start and the end of each slice.
+ *
+ * The HLE kernel and services are not thread-safe, so system calls made during a slice are not
+ * executed right away. Instead the calling core stops and the system call is kept until the slice
+ * is over, when the CPU thread executes the pending system calls in core order.
+ */
+class MultiCoreRunner {
+public:
+    explicit MultiCoreRunner(std::size_t num_cores);
+    ~MultiCoreRunner();
+
+    MultiCoreRunner(const MultiCoreRunner&) = delete;
+    MultiCoreRunner& operator=(const MultiCoreRunner&) = delete;
+
+    /// Calls run_core(core_id) for every core on the thread of the core and returns once all of
+    /// the calls have returned
+    void RunSlice(const std::function<void(std::size_t core_id)>& run_core);
+
+    /**
+     * Records a system call made by the core running on the calling thread.
+     * @returns The id of the core, or std::nullopt if the calling thread is not running a slice, in
+     *          which case the system call has to be executed right away
+     */
+    std::optional<std::size_t> DeferSVC(u32 immediate);
+
+    /// Returns and forgets the system call made by the core during the last slice, if any
+    std::optional<u32> TakePendingSVC(std::size_t core_id);
+
+private:
+    void WorkerLoop(std::size_t core_id);
+
+    std::vector<std::thread> workers;
+    Common::Barrier start_barrier;
+    Common::Barrier end_barrier;
+
+    /// Only accessed by the CPU thread and by workers between the barriers of a slice
+    const std::function<void(std::size_t)>* slice_function = nullptr;
+    bool stop = false;
+    std::vector<std::optional<u32>> pending_svcs;
+};
+
+} // namespace Core
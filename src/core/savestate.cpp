@@ -2,12 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <vector>
 #include <boost/serialization/binary_object.hpp>
 #include <cryptopp/hex.h>
 #include "common/archives.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/scope_exit.h"
 #include "common/zstd_compression.h"
 #include "core/cheats/cheats.h"
 #include "core/core.h"
@@ -24,8 +31,11 @@ struct CSTHeader {
     u64_le program_id;           /// ID of the ROM being executed. Also called title_id
     std::array<u8, 20> revision; /// Git hash of the revision this savestate was created with
     u64_le time;                 /// The time when this save state was created
+    u64_le state_id;             /// Random ID of full save states, 0 for older save states
+    u64_le base_state_id;        /// ID of the full save state a delta save state is based on
+    u32_le base_slot;            /// Slot of the full save state a delta save state is based on
 
-    std::array<u8, 216> reserved; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 196> reserved; /// Make heading 256 bytes so it has consistent size
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -96,29 +106,130 @@ std::vector<SaveStateInfo> ListSaveStates(u64 program_id) {
     return result;
 }
 
-void System::SaveState(u32 slot) const {
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
+static u64 GenerateStateId() {
+    static std::mt19937_64 rng{std::random_device{}()};
+    u64 id;
+    do {
+        id = rng();
+    } while (id == 0);
+    return id;
+}
 
-    const std::string& str{sstream.str()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(
-        reinterpret_cast<const u8*>(str.data()), str.size());
+namespace {
 
-    const auto path = GetSaveStatePath(title_id, slot);
+/// Stream buffer passing the serialized save state to the compressor in chunks
+class CompressingStreamBuf : public std::streambuf {
+public:
+    explicit CompressingStreamBuf(Common::Compression::ZSTDStreamCompressor& compressor_)
+        : compressor(compressor_) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!FlushBuffer()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        if (size <= epptr() - pptr()) {
+            std::memcpy(pptr(), data, static_cast<std::size_t>(size));
+            pbump(static_cast<int>(size));
+            return size;
+        }
+        // Large objects such as the emulated RAM bypass the buffer
+        if (!FlushBuffer() ||
+            !compressor.Write(reinterpret_cast<const u8*>(data), static_cast<std::size_t>(size))) {
+            return 0;
+        }
+        return size;
+    }
+
+    int sync() override {
+        return FlushBuffer() ? 0 : -1;
+    }
+
+private:
+    bool FlushBuffer() {
+        const auto size = static_cast<std::size_t>(pptr() - pbase());
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return size == 0 || compressor.Write(reinterpret_cast<const u8*>(buffer.data()), size);
+    }
+
+    Common::Compression::ZSTDStreamCompressor& compressor;
+    std::array<char, 0x10000> buffer;
+};
+
+/// Stream buffer reading the serialized save state from the decompressor in chunks
+class DecompressingStreamBuf : public std::streambuf {
+public:
+    explicit DecompressingStreamBuf(Common::Compression::ZSTDStreamDecompressor& decompressor_)
+        : decompressor(decompressor_) {
+        setg(buffer.data(), buffer.data(), buffer.data());
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() == egptr()) {
+            const std::size_t size =
+                decompressor.Read(reinterpret_cast<u8*>(buffer.data()), buffer.size());
+            setg(buffer.data(), buffer.data(), buffer.data() + size);
+            if (size == 0) {
+                return traits_type::eof();
+            }
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize xsgetn(char* data, std::streamsize size) override {
+        const std::streamsize buffered = std::min(size, egptr() - gptr());
+        std::memcpy(data, gptr(), static_cast<std::size_t>(buffered));
+        gbump(static_cast<int>(buffered));
+        if (buffered == size) {
+            return size;
+        }
+        // Large objects such as the emulated RAM bypass the buffer
+        return buffered + static_cast<std::streamsize>(
+                              decompressor.Read(reinterpret_cast<u8*>(data + buffered),
+                                                static_cast<std::size_t>(size - buffered)));
+    }
+
+private:
+    Common::Compression::ZSTDStreamDecompressor& decompressor;
+    std::array<char, 0x10000> buffer;
+};
+
+} // Anonymous namespace
+
+/**
+ * Writes the header and the serialized system, compressing it on the fly. The save state is written
+ * to a temporary file first, which only replaces the file at path once it is complete.
+ */
+static void WriteSaveState(const std::string& path, CSTHeader header, const System& system) {
     if (!FileUtil::CreateFullPath(path)) {
         throw std::runtime_error("Could not create path " + path);
     }
 
-    FileUtil::IOFile file(path, "wb");
+    const std::string temp_path = path + ".tmp";
+    FileUtil::IOFile file(temp_path, "wb");
     if (!file) {
-        throw std::runtime_error("Could not open file " + path);
+        throw std::runtime_error("Could not open file " + temp_path);
     }
+    bool written = false;
+    SCOPE_EXIT({
+        if (!written) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+        }
+    });
 
-    CSTHeader header{};
     header.filetype = header_magic_bytes;
-    header.program_id = title_id;
     std::string rev_bytes;
     CryptoPP::StringSource(Common::g_scm_rev, true,
                            new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
@@ -127,10 +238,120 @@ void System::SaveState(u32 slot) const {
                       std::chrono::system_clock::now().time_since_epoch())
                       .count();
 
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
-        throw std::runtime_error("Could not write to file " + path);
+    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not write to file " + temp_path);
+    }
+
+    Common::Compression::ZSTDStreamCompressor compressor(
+        [&file](const u8* data, std::size_t size) { return file.WriteBytes(data, size) == size; });
+    CompressingStreamBuf stream_buf(compressor);
+    {
+        std::ostream stream(&stream_buf);
+        // Serialize
+        oarchive oa{stream};
+        oa& system;
     }
+    if (stream_buf.pubsync() != 0 || !compressor.Finish() || !file.Close()) {
+        throw std::runtime_error("Could not write to file " + temp_path);
+    }
+
+#ifdef _WIN32
+    // Renaming doesn't replace existing files on Windows
+    FileUtil::Delete(path);
+#endif
+    if (!FileUtil::Rename(temp_path, path)) {
+        throw std::runtime_error("Could not replace file " + path);
+    }
+    written = true;
+}
+
+/// Opens a save state and reads its header, leaving the file at the start of the compressed data
+static FileUtil::IOFile OpenSaveState(const std::string& path, CSTHeader& header) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file || file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+    return file;
+}
+
+/**
+ * Decompresses the compressed data of a save state without deserializing it, so that damaged files
+ * are rejected before the running system is torn down. Leaves the file where it was.
+ */
+static void ValidateSaveState(const std::string& path, FileUtil::IOFile& file) {
+    const u64 data_start = file.Tell();
+    Common::Compression::ZSTDStreamDecompressor decompressor(
+        [&file](u8* data, std::size_t size) { return file.ReadBytes(data, size); });
+    std::vector<u8> buffer(0x100000);
+    while (decompressor.Read(buffer.data(), buffer.size()) == buffer.size()) {
+    }
+    if (decompressor.IsFailed()) {
+        throw std::runtime_error("Save state file is damaged " + path);
+    }
+    if (!file.Seek(static_cast<s64>(data_start), SEEK_SET)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+}
+
+/// Deserializes the system from the compressed data of a save state, decompressing it on the fly
+static void ReadSaveState(const std::string& path, FileUtil::IOFile& file, System& system) {
+    Common::Compression::ZSTDStreamDecompressor decompressor(
+        [&file](u8* data, std::size_t size) { return file.ReadBytes(data, size); });
+    DecompressingStreamBuf stream_buf(decompressor);
+    std::istream stream(&stream_buf);
+
+    // Deserialize
+    iarchive ia{stream};
+    ia& system;
+
+    if (decompressor.IsFailed()) {
+        throw std::runtime_error("Could not decompress file at " + path);
+    }
+}
+
+void System::SaveState(u32 slot) {
+    CSTHeader header{};
+    header.program_id = title_id;
+    header.state_id = GenerateStateId();
+    WriteSaveState(GetSaveStatePath(title_id, slot), header, *this);
+
+    delta_base_id = header.state_id;
+    delta_base_slot = slot;
+    delta_base_captured = delta_states_enabled;
+    if (delta_base_captured) {
+        memory->CaptureDeltaBase();
+    }
+}
+
+void System::SetDeltaStatesEnabled(bool enabled) {
+    if (enabled == delta_states_enabled) {
+        return;
+    }
+    delta_states_enabled = enabled;
+    if (delta_base_captured && !enabled) {
+        memory->ReleaseDeltaBase();
+    }
+    // Even when enabling, pages written since the last full savestate went untracked
+    delta_base_captured = false;
+}
+
+void System::SaveDeltaState(u32 slot) const {
+    if (!delta_base_captured) {
+        throw std::runtime_error("Delta save states require them to be enabled, and a full save "
+                                 "state to be saved or loaded afterwards");
+    }
+    if (slot == delta_base_slot) {
+        throw std::runtime_error("Delta save state would overwrite its base");
+    }
+
+    memory->SetSaveDelta(true);
+    SCOPE_EXIT({ memory->SetSaveDelta(false); });
+
+    CSTHeader header{};
+    header.program_id = title_id;
+    header.base_state_id = delta_base_id;
+    header.base_slot = delta_base_slot;
+    WriteSaveState(GetSaveStatePath(title_id, slot), header, *this);
 }
 
 void System::LoadState(u32 slot) {
@@ -140,25 +361,34 @@ void System::LoadState(u32 slot) {
 
     const auto path = GetSaveStatePath(title_id, slot);
 
-    std::vector<u8> decompressed;
-    {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
+    CSTHeader header;
+    FileUtil::IOFile file = OpenSaveState(path, header);
+    ValidateSaveState(path, file);
 
-        FileUtil::IOFile file(path, "rb");
-        file.Seek(sizeof(CSTHeader), SEEK_SET); // Skip header
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+    if (header.base_state_id == 0) {
+        ReadSaveState(path, file, *this);
+
+        delta_base_id = header.state_id;
+        delta_base_slot = slot;
+        delta_base_captured = delta_states_enabled && delta_base_id != 0;
+        if (delta_base_captured) {
+            memory->CaptureDeltaBase();
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
+        return;
     }
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
 
-    // Deserialize
-    iarchive ia{sstream};
-    ia&* this;
+    // The memory of a delta save state is applied on top of its base
+    if (header.base_slot == slot) {
+        throw std::runtime_error("Delta save state refers to itself");
+    }
+    LoadState(header.base_slot);
+    if (delta_base_id != header.base_state_id) {
+        throw std::runtime_error("The base of the delta save state has been overwritten");
+    }
+
+    loading_delta_state = true;
+    SCOPE_EXIT({ loading_delta_state = false; });
+    ReadSaveState(path, file, *this);
 }
 
 } // namespace Core
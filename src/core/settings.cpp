@@ -8,6 +8,7 @@
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/shared_page.h"
+#include "core/hle/service/call_profiler.h"
 #include "core/hle/service/cam/cam.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/hle/service/ir/ir_rst.h"
@@ -28,10 +29,17 @@ void Apply() {
 
     VideoCore::g_hw_renderer_enabled = values.use_hw_renderer;
     VideoCore::g_shader_jit_enabled = values.use_shader_jit;
+    VideoCore::g_shader_jit_cache_size = values.shader_jit_cache_size;
+    VideoCore::g_use_disk_shader_jit_cache = values.use_disk_shader_jit_cache;
+    VideoCore::g_async_shader_jit = values.async_shader_jit;
     VideoCore::g_hw_shader_enabled = values.use_hw_shader;
     VideoCore::g_separable_shader_enabled = values.separable_shader;
     VideoCore::g_hw_shader_accurate_mul = values.shaders_accurate_mul;
     VideoCore::g_use_disk_shader_cache = values.use_disk_shader_cache;
+    VideoCore::g_sw_rasterizer_threads = values.sw_rasterizer_threads;
+    VideoCore::g_vertex_shader_threads = values.vertex_shader_threads;
+
+    Service::CallProfiler::SetEnabled(values.profile_hle_services);
 
     if (VideoCore::g_renderer) {
         VideoCore::g_renderer->UpdateCurrentFramebufferLayout();
@@ -77,6 +85,8 @@ void LogSettings() {
 
     LOG_INFO(Config, "Citra Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit);
+    log_setting("Core_UseCpuFastmem", values.use_cpu_fastmem);
+    log_setting("Core_UseCpuThreads", values.use_cpu_threads);
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage);
     log_setting("Renderer_UseGLES", values.use_gles);
     log_setting("Renderer_UseHwRenderer", values.use_hw_renderer);
@@ -84,6 +94,11 @@ void LogSettings() {
     log_setting("Renderer_SeparableShader", values.separable_shader);
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul);
     log_setting("Renderer_UseShaderJit", values.use_shader_jit);
+    log_setting("Renderer_ShaderJitCacheSize", values.shader_jit_cache_size);
+    log_setting("Renderer_UseDiskShaderJitCache", values.use_disk_shader_jit_cache);
+    log_setting("Renderer_AsyncShaderJit", values.async_shader_jit);
+    log_setting("Renderer_SwRasterizerThreads", values.sw_rasterizer_threads);
+    log_setting("Renderer_VertexShaderThreads", values.vertex_shader_threads);
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor);
     log_setting("Renderer_FrameLimit", values.frame_limit);
     log_setting("Renderer_UseFrameLimitAlternate", values.use_frame_limit_alternate);
@@ -120,6 +135,8 @@ void LogSettings() {
     log_setting("DataStorage_UseVirtualSd", values.use_virtual_sd);
     log_setting("System_IsNew3ds", values.is_new_3ds);
     log_setting("System_RegionValue", values.region_value);
+    log_setting("Debugging_ProfileHleServices", values.profile_hle_services);
+    log_setting("Debugging_GuestProfilerInterval", values.guest_profiler_interval);
     log_setting("Debugging_UseGdbstub", values.use_gdbstub);
     log_setting("Debugging_GdbstubPort", values.gdbstub_port);
 }
@@ -136,6 +136,8 @@ struct Values {
 
     // Core
     bool use_cpu_jit;
+    bool use_cpu_fastmem;
+    bool use_cpu_threads;
     int cpu_clock_percentage;
 
     // Data Storage
@@ -154,6 +156,11 @@ struct Values {
     bool use_disk_shader_cache;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    u16 shader_jit_cache_size;
+    bool use_disk_shader_jit_cache;
+    bool async_shader_jit;
+    u16 sw_rasterizer_threads;
+    u16 vertex_shader_threads;
     u16 resolution_factor;
     bool use_frame_limit_alternate;
     u16 frame_limit;
@@ -206,6 +213,8 @@ struct Values {
 
     // Debugging
     bool record_frame_times;
+    bool profile_hle_services;
+    u32 guest_profiler_interval;
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string log_filter;
@@ -0,0 +1,347 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/common_types.h"
+
+namespace Core {
+
+/// Refers to an event inserted into a TimingWheel. Default constructed handles refer to no event.
+struct TimingWheelHandle {
+    u32 index = 0;
+    u32 generation = 0;
+
+    bool IsValid() const {
+        return generation != 0;
+    }
+};
+
+/**
+ * Priority queue of timed events, implemented as a hierarchical timing wheel. Events are ordered
+ * by their s64 `time` member and events with the same time by their `fifo_order` member, as
+ * compared by `operator<` of the event type.
+ *
+ * Each level of the wheel splits time into 64 slots, the slots of a level being 64 times as wide
+ * as the ones of the level below. An event is stored in the slot of the lowest level that still
+ * tells it apart from the current base time, and moves down a level whenever the base time reaches
+ * its slot. Inserting and removing an event are constant time, finding the earliest event is
+ * constant time amortized over the lifetime of the events.
+ *
+ * The owner promises via SetTime that no event earlier than a given time will be inserted anymore,
+ * which allows the wheel to move its base time forward. Events inserted before that time anyway
+ * are kept in a separate sorted list.
+ */
+template <typename T>
+class TimingWheel {
+public:
+    using Handle = TimingWheelHandle;
+
+    TimingWheel() {
+        Clear();
+    }
+
+    bool Empty() const {
+        return size == 0;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    /// Inserts an event and returns a handle which can be used to remove it again
+    Handle Insert(const T& event) {
+        u32 index;
+        if (free_nodes.empty()) {
+            index = static_cast<u32>(nodes.size());
+            nodes.emplace_back();
+        } else {
+            index = free_nodes.back();
+            free_nodes.pop_back();
+        }
+
+        Node& node = nodes[index];
+        node.event = event;
+        Link(index);
+        ++size;
+
+        if (cached_min != INVALID_NODE && event < nodes[cached_min].event) {
+            cached_min = index;
+        }
+        return {index, node.generation};
+    }
+
+    /// Removes the event referred to by the handle. Returns false if it was removed already.
+    bool Remove(Handle handle) {
+        if (!handle.IsValid() || handle.index >= nodes.size()) {
+            return false;
+        }
+        const Node& node = nodes[handle.index];
+        if (node.generation != handle.generation || node.list == FREE_LIST) {
+            return false;
+        }
+        Erase(handle.index);
+        return true;
+    }
+
+    /// Removes all events matching the predicate and returns how many were removed
+    template <typename Predicate>
+    std::size_t RemoveIf(Predicate predicate) {
+        std::size_t count = 0;
+        for (u32 index = 0; index < nodes.size(); ++index) {
+            if (nodes[index].list != FREE_LIST && predicate(std::as_const(nodes[index].event))) {
+                Erase(index);
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    /// Returns the earliest event, or nullptr if the wheel is empty
+    const T* Peek() {
+        const u32 index = FindMin();
+        return index == INVALID_NODE ? nullptr : &nodes[index].event;
+    }
+
+    /// Removes and returns the earliest event
+    T Pop() {
+        const u32 index = FindMin();
+        ASSERT(index != INVALID_NODE);
+        T event = std::move(nodes[index].event);
+        Erase(index);
+        return event;
+    }
+
+    /// Promises that no event earlier than the given time will be inserted from now on
+    void SetTime(s64 time) {
+        now = std::max(now, ToKey(time));
+    }
+
+    /// Returns all events sorted by their order in the queue
+    std::vector<T> GetEvents() const {
+        std::vector<T> events;
+        events.reserve(size);
+        for (const Node& node : nodes) {
+            if (node.list != FREE_LIST) {
+                events.push_back(node.event);
+            }
+        }
+        std::sort(events.begin(), events.end());
+        return events;
+    }
+
+    /// Removes all events. Handles to the removed events stay invalid.
+    void Clear() {
+        for (u32 index = 0; index < nodes.size(); ++index) {
+            if (nodes[index].list != FREE_LIST) {
+                Free(index);
+            }
+        }
+        lists.fill({});
+        occupied.fill(0);
+        size = 0;
+        cached_min = INVALID_NODE;
+        base = now = ToKey(0);
+    }
+
+private:
+    static constexpr std::size_t LEVEL_BITS = 6;
+    static constexpr std::size_t SLOTS_PER_LEVEL = std::size_t{1} << LEVEL_BITS;
+    static constexpr std::size_t NUM_LEVELS = (64 + LEVEL_BITS - 1) / LEVEL_BITS;
+
+    /// The slot lists of all levels are followed by the list of events earlier than base
+    static constexpr u32 OVERDUE_LIST = NUM_LEVELS * SLOTS_PER_LEVEL;
+    static constexpr u32 FREE_LIST = OVERDUE_LIST + 1;
+    static constexpr u32 INVALID_NODE = 0xFFFFFFFF;
+
+    struct Node {
+        T event{};
+        u32 prev = INVALID_NODE;
+        u32 next = INVALID_NODE;
+        u32 list = FREE_LIST;
+        u32 generation = 1;
+    };
+
+    struct List {
+        u32 head = INVALID_NODE;
+        u32 tail = INVALID_NODE;
+    };
+
+    /// Maps times to unsigned keys with the same order
+    static u64 ToKey(s64 time) {
+        return static_cast<u64>(time) ^ (u64{1} << 63);
+    }
+
+    /// Stores a node in the list matching its time
+    void Link(u32 index) {
+        const u64 key = ToKey(nodes[index].event.time);
+        if (key < base) {
+            InsertSorted(OVERDUE_LIST, index);
+            return;
+        }
+
+        std::size_t level = 0;
+        for (u64 diff = (key ^ base) >> LEVEL_BITS; diff != 0; diff >>= LEVEL_BITS) {
+            ++level;
+        }
+        const std::size_t slot = (key >> (level * LEVEL_BITS)) & (SLOTS_PER_LEVEL - 1);
+        const u32 list = static_cast<u32>(level * SLOTS_PER_LEVEL + slot);
+
+        // All events of a level 0 slot have the same time, keeping them sorted makes the head of
+        // the slot the earliest event. Wider slots are searched when needed instead.
+        if (level == 0) {
+            InsertSorted(list, index);
+        } else {
+            InsertAfter(list, lists[list].tail, index);
+        }
+        occupied[level] |= u64{1} << slot;
+    }
+
+    void InsertSorted(u32 list, u32 index) {
+        u32 prev = lists[list].tail;
+        while (prev != INVALID_NODE && nodes[index].event < nodes[prev].event) {
+            prev = nodes[prev].prev;
+        }
+        InsertAfter(list, prev, index);
+    }
+
+    /// Inserts a node after prev, or at the head of the list if prev is INVALID_NODE
+    void InsertAfter(u32 list, u32 prev, u32 index) {
+        Node& node = nodes[index];
+        node.list = list;
+        node.prev = prev;
+        if (prev == INVALID_NODE) {
+            node.next = lists[list].head;
+            lists[list].head = index;
+        } else {
+            node.next = nodes[prev].next;
+            nodes[prev].next = index;
+        }
+        if (node.next == INVALID_NODE) {
+            lists[list].tail = index;
+        } else {
+            nodes[node.next].prev = index;
+        }
+    }
+
+    void Unlink(u32 index) {
+        Node& node = nodes[index];
+        List& list = lists[node.list];
+        if (node.prev == INVALID_NODE) {
+            list.head = node.next;
+        } else {
+            nodes[node.prev].next = node.next;
+        }
+        if (node.next == INVALID_NODE) {
+            list.tail = node.prev;
+        } else {
+            nodes[node.next].prev = node.prev;
+        }
+        if (list.head == INVALID_NODE && node.list < OVERDUE_LIST) {
+            occupied[node.list / SLOTS_PER_LEVEL] &= ~(u64{1} << (node.list % SLOTS_PER_LEVEL));
+        }
+    }
+
+    void Free(u32 index) {
+        Node& node = nodes[index];
+        node.list = FREE_LIST;
+        if (++node.generation == 0) {
+            node.generation = 1;
+        }
+        free_nodes.push_back(index);
+    }
+
+    void Erase(u32 index) {
+        Unlink(index);
+        Free(index);
+        --size;
+        if (cached_min == index) {
+            cached_min = INVALID_NODE;
+        }
+    }
+
+    /// Returns the index of the earliest node, moving events down the levels on the way
+    u32 FindMin() {
+        if (lists[OVERDUE_LIST].head != INVALID_NODE) {
+            return lists[OVERDUE_LIST].head;
+        }
+        if (cached_min != INVALID_NODE) {
+            return cached_min;
+        }
+
+        std::size_t level = 0;
+        while (level < NUM_LEVELS) {
+            if (occupied[level] == 0) {
+                ++level;
+                continue;
+            }
+
+            // Slots of a level below the digit of base are empty, the first occupied slot of the
+            // lowest occupied level contains the earliest event
+            const auto slot =
+                static_cast<std::size_t>(Common::LeastSignificantSetBit(occupied[level]));
+            const u32 list = static_cast<u32>(level * SLOTS_PER_LEVEL + slot);
+            if (level == 0) {
+                cached_min = lists[list].head;
+                return cached_min;
+            }
+
+            const std::size_t shift = (level + 1) * LEVEL_BITS;
+            const u64 upper_bits = shift >= 64 ? 0 : (base >> shift) << shift;
+            const u64 slot_start = upper_bits | (u64{slot} << (level * LEVEL_BITS));
+            if (slot_start > now) {
+                // Moving base any further would put events inserted later on into the overdue
+                // list, so search the slot instead
+                cached_min = FindMinInList(list);
+                return cached_min;
+            }
+
+            // Nothing is earlier than the slot, so base can move to its start. This only changes
+            // the level of the events in the slot, which all end up on lower levels.
+            base = slot_start;
+            u32 index = lists[list].head;
+            lists[list] = {};
+            occupied[level] &= ~(u64{1} << slot);
+            while (index != INVALID_NODE) {
+                const u32 next = nodes[index].next;
+                Link(index);
+                index = next;
+            }
+            level = 0;
+        }
+        return INVALID_NODE;
+    }
+
+    u32 FindMinInList(u32 list) const {
+        u32 min = lists[list].head;
+        for (u32 index = nodes[min].next; index != INVALID_NODE; index = nodes[index].next) {
+            if (nodes[index].event < nodes[min].event) {
+                min = index;
+            }
+        }
+        return min;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<u32> free_nodes;
+    std::array<List, OVERDUE_LIST + 1> lists;
+    /// Bit i of entry n is set if slot i of level n is not empty
+    std::array<u64, NUM_LEVELS> occupied;
+    std::size_t size;
+    /// Earliest node in the wheel if known, must be reset when events move between lists
+    u32 cached_min;
+
+    /// Keys of events in the wheel are at least base, which lags behind now
+    u64 base;
+    u64 now;
+};
+
+} // namespace Core
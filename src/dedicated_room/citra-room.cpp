@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -9,6 +10,7 @@
 #include <regex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <cryptopp/base64.h>
 #include <glad/glad.h>
 
@@ -50,6 +52,8 @@ static void PrintHelp(const char* argv0) {
                  "--room-name         The name of the room\n"
                  "--room-description  The room description\n"
                  "--port              The port used for the room\n"
+                 "--room-count        The number of rooms to host, on consecutive ports\n"
+                 "--threads           The number of threads running the rooms\n"
                  "--max_members       The maximum number of players for this room\n"
                  "--password          The password for the room\n"
                  "--preferred-game    The preferred game for this room\n"
@@ -152,6 +156,19 @@ static void SaveBanList(const Network::Room::BanList& ban_list, const std::strin
     file.flush();
 }
 
+static void PrintStats(const std::vector<std::shared_ptr<Network::Room>>& rooms) {
+    for (const auto& room : rooms) {
+        const Network::RoomInformation info = room->GetRoomInformation();
+        const Network::Room::Stats stats = room->GetStats();
+        std::cout << info.name << " (port " << info.port << "): " << stats.members << "/"
+                  << info.member_slots << " members, " << stats.packets_received
+                  << " packets received (" << stats.bytes_received << " bytes), "
+                  << stats.packets_relayed << " packets relayed (" << stats.bytes_relayed
+                  << " bytes)\n";
+    }
+    std::cout << std::endl;
+}
+
 static void InitializeLogging(const std::string& log_file) {
     Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
 
@@ -185,12 +202,16 @@ int main(int argc, char** argv) {
     u64 preferred_game_id = 0;
     u32 port = Network::DefaultRoomPort;
     u32 max_members = 16;
+    u32 room_count = 1;
+    u32 num_threads = 0;
     bool enable_citra_mods = false;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
         {"room-description", required_argument, 0, 'd'},
         {"port", required_argument, 0, 'p'},
+        {"room-count", required_argument, 0, 'r'},
+        {"threads", required_argument, 0, 'j'},
         {"max_members", required_argument, 0, 'm'},
         {"password", required_argument, 0, 'w'},
         {"preferred-game", required_argument, 0, 'g'},
@@ -207,7 +228,8 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "n:d:p:m:w:g:u:t:a:i:l:hv", long_options, &option_index);
+        int arg =
+            getopt_long(argc, argv, "n:d:p:r:j:m:w:g:u:t:a:i:l:hv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'n':
@@ -219,6 +241,12 @@ int main(int argc, char** argv) {
             case 'p':
                 port = strtoul(optarg, &endarg, 0);
                 break;
+            case 'r':
+                room_count = strtoul(optarg, &endarg, 0);
+                break;
+            case 'j':
+                num_threads = strtoul(optarg, &endarg, 0);
+                break;
             case 'm':
                 max_members = strtoul(optarg, &endarg, 0);
                 break;
@@ -279,11 +307,19 @@ int main(int argc, char** argv) {
         PrintHelp(argv[0]);
         return -1;
     }
-    if (port > 65535) {
-        std::cout << "port needs to be in the range 0 - 65535!\n\n";
+    if (room_count < 1 || room_count > 65536) {
+        std::cout << "room-count needs to be in the range 1 - 65536!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    if (port > 65535 || port + room_count - 1 > 65535) {
+        std::cout << "port needs to be in the range 0 - 65535, for each room!\n\n";
         PrintHelp(argv[0]);
         return -1;
     }
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::min(room_count, std::thread::hardware_concurrency()));
+    }
     if (ban_list_file.empty()) {
         std::cout << "Ban list file not set!\nThis should get set to load and save room ban "
                      "list.\nSet with --ban-list-file <file>\n\n";
@@ -318,56 +354,86 @@ int main(int argc, char** argv) {
 
     InitializeLogging(log_file);
 
-    // Load the ban list
-    Network::Room::BanList ban_list;
+    // Load the ban list, shared by all the rooms
+    auto ban_list = std::make_shared<Network::Room::SharedBanList>();
     if (!ban_list_file.empty()) {
-        ban_list = LoadBanList(ban_list_file);
+        ban_list->ban_list = LoadBanList(ban_list_file);
     }
 
-    std::unique_ptr<Network::VerifyUser::Backend> verify_backend;
+    std::shared_ptr<Network::VerifyUser::Backend> verify_backend;
     if (announce) {
 #ifdef ENABLE_WEB_SERVICE
-        verify_backend = std::make_unique<WebService::VerifyUserJWT>(Settings::values.web_api_url);
+        verify_backend = std::make_shared<WebService::VerifyUserJWT>(Settings::values.web_api_url);
 #else
         std::cout
             << "Citra Web Services is not available with this build: validation is disabled.\n\n";
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
+        verify_backend = std::make_shared<Network::VerifyUser::NullBackend>();
 #endif
     } else {
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
+        verify_backend = std::make_shared<Network::VerifyUser::NullBackend>();
     }
 
     Network::Init();
-    if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
-        if (!room->Create(room_name, room_description, "", port, password, max_members, username,
-                          preferred_game, preferred_game_id, std::move(verify_backend), ban_list,
-                          enable_citra_mods)) {
-            std::cout << "Failed to create room: \n\n";
+    auto worker_pool = std::make_shared<Network::RoomWorkerPool>(num_threads);
+    std::vector<std::shared_ptr<Network::Room>> rooms;
+    std::vector<std::unique_ptr<Core::AnnounceMultiplayerSession>> announce_sessions;
+    for (u32 i = 0; i < room_count; ++i) {
+        // The first room is the one of the global network instance, the others are extra ones
+        auto room = i == 0 ? Network::GetRoom().lock() : std::make_shared<Network::Room>();
+        if (!room) {
+            break;
+        }
+        const std::string name =
+            room_count == 1 ? room_name : room_name + " #" + std::to_string(i + 1);
+        room->SetSharedBanList(ban_list);
+        room->SetWorkerPool(worker_pool);
+        if (!room->Create(name, room_description, "", static_cast<u16>(port + i), password,
+                          max_members, username, preferred_game, preferred_game_id,
+                          verify_backend, {}, enable_citra_mods)) {
+            std::cout << "Failed to create room on port " << port + i << ": \n\n";
+            for (const auto& created_room : rooms) {
+                created_room->Destroy();
+            }
             return -1;
         }
-        std::cout << "Room is open. Close with Q+Enter...\n\n";
-        auto announce_session = std::make_unique<Core::AnnounceMultiplayerSession>();
+        rooms.push_back(room);
+        announce_sessions.push_back(std::make_unique<Core::AnnounceMultiplayerSession>(room));
+    }
+    if (!rooms.empty()) {
+        std::cout << rooms.size() << " room(s) open on " << num_threads
+                  << " thread(s). Show statistics with S+Enter, close with Q+Enter...\n\n";
         if (announce) {
-            announce_session->Start();
+            for (auto& announce_session : announce_sessions) {
+                announce_session->Start();
+            }
         }
-        while (room->GetState() == Network::Room::State::Open) {
+        while (rooms.front()->GetState() == Network::Room::State::Open) {
             std::string in;
             std::cin >> in;
-            if (in.size() > 0) {
+            if (in == "s" || in == "S") {
+                PrintStats(rooms);
+            } else if (in.size() > 0) {
                 break;
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         if (announce) {
-            announce_session->Stop();
+            for (auto& announce_session : announce_sessions) {
+                announce_session->Stop();
+            }
         }
-        announce_session.reset();
+        announce_sessions.clear();
+        PrintStats(rooms);
         // Save the ban list
         if (!ban_list_file.empty()) {
-            SaveBanList(room->GetBanList(), ban_list_file);
+            SaveBanList(rooms.front()->GetBanList(), ban_list_file);
+        }
+        for (const auto& room : rooms) {
+            room->Destroy();
         }
-        room->Destroy();
     }
+    rooms.clear();
+    worker_pool.reset();
     Network::Shutdown();
     detached_tasks.WaitForAllTasks();
     return 0;
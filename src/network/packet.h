@@ -64,7 +64,8 @@ public:
 
     explicit operator bool() const;
 
-    /// Overloads of operator >> to read data from the packet
+    /// Overloads of operator >> to read data from the packet. Reading past the end of the packet
+    /// invalidates it and leaves the value unchanged.
     Packet& operator>>(bool& out_data);
     Packet& operator>>(s8& out_data);
     Packet& operator>>(u8& out_data);
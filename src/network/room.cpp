@@ -4,20 +4,31 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <mutex>
 #include <random>
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
 #include "network/verify_user.h"
+#include "network/wifi_packet_batch.h"
 
 namespace Network {
 
+struct MacAddressHash {
+    std::size_t operator()(const MacAddress& address) const {
+        u64 value = 0;
+        std::memcpy(&value, address.data(), address.size());
+        return std::hash<u64>{}(value);
+    }
+};
+
 class Room::RoomImpl {
 public:
     // This MAC address is used to generate a 'Nintendo' like Mac address.
@@ -42,29 +53,58 @@ public:
         /// Data of the user, often including authenticated forum username.
         VerifyUser::UserData user_data;
         ENetPeer* peer; ///< The remote peer.
+        u32 features;   ///< The protocol features negotiated with the member.
     };
     using MemberList = std::vector<Member>;
     MemberList members;              ///< Information about the members of this room
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
-    UsernameBanList username_ban_list; ///< List of banned usernames
-    IPBanList ip_ban_list;             ///< List of banned IP addresses
-    mutable std::mutex ban_list_mutex; ///< Mutex for the ban lists
+    /// Peers of the members by MAC address, used to relay Wi-Fi packets. The members are only
+    /// modified by the room thread, which is the only user of this index, so it isn't locked.
+    std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> member_peers;
+
+    /// Wi-Fi frames waiting to be sent to a member that negotiated FeatureWifiPacketBatch
+    struct PendingBatch {
+        WifiPacketBatch batch;
+        bool compress; ///< Whether the member negotiated FeatureCompression
+    };
+    /// The frames relayed to each member while handling events are sent to them as one batch at
+    /// the end. Only used by the room thread, like member_peers.
+    std::unordered_map<ENetPeer*, PendingBatch> pending_batches;
+
+    /// Lists of banned usernames and IP addresses, possibly shared with other rooms
+    std::shared_ptr<SharedBanList> ban_list;
+
+    std::atomic<u64> packets_received{0}; ///< Packets received from the clients
+    std::atomic<u64> bytes_received{0};   ///< Bytes of the packets received from the clients
+    std::atomic<u64> packets_relayed{0};  ///< Wi-Fi packets relayed to members
+    std::atomic<u64> bytes_relayed{0};    ///< Bytes of the Wi-Fi packets relayed to members
 
     RoomImpl()
-        : NintendoOUI{0x00, 0x1F, 0x32, 0x00, 0x00, 0x00}, random_gen(std::random_device()()) {}
+        : NintendoOUI{0x00, 0x1F, 0x32, 0x00, 0x00, 0x00}, random_gen(std::random_device()()),
+          ban_list(std::make_shared<SharedBanList>()) {}
 
-    /// Thread that receives and dispatches network packets
+    /// Thread that receives and dispatches network packets, unless the room runs on a worker pool
     std::unique_ptr<std::thread> room_thread;
 
-    /// Verification backend of the room
-    std::unique_ptr<VerifyUser::Backend> verify_backend;
+    /// Worker pool running the event loop of the room, if any
+    std::shared_ptr<RoomWorkerPool> worker_pool;
+
+    /// Verification backend of the room, possibly shared with other rooms
+    std::shared_ptr<VerifyUser::Backend> verify_backend;
 
     /// Thread function that will receive and dispatch messages until the room is destroyed.
     void ServerLoop();
     void StartLoop();
 
+    /**
+     * Handles the network events received so far, waiting up to timeout_ms for the first one,
+     * then sends the packets they queued.
+     * @returns whether there were any events
+     */
+    bool ServiceEvents(u32 timeout_ms);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -153,13 +193,13 @@ public:
      * Notifies the member that its connection attempt was successful,
      * and it is now part of the room.
      */
-    void SendJoinSuccess(ENetPeer* client, MacAddress mac_address);
+    void SendJoinSuccess(ENetPeer* client, MacAddress mac_address, u32 features);
 
     /**
      * Notifies the member that its connection attempt was successful,
      * and it is now part of the room, and it has been granted mod permissions.
      */
-    void SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_address);
+    void SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_address, u32 features);
 
     /**
      * Sends a IdHostKicked message telling the client that they have been kicked.
@@ -223,11 +263,33 @@ public:
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Relays this packet to its destination member, or to all members except the sender if it is
+     * a broadcast. The received ENet packet is queued as is, and ENet frees it once it is sent.
      * @param event The ENet event containing the data
      */
     void HandleWifiPacket(const ENetEvent* event);
 
+    /**
+     * Relays each frame of a batch of Wi-Fi packets to its destination members.
+     * @param event The ENet event containing the data
+     */
+    void HandleWifiPacketBatch(const ENetEvent* event);
+
+    /**
+     * Relays a Wi-Fi frame to its destination member, or to all members except the sender if it
+     * is a broadcast. The frame is added to the pending batch of the members that support them,
+     * and sent as an IdWifiPacket message to the others.
+     * @param sender The peer that sent the frame
+     * @param frame The body of an IdWifiPacket message, without its message type
+     * @param enet_packet The received IdWifiPacket message of the frame, if any, which is then
+     * queued as is instead of a copy
+     */
+    void RelayWifiFrame(ENetPeer* sender, const u8* frame, std::size_t size,
+                        ENetPacket* enet_packet);
+
+    /// Sends the pending batch of Wi-Fi frames of a member
+    void SendWifiPacketBatch(ENetPeer* client, PendingBatch& pending);
+
     /**
      * Extracts a chat entry from a received ENet packet and adds it to the chat queue.
      * @param event The ENet event that was received.
@@ -250,50 +312,73 @@ public:
 // RoomImpl
 void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
-        ENetEvent event;
-        if (enet_host_service(server, &event, 50) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
+        ServiceEvents(50);
+    }
+    // Close the connection to all members:
+    SendCloseMessage();
+}
+
+bool Room::RoomImpl::ServiceEvents(u32 timeout_ms) {
+    ENetEvent event;
+    if (enet_host_service(server, &event, timeout_ms) <= 0) {
+        return false;
+    }
+    // Handle all the events received so far, then send the packets they queued at once
+    do {
+        switch (event.type) {
+        case ENET_EVENT_TYPE_RECEIVE:
+            packets_received.fetch_add(1, std::memory_order_relaxed);
+            bytes_received.fetch_add(event.packet->dataLength, std::memory_order_relaxed);
+            switch (event.packet->data[0]) {
+            case IdJoinRequest:
+                HandleJoinRequest(&event);
+                break;
+            case IdSetGameInfo:
+                HandleGameNamePacket(&event);
+                break;
+            case IdWifiPacket:
+                HandleWifiPacket(&event);
                 break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
+            case IdWifiPacketBatch:
+                HandleWifiPacketBatch(&event);
                 break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
+            case IdChatMessage:
+                HandleChatPacket(&event);
+                break;
+            // Moderation
+            case IdModKick:
+                HandleModKickPacket(&event);
+                break;
+            case IdModBan:
+                HandleModBanPacket(&event);
+                break;
+            case IdModUnban:
+                HandleModUnbanPacket(&event);
+                break;
+            case IdModGetBanList:
+                HandleModGetBanListPacket(&event);
                 break;
             }
+            // Relayed packets are referenced by the peers they are queued on
+            if (event.packet->referenceCount == 0) {
+                enet_packet_destroy(event.packet);
+            }
+            break;
+        case ENET_EVENT_TYPE_DISCONNECT:
+            HandleClientDisconnection(event.peer);
+            break;
+        case ENET_EVENT_TYPE_NONE:
+        case ENET_EVENT_TYPE_CONNECT:
+            break;
+        }
+    } while (enet_host_check_events(server, &event) > 0);
+    for (auto& [peer, pending] : pending_batches) {
+        if (!pending.batch.IsEmpty()) {
+            SendWifiPacketBatch(peer, pending);
         }
     }
-    // Close the connection to all members:
-    SendCloseMessage();
+    enet_host_flush(server);
+    return true;
 }
 
 void Room::RoomImpl::StartLoop() {
@@ -329,6 +414,11 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     std::string token;
     packet >> token;
 
+    // Members without protocol features end their request with the token
+    u32 features = 0;
+    packet >> features;
+    features &= SupportedProtocolFeatures;
+
     if (pass != password) {
         SendWrongPassword(event->peer);
         return;
@@ -366,6 +456,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     member.console_id_hash = console_id_hash;
     member.nickname = nickname;
     member.peer = event->peer;
+    member.features = features;
 
     std::string uid;
     {
@@ -376,7 +467,8 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     std::string ip;
     {
-        std::lock_guard lock(ban_list_mutex);
+        std::lock_guard lock(ban_list->mutex);
+        const auto& [username_ban_list, ip_ban_list] = ban_list->ban_list;
 
         // Check username ban
         if (!member.user_data.username.empty() &&
@@ -403,15 +495,19 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard lock(member_mutex);
+        member_peers.emplace(member.mac_address, member.peer);
+        if (features & FeatureWifiPacketBatch) {
+            pending_batches[member.peer] = {{}, (features & FeatureCompression) != 0};
+        }
         members.push_back(std::move(member));
     }
 
     // Notify everyone that the room information has changed.
     BroadcastRoomInformation();
     if (HasModPermission(event->peer)) {
-        SendJoinSuccessAsMod(event->peer, preferred_mac);
+        SendJoinSuccessAsMod(event->peer, preferred_mac, features);
     } else {
-        SendJoinSuccess(event->peer, preferred_mac);
+        SendJoinSuccess(event->peer, preferred_mac, features);
     }
 }
 
@@ -449,6 +545,8 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        member_peers.erase(target_member->mac_address);
+        pending_batches.erase(target_member->peer);
         members.erase(target_member);
     }
 
@@ -492,11 +590,14 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        member_peers.erase(target_member->mac_address);
+        pending_batches.erase(target_member->peer);
         members.erase(target_member);
     }
 
     {
-        std::lock_guard lock(ban_list_mutex);
+        std::lock_guard lock(ban_list->mutex);
+        auto& [username_ban_list, ip_ban_list] = ban_list->ban_list;
 
         if (!username.empty()) {
             // Ban the forum username
@@ -533,7 +634,8 @@ void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
 
     bool unbanned = false;
     {
-        std::lock_guard lock(ban_list_mutex);
+        std::lock_guard lock(ban_list->mutex);
+        auto& [username_ban_list, ip_ban_list] = ban_list->ban_list;
 
         auto it = std::find(username_ban_list.begin(), username_ban_list.end(), address);
         if (it != username_ban_list.end()) {
@@ -673,20 +775,23 @@ void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
     enet_host_flush(server);
 }
 
-void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
+void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address, u32 features) {
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccess);
     packet << mac_address;
+    packet << features;
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
 
-void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_address) {
+void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_address,
+                                          u32 features) {
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccessAsMod);
     packet << mac_address;
+    packet << features;
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
@@ -737,9 +842,9 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModBanListResponse);
     {
-        std::lock_guard lock(ban_list_mutex);
-        packet << username_ban_list;
-        packet << ip_ban_list;
+        std::lock_guard lock(ban_list->mutex);
+        packet << ban_list->ban_list.first;
+        packet << ban_list->ban_list.second;
     }
 
     ENetPacket* enet_packet =
@@ -847,51 +952,92 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
-    MacAddress destination_address;
-    in_packet >> destination_address;
+    ENetPacket* enet_packet = event->packet;
+    enet_packet->flags |= ENET_PACKET_FLAG_RELIABLE;
+    RelayWifiFrame(event->peer, enet_packet->data + sizeof(u8),
+                   enet_packet->dataLength - sizeof(u8), enet_packet);
+}
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+void Room::RoomImpl::HandleWifiPacketBatch(const ENetEvent* event) {
+    const bool valid = WifiPacketBatch::ForEachFrame(
+        event->packet->data, event->packet->dataLength,
+        [this, event](const u8* frame, std::size_t size) {
+            RelayWifiFrame(event->peer, frame, size, nullptr);
+        });
+    if (!valid) {
+        LOG_WARNING(Network, "Received an invalid Wi-Fi packet batch");
+    }
+}
 
-    if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
-        for (const auto& member : members) {
-            if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+void Room::RoomImpl::RelayWifiFrame(ENetPeer* sender, const u8* frame, std::size_t size,
+                                    ENetPacket* enet_packet) {
+    // WifiPacket type, channel and transmitter address
+    constexpr std::size_t destination_offset = 2 * sizeof(u8) + sizeof(MacAddress);
+    if (size < destination_offset + sizeof(MacAddress)) {
+        return;
+    }
+    MacAddress destination_address;
+    std::memcpy(destination_address.data(), frame + destination_offset, sizeof(MacAddress));
+
+    // The IdWifiPacket message of a frame received in a batch is only built if a member needs it
+    const bool owns_packet = enet_packet == nullptr;
+    u64 relayed = 0;
+    const auto relay = [&](ENetPeer* peer) {
+        const auto pending = pending_batches.find(peer);
+        if (pending != pending_batches.end()) {
+            if (pending->second.batch.Append(frame, size)) {
+                ++relayed;
+                return;
             }
+            // The batch is full, send it to make room for the frame
+            SendWifiPacketBatch(peer, pending->second);
+            if (pending->second.batch.Append(frame, size)) {
+                ++relayed;
+                return;
+            }
+        }
+        if (!enet_packet) {
+            enet_packet = enet_packet_create(nullptr, sizeof(u8) + size, ENET_PACKET_FLAG_RELIABLE);
+            enet_packet->data[0] = IdWifiPacket;
+            std::memcpy(enet_packet->data + sizeof(u8), frame, size);
         }
+        if (enet_peer_send(peer, 0, enet_packet) == 0) {
+            ++relayed;
+        }
+    };
 
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
+    if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
+        for (const auto& [mac_address, peer] : member_peers) {
+            if (peer != sender) {
+                relay(peer);
+            }
         }
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        const auto member = member_peers.find(destination_address);
+        if (member != member_peers.end()) {
+            relay(member->second);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
-    enet_host_flush(server);
+    if (owns_packet && enet_packet && enet_packet->referenceCount == 0) {
+        enet_packet_destroy(enet_packet);
+    }
+    packets_relayed.fetch_add(relayed, std::memory_order_relaxed);
+    bytes_relayed.fetch_add(relayed * (sizeof(u8) + size), std::memory_order_relaxed);
+}
+
+void Room::RoomImpl::SendWifiPacketBatch(ENetPeer* client, PendingBatch& pending) {
+    const Packet packet = pending.batch.Build(pending.compress);
+    ENetPacket* enet_packet =
+        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    if (enet_peer_send(client, 0, enet_packet) != 0) {
+        enet_packet_destroy(enet_packet);
+    }
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -993,6 +1139,8 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
+            member_peers.erase(member->mac_address);
+            pending_batches.erase(member->peer);
             members.erase(member);
         }
     }
@@ -1013,7 +1161,7 @@ bool Room::Create(const std::string& name, const std::string& description,
                   const std::string& server_address, u16 server_port, const std::string& password,
                   const u32 max_connections, const std::string& host_username,
                   const std::string& preferred_game, u64 preferred_game_id,
-                  std::unique_ptr<VerifyUser::Backend> verify_backend,
+                  std::shared_ptr<VerifyUser::Backend> verify_backend,
                   const Room::BanList& ban_list, bool enable_citra_mods) {
     ENetAddress address;
     address.host = ENET_HOST_ANY;
@@ -1040,13 +1188,42 @@ bool Room::Create(const std::string& name, const std::string& description,
     room_impl->room_information.enable_citra_mods = enable_citra_mods;
     room_impl->password = password;
     room_impl->verify_backend = std::move(verify_backend);
-    room_impl->username_ban_list = ban_list.first;
-    room_impl->ip_ban_list = ban_list.second;
+    {
+        std::lock_guard lock(room_impl->ban_list->mutex);
+        auto& [username_ban_list, ip_ban_list] = room_impl->ban_list->ban_list;
+        for (const auto& username : ban_list.first) {
+            if (std::find(username_ban_list.begin(), username_ban_list.end(), username) ==
+                username_ban_list.end()) {
+                username_ban_list.emplace_back(username);
+            }
+        }
+        for (const auto& ip : ban_list.second) {
+            if (std::find(ip_ban_list.begin(), ip_ban_list.end(), ip) == ip_ban_list.end()) {
+                ip_ban_list.emplace_back(ip);
+            }
+        }
+    }
+    room_impl->packets_received = 0;
+    room_impl->bytes_received = 0;
+    room_impl->packets_relayed = 0;
+    room_impl->bytes_relayed = 0;
 
-    room_impl->StartLoop();
+    if (room_impl->worker_pool) {
+        room_impl->worker_pool->AddRoom(*room_impl);
+    } else {
+        room_impl->StartLoop();
+    }
     return true;
 }
 
+void Room::SetSharedBanList(std::shared_ptr<SharedBanList> ban_list) {
+    room_impl->ban_list = std::move(ban_list);
+}
+
+void Room::SetWorkerPool(std::shared_ptr<RoomWorkerPool> worker_pool) {
+    room_impl->worker_pool = std::move(worker_pool);
+}
+
 Room::State Room::GetState() const {
     return room_impl->state;
 }
@@ -1061,8 +1238,19 @@ std::string Room::GetVerifyUID() const {
 }
 
 Room::BanList Room::GetBanList() const {
-    std::lock_guard lock(room_impl->ban_list_mutex);
-    return {room_impl->username_ban_list, room_impl->ip_ban_list};
+    std::lock_guard lock(room_impl->ban_list->mutex);
+    return room_impl->ban_list->ban_list;
+}
+
+Room::Stats Room::GetStats() const {
+    Stats stats{};
+    stats.packets_received = room_impl->packets_received.load(std::memory_order_relaxed);
+    stats.bytes_received = room_impl->bytes_received.load(std::memory_order_relaxed);
+    stats.packets_relayed = room_impl->packets_relayed.load(std::memory_order_relaxed);
+    stats.bytes_relayed = room_impl->bytes_relayed.load(std::memory_order_relaxed);
+    std::lock_guard lock(room_impl->member_mutex);
+    stats.members = static_cast<u32>(room_impl->members.size());
+    return stats;
 }
 
 std::vector<Room::Member> Room::GetRoomMemberList() const {
@@ -1092,8 +1280,13 @@ void Room::SetVerifyUID(const std::string& uid) {
 
 void Room::Destroy() {
     room_impl->state = State::Closed;
-    room_impl->room_thread->join();
-    room_impl->room_thread.reset();
+    if (room_impl->worker_pool) {
+        room_impl->worker_pool->RemoveRoom(*room_impl);
+        room_impl->SendCloseMessage();
+    } else {
+        room_impl->room_thread->join();
+        room_impl->room_thread.reset();
+    }
 
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
@@ -1104,8 +1297,84 @@ void Room::Destroy() {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
     }
+    room_impl->member_peers.clear();
+    room_impl->pending_batches.clear();
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
 }
 
+// RoomWorkerPool
+struct RoomWorkerPool::Worker {
+    std::thread thread;
+    std::atomic<bool> running{true};
+    std::mutex mutex; ///< Held while the rooms are added, removed or handling events
+    std::vector<Room::RoomImpl*> rooms;
+};
+
+RoomWorkerPool::RoomWorkerPool(std::size_t num_threads) {
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        auto& worker = workers.emplace_back(std::make_unique<Worker>());
+        worker->thread = std::thread(&RoomWorkerPool::WorkerLoop, this, std::ref(*worker));
+    }
+}
+
+RoomWorkerPool::~RoomWorkerPool() {
+    for (auto& worker : workers) {
+        worker->running = false;
+        worker->thread.join();
+    }
+}
+
+void RoomWorkerPool::WorkerLoop(Worker& worker) {
+    while (worker.running) {
+        ENetSocketSet sockets;
+        ENET_SOCKETSET_EMPTY(sockets);
+        ENetSocket max_socket = 0;
+        bool has_rooms = false;
+        bool handled_events = false;
+        {
+            std::lock_guard lock(worker.mutex);
+            for (Room::RoomImpl* room : worker.rooms) {
+                handled_events |= room->ServiceEvents(0);
+                ENET_SOCKETSET_ADD(sockets, room->server->socket);
+                max_socket = std::max(max_socket, room->server->socket);
+            }
+            has_rooms = !worker.rooms.empty();
+        }
+        if (handled_events) {
+            continue;
+        }
+        if (!has_rooms) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            continue;
+        }
+        // Wait for any of the rooms to receive something. The sockets of rooms removed meanwhile
+        // at worst make this return early.
+        enet_socketset_select(max_socket, &sockets, nullptr, 50);
+    }
+}
+
+void RoomWorkerPool::AddRoom(Room::RoomImpl& room) {
+    Worker* least_busy_worker = nullptr;
+    std::size_t fewest_rooms = 0;
+    for (auto& worker : workers) {
+        std::lock_guard lock(worker->mutex);
+        if (!least_busy_worker || worker->rooms.size() < fewest_rooms) {
+            least_busy_worker = worker.get();
+            fewest_rooms = worker->rooms.size();
+        }
+    }
+    std::lock_guard lock(least_busy_worker->mutex);
+    least_busy_worker->rooms.push_back(&room);
+}
+
+void RoomWorkerPool::RemoveRoom(Room::RoomImpl& room) {
+    for (auto& worker : workers) {
+        std::lock_guard lock(worker->mutex);
+        worker->rooms.erase(std::remove(worker->rooms.begin(), worker->rooms.end(), &room),
+                            worker->rooms.end());
+    }
+}
+
 } // namespace Network
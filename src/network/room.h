@@ -6,6 +6,7 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
@@ -13,6 +14,8 @@
 
 namespace Network {
 
+class RoomWorkerPool;
+
 constexpr u32 network_version = 4; ///< The version of this Room and RoomMember
 
 constexpr u16 DefaultRoomPort = 24872;
@@ -76,8 +79,19 @@ enum RoomMessageTypes : u8 {
     IdModPermissionDenied,
     IdModNoSuchUser,
     IdJoinSuccessAsMod,
+    IdWifiPacketBatch,
+};
+
+/// Optional extensions of the protocol, negotiated when joining a room, so that rooms and members
+/// without them keep working together
+enum ProtocolFeatures : u32 {
+    FeatureWifiPacketBatch = 1 << 0, ///< Wi-Fi frames may be coalesced into IdWifiPacketBatch
+    FeatureCompression = 1 << 1,     ///< The frames of IdWifiPacketBatch may be compressed
 };
 
+/// The protocol features this Room and RoomMember support
+constexpr u32 SupportedProtocolFeatures = FeatureWifiPacketBatch | FeatureCompression;
+
 /// Types of system status messages
 enum StatusMessageTypes : u8 {
     IdMemberJoin = 1,  ///< Member joining
@@ -104,6 +118,15 @@ public:
         MacAddress mac_address;   ///< The assigned mac address of the member.
     };
 
+    /// Counters of the traffic of a room since it was created
+    struct Stats {
+        u64 packets_received; ///< Packets received from the clients
+        u64 bytes_received;   ///< Bytes of the packets received from the clients
+        u64 packets_relayed;  ///< Wi-Fi packets relayed to members, once per destination
+        u64 bytes_relayed;    ///< Bytes of the Wi-Fi packets relayed to members
+        u32 members;          ///< Number of members in the room
+    };
+
     Room();
     ~Room();
 
@@ -137,6 +160,24 @@ public:
 
     using BanList = std::pair<UsernameBanList, IPBanList>;
 
+    /// A ban list several rooms can share, guarded by its mutex
+    struct SharedBanList {
+        std::mutex mutex;
+        BanList ban_list;
+    };
+
+    /**
+     * Makes the room use a ban list shared with other rooms, so that a ban in any of them applies
+     * to all of them. Must be called while the room is closed. Create adds its ban_list to it.
+     */
+    void SetSharedBanList(std::shared_ptr<SharedBanList> ban_list);
+
+    /**
+     * Makes the room run its event loop on a thread of the pool, instead of on a thread of its
+     * own. Must be called while the room is closed.
+     */
+    void SetWorkerPool(std::shared_ptr<RoomWorkerPool> worker_pool);
+
     /**
      * Creates the socket for this room. Will bind to default address if
      * server is empty string.
@@ -147,7 +188,7 @@ public:
                 const u32 max_connections = MaxConcurrentConnections,
                 const std::string& host_username = "", const std::string& preferred_game = "",
                 u64 preferred_game_id = 0,
-                std::unique_ptr<VerifyUser::Backend> verify_backend = nullptr,
+                std::shared_ptr<VerifyUser::Backend> verify_backend = nullptr,
                 const BanList& ban_list = {}, bool enable_citra_mods = false);
 
     /**
@@ -160,14 +201,46 @@ public:
      */
     BanList GetBanList() const;
 
+    /**
+     * Gets the traffic counters of the room.
+     */
+    Stats GetStats() const;
+
     /**
      * Destroys the socket
      */
     void Destroy();
 
 private:
+    friend class RoomWorkerPool;
+
     class RoomImpl;
     std::unique_ptr<RoomImpl> room_impl;
 };
 
+/**
+ * Runs the event loops of several rooms on a fixed number of threads, instead of on a thread per
+ * room. Each room is pinned to the thread with the fewest rooms when it is created, and each thread
+ * waits for the network events of all its rooms at once.
+ */
+class RoomWorkerPool final {
+public:
+    explicit RoomWorkerPool(std::size_t num_threads);
+    ~RoomWorkerPool();
+
+private:
+    friend class Room;
+    struct Worker;
+
+    void WorkerLoop(Worker& worker);
+
+    /// Pins a room to the thread with the fewest rooms
+    void AddRoom(Room::RoomImpl& room);
+
+    /// Unpins a room. When this returns, the thread no longer handles the events of the room.
+    void RemoveRoom(Room::RoomImpl& room);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+};
+
 } // namespace Network
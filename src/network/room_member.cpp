@@ -8,9 +8,11 @@
 #include <set>
 #include <thread>
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room_member.h"
+#include "network/wifi_packet_batch.h"
 
 namespace Network {
 
@@ -41,11 +43,15 @@ public:
 
     MacAddress mac_address; ///< The mac_address of this member.
 
+    std::atomic<u32> features{0}; ///< The protocol features negotiated with the room.
+
     std::mutex network_mutex; ///< Mutex that controls access to the `client` variable.
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> loop_thread;
     std::mutex send_list_mutex;  ///< Mutex that controls access to the `send_list` variable.
     std::list<Packet> send_list; ///< A list that stores all packets to send the async
+    /// Wi-Fi frames to send with the next packets, guarded by `send_list_mutex`
+    WifiPacketBatch wifi_packet_batch;
 
     template <typename T>
     using CallbackSet = std::set<CallbackHandle<T>>;
@@ -77,6 +83,13 @@ public:
      */
     void Send(Packet&& packet);
 
+    /**
+     * Sends a Wi-Fi frame to the room, coalesced with the other frames sent until the packets
+     * are sent. Only used if the room supports FeatureWifiPacketBatch.
+     * @param frame The body of an IdWifiPacket message, without its message type
+     */
+    void SendBatched(const Packet& frame);
+
     /**
      * Sends a request to the server, asking for permission to join a room with the specified
      * nickname and preferred mac.
@@ -107,6 +120,12 @@ public:
      */
     void HandleWifiPackets(const ENetEvent* event);
 
+    /**
+     * Extracts the WifiPackets of a batch from a received ENet packet.
+     * @param event The ENet event that was received.
+     */
+    void HandleWifiPacketBatch(const ENetEvent* event);
+
     /**
      * Extracts a chat entry from a received ENet packet and adds it to the chat queue.
      * @param event The ENet event that was received.
@@ -166,6 +185,9 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
                 case IdWifiPacket:
                     HandleWifiPackets(&event);
                     break;
+                case IdWifiPacketBatch:
+                    HandleWifiPacketBatch(&event);
+                    break;
                 case IdChatMessage:
                     HandleChatPacket(&event);
                     break;
@@ -253,6 +275,9 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
         }
         {
             std::lock_guard lock(send_list_mutex);
+            if (!wifi_packet_batch.IsEmpty()) {
+                send_list.push_back(wifi_packet_batch.Build(features & FeatureCompression));
+            }
             for (const auto& packet : send_list) {
                 ENetPacket* enetPacket = enet_packet_create(packet.GetData(), packet.GetDataSize(),
                                                             ENET_PACKET_FLAG_RELIABLE);
@@ -274,6 +299,23 @@ void RoomMember::RoomMemberImpl::Send(Packet&& packet) {
     send_list.push_back(std::move(packet));
 }
 
+void RoomMember::RoomMemberImpl::SendBatched(const Packet& frame) {
+    const u8* data = static_cast<const u8*>(frame.GetData());
+    std::lock_guard lock(send_list_mutex);
+    if (wifi_packet_batch.Append(data, frame.GetDataSize())) {
+        return;
+    }
+    // The batch is full, queue it to make room for the frame
+    send_list.push_back(wifi_packet_batch.Build(features & FeatureCompression));
+    if (!wifi_packet_batch.Append(data, frame.GetDataSize())) {
+        // Too large for any batch, send it on its own
+        Packet packet;
+        packet << static_cast<u8>(IdWifiPacket);
+        packet.Append(data, frame.GetDataSize());
+        send_list.push_back(std::move(packet));
+    }
+}
+
 void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
                                                  const std::string& console_id_hash,
                                                  const MacAddress& preferred_mac,
@@ -287,6 +329,7 @@ void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
     packet << network_version;
     packet << password;
     packet << token;
+    packet << SupportedProtocolFeatures;
     Send(std::move(packet));
 }
 
@@ -343,17 +386,16 @@ void RoomMember::RoomMemberImpl::HandleJoinPacket(const ENetEvent* event) {
 
     // Parse the MAC Address from the packet
     packet >> mac_address;
+
+    // Rooms without protocol features end their answer with the MAC address
+    u32 negotiated_features = 0;
+    packet >> negotiated_features;
+    features = negotiated_features & SupportedProtocolFeatures;
 }
 
-void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
+/// Reads the fields of a WifiPacket, which follow the message type of IdWifiPacket messages
+static WifiPacket ReadWifiPacket(Packet& packet) {
     WifiPacket wifi_packet{};
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
-
-    // Ignore the first byte, which is the message id.
-    packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
-
-    // Parse the WifiPacket from the packet
     u8 frame_type;
     packet >> frame_type;
     WifiPacket::PacketType type = static_cast<WifiPacket::PacketType>(frame_type);
@@ -363,8 +405,30 @@ void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
     packet >> wifi_packet.transmitter_address;
     packet >> wifi_packet.destination_address;
     packet >> wifi_packet.data;
+    return wifi_packet;
+}
+
+void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
+    Packet packet;
+    packet.Append(event->packet->data, event->packet->dataLength);
 
-    Invoke<WifiPacket>(wifi_packet);
+    // Ignore the first byte, which is the message id.
+    packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
+
+    // Parse the WifiPacket from the packet
+    Invoke<WifiPacket>(ReadWifiPacket(packet));
+}
+
+void RoomMember::RoomMemberImpl::HandleWifiPacketBatch(const ENetEvent* event) {
+    const bool valid = WifiPacketBatch::ForEachFrame(
+        event->packet->data, event->packet->dataLength, [this](const u8* frame, std::size_t size) {
+            Packet packet;
+            packet.Append(frame, size);
+            Invoke<WifiPacket>(ReadWifiPacket(packet));
+        });
+    if (!valid) {
+        LOG_WARNING(Network, "Received an invalid Wi-Fi packet batch");
+    }
 }
 
 void RoomMember::RoomMemberImpl::HandleChatPacket(const ENetEvent* event) {
@@ -551,6 +615,7 @@ void RoomMember::Join(const std::string& nick, const std::string& console_id_has
     }
 
     room_member_impl->SetState(State::Joining);
+    room_member_impl->features = 0;
 
     ENetAddress address{};
     enet_address_set_host(&address, server_addr);
@@ -583,14 +648,21 @@ bool RoomMember::IsConnected() const {
 }
 
 void RoomMember::SendWifiPacket(const WifiPacket& wifi_packet) {
+    const bool batched = room_member_impl->features & FeatureWifiPacketBatch;
     Packet packet;
-    packet << static_cast<u8>(IdWifiPacket);
+    if (!batched) {
+        packet << static_cast<u8>(IdWifiPacket);
+    }
     packet << static_cast<u8>(wifi_packet.type);
     packet << wifi_packet.channel;
     packet << wifi_packet.transmitter_address;
     packet << wifi_packet.destination_address;
     packet << wifi_packet.data;
-    room_member_impl->Send(std::move(packet));
+    if (batched) {
+        room_member_impl->SendBatched(packet);
+    } else {
+        room_member_impl->Send(std::move(packet));
+    }
 }
 
 void RoomMember::SendChatMessage(const std::string& message) {
@@ -0,0 +1,99 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/zstd_compression.h"
+#include "network/room.h"
+#include "network/wifi_packet_batch.h"
+
+namespace Network {
+
+/// Flag of the batch header, set when the frames are compressed
+constexpr u8 BatchCompressed = 1 << 0;
+
+/// Batches smaller than this are sent uncompressed, as they rarely get any smaller
+constexpr std::size_t MinCompressedBatchSize = 128;
+
+/// Compression is done on the network threads for every batch, so it favors speed over ratio
+constexpr s32 BatchCompressionLevel = 1;
+
+/// Message type and flags
+constexpr std::size_t BatchHeaderSize = 2 * sizeof(u8);
+
+bool WifiPacketBatch::Append(const u8* frame, std::size_t size) {
+    if (frames.size() + sizeof(u32) + size > MaxWifiPacketBatchSize) {
+        return false;
+    }
+    // The size is stored in network byte order, like the fields of Network::Packet
+    const u32 frame_size = static_cast<u32>(size);
+    frames.push_back(static_cast<u8>(frame_size >> 24));
+    frames.push_back(static_cast<u8>(frame_size >> 16));
+    frames.push_back(static_cast<u8>(frame_size >> 8));
+    frames.push_back(static_cast<u8>(frame_size));
+    frames.insert(frames.end(), frame, frame + size);
+    ++frame_count;
+    return true;
+}
+
+Packet WifiPacketBatch::Build(bool compress) {
+    Packet packet;
+    packet << static_cast<u8>(IdWifiPacketBatch);
+
+    std::vector<u8> compressed;
+    if (compress && frames.size() >= MinCompressedBatchSize) {
+        compressed = Common::Compression::CompressDataZSTD(frames.data(), frames.size(),
+                                                           BatchCompressionLevel);
+    }
+    if (!compressed.empty() && compressed.size() < frames.size()) {
+        packet << BatchCompressed;
+        packet.Append(compressed.data(), compressed.size());
+    } else {
+        packet << u8{0};
+        packet.Append(frames.data(), frames.size());
+    }
+
+    // Keep the capacity, as the next batch is likely to be as large
+    frames.clear();
+    frame_count = 0;
+    return packet;
+}
+
+bool WifiPacketBatch::ForEachFrame(
+    const u8* message, std::size_t size,
+    const std::function<void(const u8* frame, std::size_t size)>& func) {
+    if (size < BatchHeaderSize) {
+        return false;
+    }
+    const u8 flags = message[1];
+    const u8* data = message + BatchHeaderSize;
+    std::size_t data_size = size - BatchHeaderSize;
+
+    std::vector<u8> decompressed;
+    if (flags & BatchCompressed) {
+        decompressed =
+            Common::Compression::DecompressDataZSTD(data, data_size, MaxWifiPacketBatchSize);
+        if (decompressed.empty()) {
+            return false;
+        }
+        data = decompressed.data();
+        data_size = decompressed.size();
+    }
+
+    std::size_t offset = 0;
+    while (offset < data_size) {
+        if (data_size - offset < sizeof(u32)) {
+            return false;
+        }
+        const std::size_t frame_size = (u32{data[offset]} << 24) | (u32{data[offset + 1]} << 16) |
+                                       (u32{data[offset + 2]} << 8) | u32{data[offset + 3]};
+        offset += sizeof(u32);
+        if (data_size - offset < frame_size) {
+            return false;
+        }
+        func(data + offset, frame_size);
+        offset += frame_size;
+    }
+    return true;
+}
+
+} // namespace Network
@@ -0,0 +1,55 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "common/common_types.h"
+#include "network/packet.h"
+
+namespace Network {
+
+/// Maximum size of the frames of a batch, before compression
+constexpr std::size_t MaxWifiPacketBatchSize = 64 * 1024;
+
+/**
+ * Coalesces Wi-Fi frames into a single IdWifiPacketBatch message, for the peers that negotiated
+ * FeatureWifiPacketBatch. Each frame is the body of an IdWifiPacket message, without its message
+ * type, prefixed with its size. The frames of a batch are compressed as a whole with Zstandard
+ * when FeatureCompression was negotiated and it makes the message smaller.
+ */
+class WifiPacketBatch {
+public:
+    /**
+     * Adds a frame to the batch.
+     * @returns false if the batch is too full for the frame, which was not added
+     */
+    bool Append(const u8* frame, std::size_t size);
+
+    bool IsEmpty() const {
+        return frame_count == 0;
+    }
+
+    std::size_t GetFrameCount() const {
+        return frame_count;
+    }
+
+    /// Builds the IdWifiPacketBatch message of the frames added so far, and empties the batch
+    Packet Build(bool compress);
+
+    /**
+     * Calls a function with each frame of a received IdWifiPacketBatch message.
+     * @returns false if the message is malformed, in which case only some frames may have been
+     * passed to the function
+     */
+    static bool ForEachFrame(const u8* message, std::size_t size,
+                             const std::function<void(const u8* frame, std::size_t size)>& func);
+
+private:
+    std::vector<u8> frames;
+    std::size_t frame_count = 0;
+};
+
+} // namespace Network
@@ -0,0 +1,166 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/dsp_kernels.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+using namespace AudioCore;
+
+/// Returns the vectorized kernels supported by the host CPU
+static std::vector<const DspKernels*> GetSimdKernels() {
+    std::vector<const DspKernels*> kernels;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2)
+        kernels.push_back(&sse2_dsp_kernels);
+    if (Common::GetCPUCaps().avx2)
+        kernels.push_back(&avx2_dsp_kernels);
+#endif
+    return kernels;
+}
+
+static StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<s16> sample(std::numeric_limits<s16>::min(),
+                                              std::numeric_limits<s16>::max());
+    StereoFrame16 frame;
+    for (auto& stereo : frame) {
+        stereo = {sample(rng), sample(rng)};
+    }
+    return frame;
+}
+
+/// Intermediate mixes hold sums of many sources, so their samples may exceed 16 bits
+static QuadFrame32 RandomQuadFrame(std::mt19937& rng, s32 range) {
+    std::uniform_int_distribution<s32> sample(-range, range);
+    QuadFrame32 frame;
+    for (auto& quad : frame) {
+        quad = {sample(rng), sample(rng), sample(rng), sample(rng)};
+    }
+    return frame;
+}
+
+/// Mixes stay well within range of floats, even with the largest gains
+constexpr s32 max_mix_sample = 0x7FFFFF;
+
+TEST_CASE("SIMD gain mix matches the scalar one", "[audio_core][hle]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> gain(-4.0f, 4.0f);
+
+    for (const DspKernels* kernels : GetSimdKernels()) {
+        INFO(kernels->name);
+        for (int i = 0; i < 1000; ++i) {
+            const StereoFrame16 stereo = RandomStereoFrame(rng);
+            const std::array<float, 4> gains{gain(rng), gain(rng), gain(rng), gain(rng)};
+            QuadFrame32 expected = RandomQuadFrame(rng, max_mix_sample);
+            QuadFrame32 actual = expected;
+            scalar_dsp_kernels.gain_mix(expected, stereo, gains);
+            kernels->gain_mix(actual, stereo, gains);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("SIMD downmixes match the scalar ones", "[audio_core][hle]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> gain(-4.0f, 4.0f);
+    // Both samples that fit in 16 bits and samples that saturate
+    constexpr std::array<s32, 3> ranges{0x7FFF, 0x7FFFF, max_mix_sample};
+
+    for (const DspKernels* kernels : GetSimdKernels()) {
+        INFO(kernels->name);
+        for (int i = 0; i < 1000; ++i) {
+            const QuadFrame32 quad = RandomQuadFrame(rng, ranges[i % ranges.size()]);
+            const float volume = i % 4 == 0 ? 1.0f : gain(rng);
+            const StereoFrame16 accumulator = RandomStereoFrame(rng);
+
+            StereoFrame16 expected = accumulator;
+            StereoFrame16 actual = accumulator;
+            scalar_dsp_kernels.downmix_stereo(expected, quad, volume);
+            kernels->downmix_stereo(actual, quad, volume);
+            REQUIRE(actual == expected);
+
+            expected = accumulator;
+            actual = accumulator;
+            scalar_dsp_kernels.downmix_mono(expected, quad, volume);
+            kernels->downmix_mono(actual, quad, volume);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("SIMD linear interpolation matches the scalar one", "[audio_core][hle]") {
+    std::mt19937 rng(42);
+
+    for (const DspKernels* kernels : GetSimdKernels()) {
+        INFO(kernels->name);
+        for (int i = 0; i < 1000; ++i) {
+            const StereoFrame16 x0 = RandomStereoFrame(rng);
+            StereoFrame16 x1 = RandomStereoFrame(rng);
+            // Also interpolate between close samples, and at the ends of the fraction range
+            x1[0] = x0[0];
+            x1[1] = {static_cast<s16>(x0[1][0] / 2), static_cast<s16>(x0[1][1] / 2)};
+            std::array<u32, samples_per_frame> fractions;
+            for (auto& fraction : fractions) {
+                fraction = rng() & 0xFFFFFF;
+            }
+            fractions[0] = 0;
+            fractions[2] = 0xFFFFFF;
+            // Counts that are not a multiple of the vector width leave a remainder
+            const std::size_t count = rng() % (samples_per_frame + 1);
+
+            StereoFrame16 expected{};
+            StereoFrame16 actual{};
+            scalar_dsp_kernels.interpolate_linear(x0.data(), x1.data(), fractions.data(),
+                                                  expected.data(), count);
+            kernels->interpolate_linear(x0.data(), x1.data(), fractions.data(), actual.data(),
+                                        count);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("DSP kernels performance", "[audio_core][hle][!benchmark]") {
+    std::mt19937 rng(42);
+    const StereoFrame16 stereo = RandomStereoFrame(rng);
+    const QuadFrame32 quad = RandomQuadFrame(rng, max_mix_sample);
+    const std::array<float, 4> gains{0.5f, 0.5f, 0.25f, 0.25f};
+    std::array<u32, samples_per_frame> fractions;
+    for (auto& fraction : fractions) {
+        fraction = rng() & 0xFFFFFF;
+    }
+
+    std::vector<const DspKernels*> all_kernels{&scalar_dsp_kernels};
+    for (const DspKernels* kernels : GetSimdKernels()) {
+        all_kernels.push_back(kernels);
+    }
+
+    for (const DspKernels* kernels : all_kernels) {
+        QuadFrame32 mix{};
+        StereoFrame16 output{};
+        BENCHMARK(std::string(kernels->name) + ": 24 gain mixes") {
+            for (int i = 0; i < 24; ++i) {
+                kernels->gain_mix(mix, stereo, gains);
+            }
+            return mix[0][0];
+        };
+        BENCHMARK(std::string(kernels->name) + ": downmix") {
+            kernels->downmix_stereo(output, quad, 0.5f);
+            return output[0][0];
+        };
+        BENCHMARK(std::string(kernels->name) + ": 24 linear interpolations") {
+            for (int i = 0; i < 24; ++i) {
+                kernels->interpolate_linear(stereo.data(), stereo.data() + 1, fractions.data(),
+                                            output.data(), samples_per_frame - 1);
+            }
+            return output[0][0];
+        };
+    }
+}
@@ -0,0 +1,148 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/codec.h"
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "core/memory.h"
+
+namespace AudioCore::HLE {
+
+using Configuration = SourceConfiguration::Configuration;
+
+/// Configures a source to play an embedded buffer at the start of FCRAM, mixed unchanged into
+/// the first two channels of the first intermediate mix
+static Configuration MakeConfig(Configuration::Format format, u32 length, float rate,
+                                Configuration::InterpolationMode interpolation_mode,
+                                bool is_looping) {
+    Configuration config{};
+    config.enable = 1;
+    config.enable_dirty.Assign(1);
+    config.rate_multiplier = rate;
+    config.rate_multiplier_dirty.Assign(1);
+    config.interpolation_mode = interpolation_mode;
+    config.interpolation_dirty.Assign(1);
+    config.gain[0][0] = 1.0f;
+    config.gain[0][1] = 1.0f;
+    config.gain_0_dirty.Assign(1);
+    config.format.Assign(format);
+    config.mono_or_stereo.Assign(Configuration::MonoOrStereo::Mono);
+    config.physical_address = Memory::FCRAM_PADDR;
+    config.length = length;
+    config.is_looping.Assign(is_looping ? 1 : 0);
+    config.embedded_buffer_dirty.Assign(1);
+    return config;
+}
+
+TEST_CASE("HLE Source plays buffers larger than its sample buffer", "[audio_core][hle]") {
+    constexpr u32 length = 3000;
+    static_assert(length > StereoBuffer16::capacity);
+
+    Memory::MemorySystem memory;
+    std::vector<s16> samples(length);
+    for (u32 i = 0; i < length; ++i) {
+        samples[i] = static_cast<s16>(i * 7 - 10000);
+    }
+    std::memcpy(memory.GetFCRAMPointer(0), samples.data(), length * sizeof(s16));
+
+    Source source(0);
+    source.SetMemory(memory);
+    Configuration config = MakeConfig(Configuration::Format::PCM16, length, 1.0f,
+                                      Configuration::InterpolationMode::None, false);
+    const s16_le adpcm_coeffs[16]{};
+
+    // Without interpolation, the output is the input delayed by two samples
+    std::vector<s16> output;
+    while (output.size() < length + 2) {
+        source.Tick(config, adpcm_coeffs);
+        QuadFrame32 frame{};
+        source.MixInto(frame, 0);
+        for (const auto& sample : frame) {
+            output.push_back(static_cast<s16>(sample[0]));
+        }
+    }
+    CHECK(output[0] == 0);
+    CHECK(output[1] == 0);
+    // The last two samples stay in the interpolation history, as no other buffer follows
+    for (u32 i = 0; i + 2 < length; ++i) {
+        REQUIRE(output[i + 2] == samples[i]);
+    }
+}
+
+TEST_CASE("ADPCM buffers decode the same in parts", "[audio_core][codec]") {
+    constexpr std::size_t sample_count = 14 * 20 + 5;
+    std::mt19937 random(42);
+    std::vector<u8> data((sample_count + 13) / 14 * 8);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(random() & 0xF7); // Keep the scales reasonable
+    }
+    std::array<s16, 16> coeffs;
+    for (auto& coeff : coeffs) {
+        coeff = static_cast<s16>(static_cast<int>(random() % 4096) - 2048);
+    }
+
+    StereoBuffer16 whole;
+    Codec::ADPCMState whole_state{10, -10};
+    Codec::DecodeADPCM(data.data(), 0, sample_count, coeffs, whole_state, whole);
+
+    // Split in the middle of frames
+    StereoBuffer16 parts;
+    Codec::ADPCMState parts_state{10, -10};
+    Codec::DecodeADPCM(data.data(), 0, 19, coeffs, parts_state, parts);
+    Codec::DecodeADPCM(data.data(), 19, 100, coeffs, parts_state, parts);
+    Codec::DecodeADPCM(data.data(), 119, sample_count - 119, coeffs, parts_state, parts);
+
+    REQUIRE(parts.Size() == sample_count);
+    REQUIRE(whole.Size() == sample_count);
+    for (std::size_t i = 0; i < sample_count; ++i) {
+        REQUIRE(parts[i] == whole[i]);
+    }
+    CHECK(parts_state.yn1 == whole_state.yn1);
+    CHECK(parts_state.yn2 == whole_state.yn2);
+}
+
+TEST_CASE("HLE Source performance", "[audio_core][hle][!benchmark]") {
+    constexpr u32 length = 32728; // One second at the native sample rate
+    constexpr std::array<Configuration::Format, 3> formats{
+        Configuration::Format::ADPCM, Configuration::Format::PCM16, Configuration::Format::PCM8};
+
+    Memory::MemorySystem memory;
+    std::mt19937 random(42);
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    for (u32 i = 0; i < length * sizeof(s16); ++i) {
+        fcram[i] = static_cast<u8>(random());
+    }
+    s16_le adpcm_coeffs[16];
+    for (auto& coeff : adpcm_coeffs) {
+        coeff = static_cast<s16>(static_cast<int>(random() % 2048) - 1024);
+    }
+
+    // All the sources play looping buffers, at rates from 0.5x to 2x, so that none ever stops
+    std::vector<Source> sources;
+    std::vector<Configuration> configs;
+    for (std::size_t i = 0; i < num_sources; ++i) {
+        sources.emplace_back(i);
+        sources.back().SetMemory(memory);
+        configs.push_back(MakeConfig(formats[i % formats.size()], length,
+                                     0.5f + 1.5f * i / (num_sources - 1),
+                                     Configuration::InterpolationMode::Linear, true));
+    }
+
+    QuadFrame32 mix{};
+    BENCHMARK("24 sources, one audio frame") {
+        mix = {};
+        for (std::size_t i = 0; i < num_sources; ++i) {
+            sources[i].Tick(configs[i], adpcm_coeffs);
+            sources[i].MixInto(mix, 0);
+        }
+        return mix[0][0];
+    };
+}
+
+} // namespace AudioCore::HLE
@@ -0,0 +1,105 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/host_memory.h"
+
+namespace Common {
+
+constexpr std::size_t HOST_PAGE_SIZE = 0x1000;
+
+TEST_CASE("HostMemory is zero-initialized", "[common]") {
+    HostMemory memory(4 * HOST_PAGE_SIZE);
+    REQUIRE(memory.GetSize() == 4 * HOST_PAGE_SIZE);
+    for (std::size_t i = 0; i < memory.GetSize(); ++i) {
+        REQUIRE(memory.GetPointer()[i] == 0);
+    }
+}
+
+#ifndef _WIN32
+TEST_CASE("FastmemArena aliases host memory", "[common]") {
+    HostMemory memory(4 * HOST_PAGE_SIZE);
+    FastmemArena arena(nullptr);
+    if (!memory.CanAlias() || !arena.IsValid()) {
+        WARN("Fastmem is not supported on this host");
+        return;
+    }
+
+    constexpr std::size_t offset = 0x08000000;
+    REQUIRE(arena.Map(offset, memory, HOST_PAGE_SIZE, 2 * HOST_PAGE_SIZE));
+    u8* mirror = arena.GetBase() + offset;
+
+    // Writes through either mapping are visible through the other
+    memory.GetPointer()[HOST_PAGE_SIZE + 5] = 0x12;
+    REQUIRE(mirror[5] == 0x12);
+    mirror[HOST_PAGE_SIZE + 7] = 0x34;
+    REQUIRE(memory.GetPointer()[2 * HOST_PAGE_SIZE + 7] == 0x34);
+
+    // Remapping a page replaces the previous mapping
+    REQUIRE(arena.Map(offset, memory, 3 * HOST_PAGE_SIZE, HOST_PAGE_SIZE));
+    memory.GetPointer()[3 * HOST_PAGE_SIZE] = 0x56;
+    REQUIRE(mirror[0] == 0x56);
+
+    // Unmapping leaves the memory itself intact
+    arena.Unmap(offset, 2 * HOST_PAGE_SIZE);
+    REQUIRE(memory.GetPointer()[2 * HOST_PAGE_SIZE + 7] == 0x34);
+}
+#endif
+
+TEST_CASE("HostMemory tracks the pages written", "[common]") {
+    HostMemory memory(8 * HOST_PAGE_SIZE);
+    if (!memory.TrackWrites()) {
+        WARN("Writes can't be tracked on this host");
+        REQUIRE(memory.GetWrittenPages().size() == 8);
+        return;
+    }
+    REQUIRE(memory.GetWrittenPages().empty());
+
+    memory.GetPointer()[HOST_PAGE_SIZE + 1] = 0x12;
+    memory.GetPointer()[HOST_PAGE_SIZE + 2] = 0x34;
+    REQUIRE(memory.GetWrittenPages() == std::vector<std::size_t>{HOST_PAGE_SIZE});
+
+#ifndef _WIN32
+    // Writes through a fastmem arena are tracked as well, reads aren't
+    std::vector<u8*> page_pointers(FastmemArena::ARENA_SIZE / HOST_PAGE_SIZE);
+    FastmemArena arena(page_pointers.data());
+    if (memory.CanAlias() && arena.IsValid()) {
+        constexpr std::size_t offset = 0x08000000;
+        for (std::size_t page = 0; page < 4; ++page) {
+            page_pointers[offset / HOST_PAGE_SIZE + page] =
+                memory.GetPointer() + (4 + page) * HOST_PAGE_SIZE;
+        }
+        REQUIRE(arena.Map(offset, memory, 4 * HOST_PAGE_SIZE, 4 * HOST_PAGE_SIZE));
+        u8* mirror = arena.GetBase() + offset;
+        REQUIRE(mirror[HOST_PAGE_SIZE] == 0);
+        mirror[2 * HOST_PAGE_SIZE + 3] = 0x56;
+        REQUIRE(memory.GetPointer()[6 * HOST_PAGE_SIZE + 3] == 0x56);
+        REQUIRE(memory.GetWrittenPages() ==
+                std::vector<std::size_t>{HOST_PAGE_SIZE, 6 * HOST_PAGE_SIZE});
+    }
+#endif
+
+    // Taking the contents over takes the written pages over too
+    HostMemory other(8 * HOST_PAGE_SIZE);
+    other.TakeContents(memory);
+    REQUIRE(other.GetPointer()[HOST_PAGE_SIZE + 2] == 0x34);
+    const std::vector<std::size_t> written = other.GetWrittenPages();
+    other.GetPointer()[3 * HOST_PAGE_SIZE] = 0x78;
+    std::vector<std::size_t> expected = written;
+    expected.insert(expected.begin() + 1, 3 * HOST_PAGE_SIZE);
+    REQUIRE(other.GetWrittenPages() == expected);
+
+    // Tracking again forgets the pages written so far
+    REQUIRE(other.TrackWrites());
+    REQUIRE(other.GetWrittenPages().empty());
+    REQUIRE(other.GetPointer()[3 * HOST_PAGE_SIZE] == 0x78);
+
+    // Once tracking stops, the memory is writable and all pages count as written
+    other.StopTrackingWrites();
+    other.GetPointer()[5 * HOST_PAGE_SIZE] = 0x9A;
+    REQUIRE(other.GetWrittenPages().size() == 8);
+}
+
+} // namespace Common
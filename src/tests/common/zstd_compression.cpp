@@ -0,0 +1,95 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/zstd_compression.h"
+
+namespace Common::Compression {
+
+static std::vector<u8> GenerateData(std::size_t size) {
+    std::mt19937 rng(1234);
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        // Alternate between random and repetitive data
+        data[i] = (i / 4096) % 2 ? static_cast<u8>(rng()) : static_cast<u8>(i % 7);
+    }
+    return data;
+}
+
+static std::vector<u8> CompressStreamed(const std::vector<u8>& data, std::size_t chunk_size) {
+    std::vector<u8> compressed;
+    ZSTDStreamCompressor compressor([&compressed](const u8* chunk, std::size_t size) {
+        compressed.insert(compressed.end(), chunk, chunk + size);
+        return true;
+    });
+    for (std::size_t pos = 0; pos < data.size(); pos += chunk_size) {
+        REQUIRE(compressor.Write(data.data() + pos, std::min(chunk_size, data.size() - pos)));
+    }
+    REQUIRE(compressor.Finish());
+    return compressed;
+}
+
+static ZSTDStreamDecompressor::Source MakeSource(const std::vector<u8>& compressed,
+                                                 std::size_t& pos) {
+    return [&compressed, &pos](u8* chunk, std::size_t size) {
+        size = std::min(size, compressed.size() - pos);
+        std::memcpy(chunk, compressed.data() + pos, size);
+        pos += size;
+        return size;
+    };
+}
+
+TEST_CASE("ZSTD streaming round trip", "[common][zstd]") {
+    const auto data = GenerateData(4 * 1024 * 1024 + 123);
+    const auto compressed = CompressStreamed(data, 100000);
+    REQUIRE(compressed.size() < data.size());
+
+    std::size_t pos = 0;
+    ZSTDStreamDecompressor decompressor(MakeSource(compressed, pos));
+    std::vector<u8> decompressed(data.size() + 1);
+    std::size_t size = 0;
+    std::size_t read;
+    do {
+        const std::size_t chunk_size = std::min<std::size_t>(77777, decompressed.size() - size);
+        read = decompressor.Read(decompressed.data() + size, chunk_size);
+        size += read;
+    } while (read != 0);
+    REQUIRE_FALSE(decompressor.IsFailed());
+    REQUIRE(size == data.size());
+    decompressed.resize(size);
+    REQUIRE(decompressed == data);
+}
+
+TEST_CASE("ZSTD streaming detects truncated data", "[common][zstd]") {
+    const auto data = GenerateData(1024 * 1024);
+    auto compressed = CompressStreamed(data, data.size());
+    compressed.resize(compressed.size() / 2);
+
+    std::size_t pos = 0;
+    ZSTDStreamDecompressor decompressor(MakeSource(compressed, pos));
+    std::vector<u8> decompressed(data.size());
+    REQUIRE(decompressor.Read(decompressed.data(), decompressed.size()) < data.size());
+    REQUIRE(decompressor.IsFailed());
+}
+
+TEST_CASE("ZSTD streaming detects damaged data", "[common][zstd]") {
+    // Random data is stored as is, so that only the checksum can catch a flipped bit
+    std::mt19937 rng(1234);
+    std::vector<u8> data(1024 * 1024);
+    std::generate(data.begin(), data.end(), [&rng] { return static_cast<u8>(rng()); });
+    auto compressed = CompressStreamed(data, data.size());
+    compressed[compressed.size() / 2] ^= 0x01;
+
+    std::size_t pos = 0;
+    ZSTDStreamDecompressor decompressor(MakeSource(compressed, pos));
+    std::vector<u8> decompressed(data.size());
+    decompressor.Read(decompressed.data(), decompressed.size());
+    REQUIRE(decompressor.IsFailed());
+}
+
+} // namespace Common::Compression
@@ -0,0 +1,42 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/core.h"
+#include "core/guest_profiler.h"
+
+namespace Core {
+
+TEST_CASE("GuestProfiler attributes samples to modules", "[core]") {
+    // A zero interval leaves sampling to the test
+    GuestProfiler profiler(System::GetInstance(), 0, 0);
+    profiler.SetModules({{"bar cro", 0x00800000, 0x1000}, {"main", 0x00100000, 0x2000}});
+
+    for (int i = 0; i < 3; ++i) {
+        profiler.AddSample(0x00100010, 0x00800021);
+    }
+    profiler.AddSample(0x00100010, 0x00800020);
+    profiler.AddSample(0x00102000, 0);
+
+    const auto stacks = profiler.GetStacks();
+    REQUIRE(stacks.size() == 2);
+    // The Thumb bit of LR is ignored, and module names are usable as frame names
+    CHECK(stacks[0].caller.module == "bar_cro");
+    CHECK(stacks[0].caller.offset == 0x20);
+    CHECK(stacks[0].callee.module == "main");
+    CHECK(stacks[0].callee.offset == 0x10);
+    CHECK(stacks[0].count == 4);
+    // Addresses outside of the modules are kept as they are
+    CHECK(stacks[1].caller.module == "[unknown]");
+    CHECK(stacks[1].callee.module == "[unknown]");
+    CHECK(stacks[1].callee.offset == 0x00102000);
+
+    CHECK(GuestProfiler::FormatCollapsed(stacks) ==
+          "bar_cro+0x20;main+0x10 4\n[unknown]+0x0;[unknown]+0x102000 1\n");
+
+    profiler.Reset();
+    CHECK(profiler.GetStacks().empty());
+}
+
+} // namespace Core
@@ -383,4 +383,48 @@ TEST_CASE("HLERequestContext::WriteToOutgoingCommandBuffer", "[core][kernel]") {
     }
 }
 
+TEST_CASE("HLE request round trip performance", "[core][kernel][!benchmark]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    // Not a structured binding, as it is captured by the benchmark
+    const auto session_pair = kernel.CreateSessionPair();
+    const auto& server = session_pair.first;
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    auto mem = std::make_shared<BufferMem>(Memory::PAGE_SIZE);
+    MemoryRef buffer{mem};
+    VAddr buffer_address = 0x10000000;
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(buffer_address, buffer, buffer.GetSize(), MemoryState::Private)
+                .Code() == RESULT_SUCCESS);
+
+    // Mirrors what ServerSession::HandleSyncRequest does for each svcSendSyncRequest to an HLE
+    // service: translate the request, let the service reply with a static buffer, translate the
+    // reply back.
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buf{};
+    BENCHMARK("Request with a static buffer") {
+        cmd_buf[0] = IPC::MakeHeader(0x1234, 1, 2);
+        cmd_buf[1] = 0x12345678;
+        cmd_buf[2] = IPC::StaticBufferDesc(0x100, 0);
+        cmd_buf[3] = buffer_address;
+        cmd_buf[IPC::COMMAND_BUFFER_LENGTH] = IPC::StaticBufferDesc(0x100, 0);
+        cmd_buf[IPC::COMMAND_BUFFER_LENGTH + 1] = buffer_address;
+
+        auto context = std::make_shared<HLERequestContext>(kernel, server, nullptr);
+        context->PopulateFromIncomingCommandBuffer(cmd_buf.data(), process);
+
+        u32* reply = context->CommandBuffer();
+        reply[0] = IPC::MakeHeader(0x1234, 1, 2);
+        reply[1] = RESULT_SUCCESS.raw;
+        reply[2] = IPC::StaticBufferDesc(0x100, 0);
+        reply[3] = buffer_address;
+        context->AddStaticBuffer(0, std::vector<u8>(context->GetStaticBuffer(0)));
+
+        context->WriteToOutgoingCommandBuffer(cmd_buf.data(), *process);
+        return cmd_buf[1];
+    };
+}
+
 } // namespace Kernel
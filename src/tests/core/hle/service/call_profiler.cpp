@@ -0,0 +1,40 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/hle/ipc.h"
+#include "core/hle/service/call_profiler.h"
+
+namespace Service {
+
+TEST_CASE("CallProfiler records calls per service function", "[core][service]") {
+    CallProfiler profiler(0);
+    int service_a, service_b;
+
+    const u32 request[]{IPC::MakeHeader(0x1, 1, 2), 0, IPC::StaticBufferDesc(0x100, 0), 0};
+    const u32 reply[]{IPC::MakeHeader(0x1, 2, 0), 0, 0};
+    for (int i = 0; i < 3; ++i) {
+        profiler.EndCall(profiler.BeginCall(&service_a, "a", "Function1", request), reply);
+    }
+    profiler.EndCall(profiler.BeginCall(&service_b, "b", "Function1", request), reply);
+
+    const auto stats = profiler.GetStats();
+    REQUIRE(stats.size() == 2);
+    const auto& a = stats[0].service == "a" ? stats[0] : stats[1];
+    CHECK(a.function == "Function1");
+    CHECK(a.header == IPC::MakeHeader(0x1, 1, 2));
+    CHECK(a.calls == 3);
+    CHECK(a.p50_ns <= a.p99_ns);
+    // Request: 4 words and a 0x100 byte static buffer, reply: 3 words
+    CHECK(a.bytes == 3 * (4 * 4 + 0x100 + 3 * 4));
+
+    const std::string csv = CallProfiler::FormatCSV(stats);
+    CHECK(csv.rfind("service,function,header,calls,", 0) == 0);
+    CHECK(csv.find("a,Function1,0x00010042,3,") != std::string::npos);
+
+    profiler.Reset();
+    CHECK(profiler.GetStats().empty());
+}
+
+} // namespace Service
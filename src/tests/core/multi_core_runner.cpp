@@ -0,0 +1,51 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "core/multi_core_runner.h"
+
+TEST_CASE("MultiCoreRunner runs each core on its own thread", "[core]") {
+    constexpr std::size_t NUM_CORES = 4;
+    Core::MultiCoreRunner runner(NUM_CORES);
+    const std::thread::id cpu_thread = std::this_thread::get_id();
+
+    for (int slice = 0; slice < 100; ++slice) {
+        std::array<std::thread::id, NUM_CORES> threads{};
+        std::atomic<std::size_t> ran{0};
+        runner.RunSlice([&](std::size_t core_id) {
+            threads[core_id] = std::this_thread::get_id();
+            ++ran;
+        });
+
+        REQUIRE(ran == NUM_CORES);
+        REQUIRE(threads[0] == cpu_thread);
+        for (std::size_t i = 1; i < NUM_CORES; ++i) {
+            REQUIRE(threads[i] != cpu_thread);
+            REQUIRE(threads[i] != threads[i - 1]);
+        }
+    }
+}
+
+TEST_CASE("MultiCoreRunner defers system calls made during a slice", "[core]") {
+    Core::MultiCoreRunner runner(2);
+
+    // Outside of a slice system calls are executed right away
+    REQUIRE_FALSE(runner.DeferSVC(0x32).has_value());
+
+    std::array<std::optional<std::size_t>, 2> deferred_by{};
+    runner.RunSlice([&](std::size_t core_id) {
+        if (core_id == 1) {
+            deferred_by[core_id] = runner.DeferSVC(0x0A);
+        }
+    });
+
+    REQUIRE(deferred_by[1] == 1);
+    REQUIRE_FALSE(runner.TakePendingSVC(0).has_value());
+    REQUIRE(runner.TakePendingSVC(1) == 0x0Au);
+    REQUIRE_FALSE(runner.TakePendingSVC(1).has_value());
+}
@@ -0,0 +1,235 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/timing_wheel.h"
+
+namespace {
+
+struct TestEvent {
+    s64 time;
+    u64 fifo_order;
+    u64 userdata;
+
+    bool operator<(const TestEvent& right) const {
+        return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
+    }
+    bool operator>(const TestEvent& right) const {
+        return right < *this;
+    }
+};
+
+/// The binary heap Core::Timing used before the timing wheel, as reference and baseline
+class HeapQueue {
+public:
+    void Insert(const TestEvent& event) {
+        events.push_back(event);
+        std::push_heap(events.begin(), events.end(), std::greater<>());
+    }
+
+    TestEvent Pop() {
+        std::pop_heap(events.begin(), events.end(), std::greater<>());
+        const TestEvent event = events.back();
+        events.pop_back();
+        return event;
+    }
+
+    void Remove(u64 userdata) {
+        const auto it = std::remove_if(events.begin(), events.end(), [userdata](const auto& e) {
+            return e.userdata == userdata;
+        });
+        if (it != events.end()) {
+            events.erase(it, events.end());
+            std::make_heap(events.begin(), events.end(), std::greater<>());
+        }
+    }
+
+    bool Empty() const {
+        return events.empty();
+    }
+
+    s64 NextTime() const {
+        return events.front().time;
+    }
+
+private:
+    std::vector<TestEvent> events;
+};
+
+/// Adapts the timing wheel to the interface of HeapQueue, keeping the handle of each event
+class WheelQueue {
+public:
+    void Insert(const TestEvent& event) {
+        if (event.userdata >= handles.size()) {
+            handles.resize(event.userdata + 1);
+        }
+        handles[event.userdata] = wheel.Insert(event);
+    }
+
+    TestEvent Pop() {
+        const TestEvent event = wheel.Pop();
+        wheel.SetTime(event.time);
+        return event;
+    }
+
+    void Remove(u64 userdata) {
+        wheel.Remove(handles[userdata]);
+    }
+
+private:
+    Core::TimingWheel<TestEvent> wheel;
+    std::vector<Core::TimingWheelHandle> handles;
+};
+
+/**
+ * Synthetic event mix resembling the emulator: a few periodic events (vblank, HID, DSP) which
+ * reschedule themselves, plus kernel timers and thread wakeups that are often cancelled before
+ * they fire.
+ */
+template <typename Queue>
+u64 RunEventMix(u32 iterations) {
+    constexpr std::array<s64, 3> periods{4481136, 1145777, 160000};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<s64> delay(1000, 20000000);
+    std::uniform_int_distribution<int> action(0, 3);
+
+    Queue queue;
+    s64 now = 0;
+    u64 fifo = 0;
+    u64 checksum = 0;
+    for (u64 i = 0; i < periods.size(); ++i) {
+        queue.Insert(TestEvent{periods[i], fifo++, i});
+    }
+
+    u64 next_timer = periods.size();
+    for (u32 i = 0; i < iterations; ++i) {
+        if (action(rng) == 0) {
+            // Arm a timer and cancel an older one
+            queue.Insert(TestEvent{now + delay(rng), fifo++, next_timer});
+            if (next_timer >= periods.size() + 8) {
+                queue.Remove(next_timer - 8);
+            }
+            ++next_timer;
+            continue;
+        }
+
+        const TestEvent event = queue.Pop();
+        now = event.time;
+        checksum = checksum * 31 + event.userdata;
+        if (event.userdata < periods.size()) {
+            queue.Insert(TestEvent{now + periods[event.userdata], fifo++, event.userdata});
+        }
+    }
+    return checksum;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TimingWheel orders events by time and FIFO", "[core][timing_wheel]") {
+    Core::TimingWheel<TestEvent> wheel;
+    wheel.Insert({1000, 0, 0});
+    wheel.Insert({500, 1, 1});
+    wheel.Insert({1000, 2, 2});
+    wheel.Insert({std::numeric_limits<s64>::max(), 3, 3});
+    wheel.Insert({1000, 4, 4});
+    wheel.Insert({-20, 5, 5});
+
+    for (const u64 expected : {5, 1, 0, 2, 4, 3}) {
+        REQUIRE(wheel.Pop().userdata == expected);
+    }
+    REQUIRE(wheel.Empty());
+    REQUIRE(wheel.Peek() == nullptr);
+}
+
+TEST_CASE("TimingWheel removes events through handles", "[core][timing_wheel]") {
+    Core::TimingWheel<TestEvent> wheel;
+    const auto a = wheel.Insert({100, 0, 0});
+    const auto b = wheel.Insert({100000, 1, 1});
+    wheel.Insert({100, 2, 2});
+
+    REQUIRE(wheel.Remove(a));
+    REQUIRE_FALSE(wheel.Remove(a));
+    REQUIRE_FALSE(wheel.Remove({}));
+    REQUIRE(wheel.Pop().userdata == 2);
+
+    // The node of a is reused, the stale handle must not remove the new event
+    wheel.Insert({200, 3, 3});
+    REQUIRE_FALSE(wheel.Remove(a));
+    REQUIRE(wheel.Remove(b));
+    REQUIRE(wheel.Size() == 1);
+
+    REQUIRE(wheel.RemoveIf([](const TestEvent& e) { return e.userdata == 3; }) == 1);
+    REQUIRE(wheel.Empty());
+}
+
+TEST_CASE("TimingWheel matches a binary heap", "[core][timing_wheel]") {
+    Core::TimingWheel<TestEvent> wheel;
+    HeapQueue heap;
+    std::vector<Core::TimingWheelHandle> handles;
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<s64> delay(-100, 1 << 24);
+    std::uniform_int_distribution<int> action(0, 9);
+
+    s64 now = 0;
+    u64 fifo = 0;
+    for (int i = 0; i < 200000; ++i) {
+        const int choice = action(rng);
+        if (choice < 4 || heap.Empty()) {
+            // Small delays make events share a time now and then
+            const s64 time = now + (choice == 0 ? delay(rng) % 4 : delay(rng));
+            const TestEvent event{time, fifo++, handles.size()};
+            handles.push_back(wheel.Insert(event));
+            heap.Insert(event);
+        } else if (choice == 4) {
+            const u64 victim = std::uniform_int_distribution<u64>(0, handles.size() - 1)(rng);
+            wheel.Remove(handles[victim]);
+            heap.Remove(victim);
+        } else {
+            REQUIRE(wheel.Peek()->time == heap.NextTime());
+            const TestEvent expected = heap.Pop();
+            const TestEvent event = wheel.Pop();
+            REQUIRE(event.userdata == expected.userdata);
+            now = std::max(now, event.time);
+            wheel.SetTime(now);
+        }
+    }
+}
+
+TEST_CASE("TimingWheel restores its events", "[core][timing_wheel]") {
+    Core::TimingWheel<TestEvent> wheel;
+    for (u64 i = 0; i < 100; ++i) {
+        wheel.Insert({static_cast<s64>((i * 7919) % 1000) * 1000, i, i});
+    }
+    const auto events = wheel.GetEvents();
+    REQUIRE(std::is_sorted(events.begin(), events.end()));
+
+    Core::TimingWheel<TestEvent> restored;
+    for (auto it = events.rbegin(); it != events.rend(); ++it) {
+        restored.Insert(*it);
+    }
+    while (!wheel.Empty()) {
+        REQUIRE(wheel.Pop().userdata == restored.Pop().userdata);
+    }
+}
+
+TEST_CASE("TimingWheel performance", "[core][timing_wheel][!benchmark]") {
+    constexpr u32 ITERATIONS = 100000;
+    REQUIRE(RunEventMix<HeapQueue>(ITERATIONS) == RunEventMix<WheelQueue>(ITERATIONS));
+
+    BENCHMARK("Binary heap") {
+        return RunEventMix<HeapQueue>(ITERATIONS);
+    };
+
+    BENCHMARK("Timing wheel") {
+        return RunEventMix<WheelQueue>(ITERATIONS);
+    };
+}
@@ -0,0 +1,337 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "enet/enet.h"
+#include "network/packet.h"
+#include "network/room.h"
+#include "network/room_member.h"
+#include "network/verify_user.h"
+
+namespace Network {
+
+using Clock = std::chrono::steady_clock;
+
+/// A bare room client. The load generator drives all of them from a single thread, so that the
+/// latency of RoomMember's network loop doesn't end up in the measurements.
+struct LoadClient {
+    ENetHost* host = nullptr;
+    ENetPeer* peer = nullptr;
+    MacAddress mac_address{};
+    /// The protocol features of the join answer, if the room sent any
+    std::optional<u32> features;
+};
+
+/// Joins a room, with the given protocol features, or as a member from before protocol features
+static LoadClient JoinRoom(u16 port, std::size_t index,
+                           std::optional<u32> requested_features = std::nullopt) {
+    LoadClient client;
+    client.host = enet_host_create(nullptr, 1, NumChannels, 0, 0);
+    REQUIRE(client.host != nullptr);
+    ENetAddress address;
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = port;
+    client.peer = enet_host_connect(client.host, &address, NumChannels, 0);
+
+    ENetEvent event;
+    REQUIRE(enet_host_service(client.host, &event, 5000) > 0);
+    REQUIRE(event.type == ENET_EVENT_TYPE_CONNECT);
+
+    Packet packet;
+    packet << static_cast<u8>(IdJoinRequest);
+    packet << fmt::format("load{}", index);
+    packet << fmt::format("console{}", index);
+    packet << NoPreferredMac;
+    packet << network_version;
+    packet << std::string{}; // Password
+    packet << std::string{}; // Token
+    if (requested_features) {
+        packet << *requested_features;
+    }
+    enet_peer_send(client.peer, 0,
+                   enet_packet_create(packet.GetData(), packet.GetDataSize(),
+                                      ENET_PACKET_FLAG_RELIABLE));
+    enet_host_flush(client.host);
+
+    // Room information and status messages come before the join success
+    bool joined = false;
+    while (!joined && enet_host_service(client.host, &event, 5000) > 0) {
+        if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+            continue;
+        }
+        const u8 type = event.packet->data[0];
+        if (type == IdJoinSuccess || type == IdJoinSuccessAsMod) {
+            Packet answer;
+            answer.Append(event.packet->data, event.packet->dataLength);
+            answer.IgnoreBytes(sizeof(u8)); // Message type
+            answer >> client.mac_address;
+            u32 features;
+            answer >> features;
+            if (answer) {
+                client.features = features;
+            }
+            joined = true;
+        }
+        enet_packet_destroy(event.packet);
+    }
+    REQUIRE(joined);
+    return client;
+}
+
+TEST_CASE("Rooms on a worker pool share their ban list", "[network]") {
+    constexpr u16 port = 24874;
+
+    REQUIRE(enet_initialize() == 0);
+    auto worker_pool = std::make_shared<RoomWorkerPool>(1);
+    auto ban_list = std::make_shared<Room::SharedBanList>();
+    std::shared_ptr<VerifyUser::Backend> verify_backend =
+        std::make_shared<VerifyUser::NullBackend>();
+    Room room_a, room_b;
+    for (Room* room : {&room_a, &room_b}) {
+        room->SetSharedBanList(ban_list);
+        room->SetWorkerPool(worker_pool);
+    }
+    REQUIRE(room_a.Create("A", "", "127.0.0.1", port, "", 4, "", "", 0, verify_backend,
+                          {{"banned"}, {}}));
+    REQUIRE(room_b.Create("B", "", "127.0.0.1", port + 1, "", 4, "", "", 0, verify_backend));
+    CHECK(room_b.GetBanList().first == Room::UsernameBanList{"banned"});
+
+    // Rooms on the same thread relay packets independently
+    LoadClient sender = JoinRoom(port + 1, 0);
+    LoadClient receiver = JoinRoom(port + 1, 1);
+    Packet packet;
+    packet << static_cast<u8>(IdWifiPacket);
+    packet << static_cast<u8>(WifiPacket::PacketType::Data);
+    packet << u8{1}; // Channel
+    packet << sender.mac_address;
+    packet << receiver.mac_address;
+    packet << std::vector<u8>(16);
+    enet_peer_send(sender.peer, 0,
+                   enet_packet_create(packet.GetData(), packet.GetDataSize(),
+                                      ENET_PACKET_FLAG_RELIABLE));
+    enet_host_flush(sender.host);
+
+    bool received = false;
+    ENetEvent event;
+    while (!received && enet_host_service(receiver.host, &event, 5000) > 0) {
+        if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+            received = event.packet->data[0] == IdWifiPacket;
+            enet_packet_destroy(event.packet);
+        }
+    }
+    CHECK(received);
+
+    const Room::Stats stats = room_b.GetStats();
+    CHECK(stats.members == 2);
+    CHECK(stats.packets_relayed == 1);
+    CHECK(stats.bytes_relayed == packet.GetDataSize());
+    CHECK(room_a.GetStats().packets_received == 0);
+
+    enet_host_destroy(sender.host);
+    enet_host_destroy(receiver.host);
+    room_a.Destroy();
+    room_b.Destroy();
+    enet_deinitialize();
+}
+
+TEST_CASE("Rooms only negotiate protocol features with members that request them", "[network]") {
+    constexpr u16 port = 24876;
+
+    REQUIRE(enet_initialize() == 0);
+    Room room;
+    REQUIRE(room.Create("Negotiation", "", "127.0.0.1", port, "", 4, "", "", 0,
+                        std::make_unique<VerifyUser::NullBackend>()));
+
+    LoadClient old_member = JoinRoom(port, 0);
+    LoadClient new_member = JoinRoom(port, 1, SupportedProtocolFeatures);
+    CHECK(old_member.features == 0u);
+    CHECK(new_member.features == SupportedProtocolFeatures);
+
+    // Frames to the old member are never batched
+    Packet packet;
+    packet << static_cast<u8>(IdWifiPacket);
+    packet << static_cast<u8>(WifiPacket::PacketType::Data);
+    packet << u8{1}; // Channel
+    packet << new_member.mac_address;
+    packet << old_member.mac_address;
+    packet << std::vector<u8>(16);
+    enet_peer_send(new_member.peer, 0,
+                   enet_packet_create(packet.GetData(), packet.GetDataSize(),
+                                      ENET_PACKET_FLAG_RELIABLE));
+    enet_host_flush(new_member.host);
+
+    u8 received_type = 0;
+    ENetEvent event;
+    while (received_type == 0 && enet_host_service(old_member.host, &event, 5000) > 0) {
+        if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+            const u8 type = event.packet->data[0];
+            if (type == IdWifiPacket || type == IdWifiPacketBatch) {
+                received_type = type;
+            }
+            enet_packet_destroy(event.packet);
+        }
+    }
+    CHECK(received_type == IdWifiPacket);
+
+    enet_host_destroy(old_member.host);
+    enet_host_destroy(new_member.host);
+    room.Destroy();
+    enet_deinitialize();
+}
+
+TEST_CASE("Members do not negotiate protocol features with old rooms", "[network]") {
+    constexpr u16 port = 24877;
+
+    REQUIRE(enet_initialize() == 0);
+    ENetAddress address{};
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = port;
+    ENetHost* const server = enet_host_create(&address, 1, NumChannels, 0, 0);
+    REQUIRE(server != nullptr);
+
+    // A room from before protocol features, which answers join requests with the MAC address only
+    std::atomic<bool> stop{false};
+    std::atomic<u8> received_type{0};
+    std::thread old_room([&] {
+        ENetEvent event;
+        while (!stop) {
+            if (enet_host_service(server, &event, 10) <= 0 ||
+                event.type != ENET_EVENT_TYPE_RECEIVE) {
+                continue;
+            }
+            const u8 type = event.packet->data[0];
+            if (type == IdJoinRequest) {
+                Packet answer;
+                answer << static_cast<u8>(IdJoinSuccess);
+                answer << MacAddress{0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+                enet_peer_send(event.peer, 0,
+                               enet_packet_create(answer.GetData(), answer.GetDataSize(),
+                                                  ENET_PACKET_FLAG_RELIABLE));
+            } else if (type == IdWifiPacket || type == IdWifiPacketBatch) {
+                received_type = type;
+            }
+            enet_packet_destroy(event.packet);
+        }
+    });
+
+    RoomMember member;
+    member.Join("member", "", "127.0.0.1", port);
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (member.GetState() != RoomMember::State::Joined && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(member.GetState() == RoomMember::State::Joined);
+
+    WifiPacket wifi_packet{};
+    wifi_packet.type = WifiPacket::PacketType::Data;
+    wifi_packet.channel = 1;
+    wifi_packet.destination_address = BroadcastMac;
+    wifi_packet.data.resize(16);
+    member.SendWifiPacket(wifi_packet);
+    while (received_type == 0 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(received_type == IdWifiPacket);
+
+    member.Leave();
+    stop = true;
+    old_room.join();
+    enet_host_destroy(server);
+    enet_deinitialize();
+}
+
+TEST_CASE("Room Wi-Fi packet relay performance", "[network][!benchmark]") {
+    constexpr u16 port = 24873;
+    constexpr std::size_t num_clients = 16;
+    constexpr std::size_t packets_per_client = 4000;
+    constexpr std::size_t payload_size = 512;
+    /// Packets a client sends before waiting for the previous ones to be received
+    constexpr std::size_t window = 16;
+    /// Offset of the payload: message type, WifiPacket type and channel, addresses, payload size
+    constexpr std::size_t payload_offset = 3 * sizeof(u8) + 2 * sizeof(MacAddress) + sizeof(u32);
+
+    REQUIRE(enet_initialize() == 0);
+    Room room;
+    REQUIRE(room.Create("Benchmark", "", "127.0.0.1", port, "", num_clients, "", "", 0,
+                        std::make_unique<VerifyUser::NullBackend>()));
+
+    std::vector<LoadClient> clients;
+    for (std::size_t i = 0; i < num_clients; ++i) {
+        clients.push_back(JoinRoom(port, i));
+    }
+
+    // Each client sends packets to the next one, stamped with the time they are sent at
+    std::vector<std::size_t> sent(num_clients);
+    std::vector<std::size_t> received(num_clients);
+    std::vector<s64> latencies_ns;
+    latencies_ns.reserve(num_clients * packets_per_client);
+    std::vector<u8> payload(payload_size);
+
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::seconds(60);
+    while (latencies_ns.size() < num_clients * packets_per_client && Clock::now() < deadline) {
+        for (std::size_t i = 0; i < num_clients; ++i) {
+            const std::size_t destination = (i + 1) % num_clients;
+            while (sent[i] < packets_per_client && sent[i] - received[destination] < window) {
+                const s64 timestamp = (Clock::now() - start).count();
+                std::memcpy(payload.data(), &timestamp, sizeof(timestamp));
+
+                Packet packet;
+                packet << static_cast<u8>(IdWifiPacket);
+                packet << static_cast<u8>(WifiPacket::PacketType::Data);
+                packet << u8{1}; // Channel
+                packet << clients[i].mac_address;
+                packet << clients[destination].mac_address;
+                packet << payload;
+                enet_peer_send(clients[i].peer, 0,
+                               enet_packet_create(packet.GetData(), packet.GetDataSize(),
+                                                  ENET_PACKET_FLAG_RELIABLE));
+                ++sent[i];
+            }
+            enet_host_flush(clients[i].host);
+        }
+
+        for (std::size_t i = 0; i < num_clients; ++i) {
+            ENetEvent event;
+            while (enet_host_service(clients[i].host, &event, 0) > 0) {
+                if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+                    continue;
+                }
+                if (event.packet->data[0] == IdWifiPacket &&
+                    event.packet->dataLength >= payload_offset + sizeof(s64)) {
+                    s64 timestamp;
+                    std::memcpy(&timestamp, event.packet->data + payload_offset,
+                                sizeof(timestamp));
+                    latencies_ns.push_back((Clock::now() - start).count() - timestamp);
+                    ++received[i];
+                }
+                enet_packet_destroy(event.packet);
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (const LoadClient& client : clients) {
+        enet_host_destroy(client.host);
+    }
+    room.Destroy();
+    enet_deinitialize();
+
+    REQUIRE(latencies_ns.size() == num_clients * packets_per_client);
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    const s64 p99_ns = latencies_ns[latencies_ns.size() * 99 / 100];
+    WARN(fmt::format("{} clients, {} byte payloads: {:.0f} packets/s, p99 relay latency {} us",
+                     num_clients, payload_size, latencies_ns.size() / seconds, p99_ns / 1000));
+}
+
+} // namespace Network
@@ -0,0 +1,73 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/room.h"
+#include "network/wifi_packet_batch.h"
+
+namespace Network {
+
+static std::vector<std::vector<u8>> ReadFrames(const Packet& packet, bool& valid) {
+    std::vector<std::vector<u8>> frames;
+    valid = WifiPacketBatch::ForEachFrame(
+        static_cast<const u8*>(packet.GetData()), packet.GetDataSize(),
+        [&frames](const u8* frame, std::size_t size) { frames.emplace_back(frame, frame + size); });
+    return frames;
+}
+
+TEST_CASE("WifiPacketBatch round trips frames", "[network]") {
+    const std::vector<u8> beacon(40, 0xAB);
+    const std::vector<u8> data_frame{1, 2, 3, 4, 5};
+
+    for (const bool compress : {false, true}) {
+        WifiPacketBatch batch;
+        CHECK(batch.IsEmpty());
+        for (int i = 0; i < 8; ++i) {
+            REQUIRE(batch.Append(beacon.data(), beacon.size()));
+        }
+        REQUIRE(batch.Append(data_frame.data(), data_frame.size()));
+        CHECK(batch.GetFrameCount() == 9);
+
+        const Packet packet = batch.Build(compress);
+        CHECK(batch.IsEmpty());
+        CHECK(static_cast<const u8*>(packet.GetData())[0] == IdWifiPacketBatch);
+        const std::size_t uncompressed_size = 2 + 8 * (4 + beacon.size()) + 4 + data_frame.size();
+        if (compress) {
+            CHECK(packet.GetDataSize() < uncompressed_size);
+        } else {
+            CHECK(packet.GetDataSize() == uncompressed_size);
+        }
+
+        bool valid = false;
+        const auto frames = ReadFrames(packet, valid);
+        CHECK(valid);
+        REQUIRE(frames.size() == 9);
+        CHECK(frames[0] == beacon);
+        CHECK(frames[8] == data_frame);
+    }
+}
+
+TEST_CASE("WifiPacketBatch rejects invalid batches", "[network]") {
+    WifiPacketBatch batch;
+    const std::vector<u8> frame(MaxWifiPacketBatchSize / 2);
+    REQUIRE(batch.Append(frame.data(), frame.size()));
+    CHECK_FALSE(batch.Append(frame.data(), frame.size()));
+
+    const Packet packet = batch.Build(false);
+    Packet truncated;
+    truncated.Append(packet.GetData(), packet.GetDataSize() - 1);
+    bool valid = true;
+    CHECK(ReadFrames(truncated, valid).empty());
+    CHECK_FALSE(valid);
+
+    Packet corrupted;
+    corrupted << static_cast<u8>(IdWifiPacketBatch);
+    corrupted << u8{1}; // Compressed
+    corrupted << u32{0xDEADBEEF};
+    CHECK(ReadFrames(corrupted, valid).empty());
+    CHECK_FALSE(valid);
+}
+
+} // namespace Network
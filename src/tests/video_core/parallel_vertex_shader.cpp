@@ -0,0 +1,237 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "core/memory.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/parallel_vertex_shader.h"
+#include "video_core/regs_pipeline.h"
+#include "video_core/regs_rasterizer.h"
+#include "video_core/regs_shader.h"
+#include "video_core/shader/shader_interpreter.h"
+#include "video_core/vertex_loader.h"
+#include "video_core/video_core.h"
+
+using Pica::PipelineRegs;
+using Pica::RasterizerRegs;
+using Pica::ShaderRegs;
+using Pica::Shader::AttributeBuffer;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+constexpr u32 NUM_VERTICES = 1000;
+
+static PipelineRegs SetupAttributes(PAddr base_address) {
+    PipelineRegs regs{};
+    auto& attributes = regs.vertex_attributes;
+    attributes.base_address.Assign(base_address / 16);
+
+    // Attribute 0: 4 floats, attribute 1: 4 unsigned bytes
+    attributes.format0.Assign(PipelineRegs::VertexAttributeFormat::FLOAT);
+    attributes.size0.Assign(3);
+    attributes.format1.Assign(PipelineRegs::VertexAttributeFormat::UBYTE);
+    attributes.size1.Assign(3);
+    attributes.attribute_loaders[0].data_offset.Assign(0);
+    attributes.attribute_loaders[0].comp0.Assign(0);
+    attributes.attribute_loaders[0].comp1.Assign(1);
+    attributes.attribute_loaders[0].component_count.Assign(2);
+    attributes.attribute_loaders[0].byte_count.Assign(20);
+    attributes.max_attribute_index.Assign(1);
+    return regs;
+}
+
+static void LoadProgram(Pica::Shader::ShaderSetup& setup,
+                        std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+    std::transform(shbin.program.begin(), shbin.program.end(), setup.program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   setup.swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    setup.MarkProgramCodeDirty();
+    setup.MarkSwizzleDataDirty();
+}
+
+static void SetupShader(Pica::Shader::ShaderSetup& setup, ShaderRegs& config) {
+    // clang-format off
+    LoadProgram(setup, {
+        {OpCode::Id::MUL, DestRegister::MakeOutput(0), SourceRegister::MakeInput(0),
+                          SourceRegister::MakeInput(1)},
+        {OpCode::Id::ADD, DestRegister::MakeOutput(1), SourceRegister::MakeInput(0),
+                          SourceRegister::MakeInput(1)},
+        {OpCode::Id::END},
+    });
+    // clang-format on
+
+    config = {};
+    config.max_input_attribute_index.Assign(1);
+    config.input_attribute_to_register_map_low = 0x10;
+    config.output_mask.Assign(0b11);
+}
+
+static std::vector<AttributeBuffer> ShadeSerially(const Pica::Shader::ShaderEngine& engine,
+                                                  const Pica::Shader::ShaderSetup& setup,
+                                                  const ShaderRegs& config,
+                                                  const PipelineRegs& regs,
+                                                  const std::vector<u32>& vertices) {
+    Pica::VertexLoader loader(regs);
+    Pica::DebugUtils::MemoryAccessTracker memory_accesses;
+    Pica::Shader::UnitState state;
+
+    std::vector<AttributeBuffer> outputs(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        AttributeBuffer input;
+        loader.LoadVertex(regs.vertex_attributes.GetPhysicalBaseAddress(), static_cast<int>(i),
+                          vertices[i], input, memory_accesses);
+        engine.RunBatch(setup, state, config, &input, &outputs[i], 1);
+    }
+    return outputs;
+}
+
+static bool OutputsMatch(const AttributeBuffer& a, const AttributeBuffer& b) {
+    for (std::size_t attr = 0; attr < 2; ++attr) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            if (a.attr[attr][comp].ToFloat32() != b.attr[attr][comp].ToFloat32())
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("ParallelVertexShader matches serial shading", "[video_core][vertex_shader]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+    VideoCore::g_shader_jit_enabled = false;
+
+    constexpr PAddr base_address = Memory::FCRAM_PADDR;
+    const PipelineRegs regs = SetupAttributes(base_address);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> real(-100.0f, 100.0f);
+    std::uniform_int_distribution<int> byte(0, 255);
+    u8* data = memory.GetPhysicalPointer(base_address);
+    for (u32 vertex = 0; vertex < NUM_VERTICES; ++vertex) {
+        for (u32 comp = 0; comp < 4; ++comp) {
+            const float value = real(rng);
+            std::memcpy(data + vertex * 20 + comp * sizeof(float), &value, sizeof(float));
+        }
+        for (u32 comp = 0; comp < 4; ++comp) {
+            data[vertex * 20 + 16 + comp] = static_cast<u8>(byte(rng));
+        }
+    }
+
+    Pica::Shader::InterpreterEngine engine;
+    Pica::Shader::ShaderSetup setup;
+    ShaderRegs config;
+    SetupShader(setup, config);
+    engine.SetupBatch(setup, 0);
+
+    std::vector<u32> sequential(NUM_VERTICES);
+    for (u32 i = 0; i < NUM_VERTICES; ++i) {
+        sequential[i] = i;
+    }
+    // Indices referring to each vertex several times, in no particular order
+    std::vector<u32> indexed(NUM_VERTICES * 3);
+    std::uniform_int_distribution<u32> index(0, NUM_VERTICES - 1);
+    std::generate(indexed.begin(), indexed.end(), [&] { return index(rng); });
+
+    Pica::ParallelVertexShader parallel_shader(4);
+    Pica::VertexLoader loader(regs);
+    const Pica::Shader::UnitState initial_state;
+
+    for (const bool is_indexed : {false, true}) {
+        const auto& vertices = is_indexed ? indexed : sequential;
+        const auto serial = ShadeSerially(engine, setup, config, regs, vertices);
+
+        parallel_shader.Run(engine, setup, config, initial_state, loader,
+                            regs.vertex_attributes.GetPhysicalBaseAddress(), vertices,
+                            is_indexed);
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            REQUIRE(OutputsMatch(parallel_shader.GetOutput(i), serial[i]));
+        }
+    }
+}
+
+/// Maps the first num_outputs output registers to the position and the color of the vertex
+static RasterizerRegs SetupOutputs(u32 num_outputs) {
+    RasterizerRegs regs{};
+    regs.vs_output_total.Assign(num_outputs);
+    regs.vs_output_attributes[0].raw = 0x03020100;
+    regs.vs_output_attributes[1].raw = 0x0B0A0908;
+    return regs;
+}
+
+TEST_CASE("ParallelVertexShader only shades shaders without leftover state",
+          "[video_core][vertex_shader]") {
+    Pica::Shader::ShaderSetup setup;
+    ShaderRegs config;
+    SetupShader(setup, config);
+    const RasterizerRegs rasterizer = SetupOutputs(2);
+    Pica::ParallelVertexShader parallel_shader(2);
+
+    const auto temp = SourceRegister::MakeTemporary(0);
+    const auto dest_temp = DestRegister::MakeTemporary(0);
+    const auto input0 = SourceRegister::MakeInput(0);
+    const auto input1 = SourceRegister::MakeInput(1);
+    const auto output0 = DestRegister::MakeOutput(0);
+    const auto output1 = DestRegister::MakeOutput(1);
+
+    SECTION("Shader writing all its outputs from its inputs") {
+        REQUIRE(parallel_shader.CanShade(setup, config, rasterizer));
+    }
+
+    SECTION("Temporary written before being read") {
+        // clang-format off
+        LoadProgram(setup, {
+            {OpCode::Id::MOV, dest_temp, input0},
+            {OpCode::Id::MUL, output0, temp, input1},
+            {OpCode::Id::MOV, output1, temp},
+            {OpCode::Id::END},
+        });
+        // clang-format on
+        REQUIRE(parallel_shader.CanShade(setup, config, rasterizer));
+    }
+
+    SECTION("Temporary accumulated across vertices") {
+        // clang-format off
+        LoadProgram(setup, {
+            {OpCode::Id::ADD, dest_temp, temp, input0},
+            {OpCode::Id::MOV, output0, temp},
+            {OpCode::Id::MOV, output1, input1},
+            {OpCode::Id::END},
+        });
+        // clang-format on
+        REQUIRE_FALSE(parallel_shader.CanShade(setup, config, rasterizer));
+    }
+
+    SECTION("Output left from the previous vertex") {
+        // clang-format off
+        LoadProgram(setup, {
+            {OpCode::Id::MOV, output0, input0},
+            {OpCode::Id::END},
+        });
+        // clang-format on
+        REQUIRE_FALSE(parallel_shader.CanShade(setup, config, rasterizer));
+        // Outputs that primitive assembly does not read don't matter
+        REQUIRE(parallel_shader.CanShade(setup, config, SetupOutputs(1)));
+    }
+
+    SECTION("Input register without an attribute") {
+        // clang-format off
+        LoadProgram(setup, {
+            {OpCode::Id::MOV, output0, SourceRegister::MakeInput(2)},
+            {OpCode::Id::MOV, output1, input1},
+            {OpCode::Id::END},
+        });
+        // clang-format on
+        REQUIRE_FALSE(parallel_shader.CanShade(setup, config, rasterizer));
+    }
+}
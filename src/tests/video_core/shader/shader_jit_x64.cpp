@@ -0,0 +1,143 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "common/file_util.h"
+#include "video_core/shader/shader_jit_x64.h"
+#include "video_core/shader/shader_jit_x64_disk_cache.h"
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+/// Loads a program moving the input to the given output register
+static void LoadProgram(Pica::Shader::ShaderSetup& setup, int output) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        {OpCode::Id::MOV, DestRegister::MakeOutput(output), SourceRegister::MakeInput(0)},
+        {OpCode::Id::END},
+    });
+    std::transform(shbin.program.begin(), shbin.program.end(), setup.program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   setup.swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    setup.MarkProgramCodeDirty();
+    setup.MarkSwizzleDataDirty();
+}
+
+TEST_CASE("JitX64Engine reuses cached shaders", "[video_core][shader][shader_jit]") {
+    Pica::Shader::JitX64Engine engine;
+    Pica::Shader::ShaderSetup setup;
+
+    LoadProgram(setup, 0);
+    engine.SetupBatch(setup, 0);
+    const void* first = setup.engine_data.cached_shader;
+    REQUIRE(engine.GetCacheStats().misses == 1);
+
+    engine.SetupBatch(setup, 0);
+    REQUIRE(engine.GetCacheStats().hits == 1);
+
+    LoadProgram(setup, 1);
+    engine.SetupBatch(setup, 0);
+    REQUIRE(engine.GetCacheStats().misses == 2);
+
+    // Switching back finds the first shader again
+    LoadProgram(setup, 0);
+    engine.SetupBatch(setup, 0);
+    REQUIRE(setup.engine_data.cached_shader == first);
+    REQUIRE(engine.GetCacheStats().hits == 2);
+    REQUIRE(engine.GetCacheStats().num_shaders == 2);
+}
+
+TEST_CASE("JitX64Engine evicts least recently used shaders", "[video_core][shader][shader_jit]") {
+    Pica::Shader::JitX64Engine engine;
+    Pica::Shader::ShaderSetup vs, gs;
+
+    LoadProgram(gs, 0);
+    engine.SetupBatch(gs, 0);
+    const void* gs_shader = gs.engine_data.cached_shader;
+    const std::size_t entry_size = engine.GetCacheStats().resident_bytes;
+    engine.SetCacheBudget(entry_size * 2);
+
+    for (int output = 1; output < 8; ++output) {
+        LoadProgram(vs, output);
+        engine.SetupBatch(vs, 0);
+        REQUIRE(engine.GetCacheStats().resident_bytes <= entry_size * 2);
+    }
+
+    // The shader of gs is the least recently used, but still set up and therefore kept
+    REQUIRE(gs.engine_data.cached_shader == gs_shader);
+    REQUIRE(engine.GetCacheStats().num_shaders == 2);
+    REQUIRE(engine.GetCacheStats().evictions == 6);
+
+    LoadProgram(vs, 0);
+    engine.SetupBatch(vs, 0);
+    REQUIRE(vs.engine_data.cached_shader == gs_shader);
+    REQUIRE(engine.GetCacheStats().misses == 8);
+}
+
+TEST_CASE("JitX64Engine loads shaders from the disk cache", "[video_core][shader][shader_jit]") {
+    const std::string path = "shader_jit_x64_disk_cache_test.bin";
+    FileUtil::Delete(path);
+
+    Pica::Shader::ShaderSetup setup;
+    LoadProgram(setup, 1);
+    {
+        Pica::Shader::JitX64Engine engine;
+        engine.SetDiskCache(std::make_unique<Pica::Shader::JitDiskCache>(path));
+        engine.SetupBatch(setup, 0);
+        REQUIRE(engine.GetCacheStats().disk_hits == 0);
+    }
+
+    auto disk_cache = std::make_unique<Pica::Shader::JitDiskCache>(path);
+    REQUIRE(disk_cache->GetEntryCount() == 1);
+
+    Pica::Shader::JitX64Engine engine;
+    engine.SetDiskCache(std::move(disk_cache));
+    engine.SetupBatch(setup, 0);
+    REQUIRE(engine.GetCacheStats().disk_hits == 1);
+
+    // The loaded shader runs like the compiled one
+    Pica::Shader::UnitState state;
+    state.registers.input[0].x = Pica::float24::FromFloat32(2.5f);
+    engine.Run(setup, state);
+    REQUIRE(state.registers.output[1].x.ToFloat32() == 2.5f);
+
+    // Another program is not found in the disk cache
+    LoadProgram(setup, 2);
+    engine.SetupBatch(setup, 0);
+    REQUIRE(engine.GetCacheStats().disk_hits == 1);
+
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("JitX64Engine interprets shaders compiling in the background",
+          "[video_core][shader][shader_jit]") {
+    Pica::Shader::JitX64Engine engine;
+    engine.SetAsyncCompilation(true);
+    Pica::Shader::ShaderSetup setup;
+    LoadProgram(setup, 1);
+
+    const auto run = [&] {
+        Pica::Shader::UnitState state;
+        state.registers.input[0].x = Pica::float24::FromFloat32(2.5f);
+        engine.Run(setup, state);
+        return state.registers.output[1].x.ToFloat32();
+    };
+
+    engine.SetupBatch(setup, 0);
+    REQUIRE(setup.engine_data.cached_shader == nullptr);
+    REQUIRE(engine.GetCacheStats().interpreted_setups == 1);
+    REQUIRE(run() == 2.5f);
+
+    engine.WaitForPendingCompilations();
+    engine.SetupBatch(setup, 0);
+    REQUIRE(setup.engine_data.cached_shader != nullptr);
+    REQUIRE(engine.GetCacheStats().misses == 1);
+    REQUIRE(engine.GetCacheStats().hits == 1);
+    REQUIRE(run() == 2.5f);
+}
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <vector>
 #include <catch2/catch.hpp>
 #include <nihstro/inline_assembly.h>
 #include "video_core/shader/shader_jit_x64_compiler.h"
@@ -89,3 +90,114 @@ TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
     REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
     REQUIRE(std::isinf(shader.Run(800.f)));
 }
+
+/// Input attribute 0 is mapped to v1 and attribute 1 to v0, outputs o0 and o1 are enabled
+static Pica::ShaderRegs MakeBatchConfig() {
+    Pica::ShaderRegs config{};
+    config.max_input_attribute_index.Assign(1);
+    config.input_attribute_to_register_map_low = 0x01;
+    config.output_mask.Assign(0b11);
+    return config;
+}
+
+static std::vector<Pica::Shader::AttributeBuffer> MakeBatchInputs(std::size_t count) {
+    std::vector<Pica::Shader::AttributeBuffer> inputs(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t attr = 0; attr < 2; ++attr) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                inputs[i].attr[attr][comp] =
+                    float24::FromFloat32(static_cast<float>(i * 8 + attr * 4 + comp) * 0.25f);
+            }
+        }
+    }
+    return inputs;
+}
+
+static void RunPerVertex(const JitShader& shader, const Pica::Shader::ShaderSetup& setup,
+                         const Pica::ShaderRegs& config,
+                         const std::vector<Pica::Shader::AttributeBuffer>& inputs,
+                         std::vector<Pica::Shader::AttributeBuffer>& outputs) {
+    Pica::Shader::UnitState shader_unit;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        shader_unit.LoadInput(config, inputs[i]);
+        shader.Run(setup, shader_unit, 0);
+        shader_unit.WriteOutput(config, outputs[i]);
+    }
+}
+
+static void RunBatched(const JitShader& shader, const Pica::Shader::ShaderSetup& setup,
+                       const Pica::ShaderRegs& config,
+                       const std::vector<Pica::Shader::AttributeBuffer>& inputs,
+                       std::vector<Pica::Shader::AttributeBuffer>& outputs) {
+    Pica::Shader::UnitState shader_unit;
+    shader.RunBatch(setup, shader_unit, 0, config, inputs.data(), outputs.data(), inputs.size());
+}
+
+TEST_CASE("Batched execution", "[video_core][shader][shader_jit]") {
+    const auto shader = CompileShader({
+        // clang-format off
+        {OpCode::Id::MUL, DestRegister::MakeOutput(0), SourceRegister::MakeInput(0),
+                          SourceRegister::MakeFloat(0)},
+        {OpCode::Id::ADD, DestRegister::MakeOutput(1), SourceRegister::MakeInput(1),
+                          SourceRegister::MakeInput(0)},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    auto setup = std::make_unique<Pica::Shader::ShaderSetup>();
+    setup->uniforms.f[0] = Common::MakeVec(float24::FromFloat32(2.f), float24::FromFloat32(-1.f),
+                                           float24::FromFloat32(0.5f), float24::FromFloat32(0.f));
+    const auto config = MakeBatchConfig();
+    const auto inputs = MakeBatchInputs(100);
+
+    std::vector<Pica::Shader::AttributeBuffer> expected(inputs.size());
+    std::vector<Pica::Shader::AttributeBuffer> batched(inputs.size());
+    RunPerVertex(*shader, *setup, config, inputs, expected);
+    RunBatched(*shader, *setup, config, inputs, batched);
+
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        for (std::size_t attr = 0; attr < 2; ++attr) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                REQUIRE(batched[i].attr[attr][comp].ToFloat32() ==
+                        expected[i].attr[attr][comp].ToFloat32());
+            }
+        }
+    }
+
+    // v1 holds attribute 0 and v0 holds attribute 1
+    REQUIRE(batched[1].attr[0][0].ToFloat32() == inputs[1].attr[1][0].ToFloat32() * 2.f);
+    REQUIRE(batched[1].attr[1][1].ToFloat32() ==
+            inputs[1].attr[0][1].ToFloat32() + inputs[1].attr[1][1].ToFloat32());
+}
+
+TEST_CASE("Batched execution benchmark", "[video_core][shader][shader_jit][!benchmark]") {
+    const auto shader = CompileShader({
+        // clang-format off
+        {OpCode::Id::DP4, DestRegister::MakeOutput(0), SourceRegister::MakeInput(0),
+                          SourceRegister::MakeFloat(0)},
+        {OpCode::Id::MUL, DestRegister::MakeOutput(1), SourceRegister::MakeInput(1),
+                          SourceRegister::MakeFloat(1)},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    auto setup = std::make_unique<Pica::Shader::ShaderSetup>();
+    for (std::size_t i = 0; i < 2; ++i) {
+        setup->uniforms.f[i] =
+            Common::MakeVec(float24::FromFloat32(1.f), float24::FromFloat32(2.f),
+                            float24::FromFloat32(3.f), float24::FromFloat32(4.f));
+    }
+    const auto config = MakeBatchConfig();
+    const auto inputs = MakeBatchInputs(4096);
+    std::vector<Pica::Shader::AttributeBuffer> outputs(inputs.size());
+
+    BENCHMARK("Per-vertex, 4096 vertices") {
+        RunPerVertex(*shader, *setup, config, inputs, outputs);
+        return outputs[0].attr[0][0].ToFloat32();
+    };
+
+    BENCHMARK("Batched, 4096 vertices") {
+        RunBatched(*shader, *setup, config, inputs, outputs);
+        return outputs[0].attr[0][0].ToFloat32();
+    };
+}
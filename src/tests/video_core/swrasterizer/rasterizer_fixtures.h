@@ -0,0 +1,120 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/video_core.h"
+
+namespace RasterizerFixtures {
+
+using float24 = Pica::float24;
+using Pica::FramebufferRegs;
+using Pica::Rasterizer::Vertex;
+
+constexpr u32 FRAMEBUFFER_SIZE = 256;
+constexpr u32 COLOR_BUFFER_BYTES = FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE * 4;
+constexpr u32 DEPTH_BUFFER_BYTES = FRAMEBUFFER_SIZE * FRAMEBUFFER_SIZE * 4;
+constexpr PAddr COLOR_BUFFER_ADDR = Memory::VRAM_PADDR;
+constexpr PAddr DEPTH_BUFFER_ADDR = Memory::VRAM_PADDR + COLOR_BUFFER_BYTES;
+
+/**
+ * Provides the memory and Pica state needed to rasterize into an RGBA8/D24S8 framebuffer with
+ * order-dependent alpha blending and depth testing.
+ */
+class RasterizerFixture {
+public:
+    RasterizerFixture() {
+        VideoCore::g_memory = &memory;
+        SetupRegisters();
+    }
+
+    ~RasterizerFixture() {
+        VideoCore::g_memory = nullptr;
+    }
+
+    void ClearFramebuffer() {
+        std::memset(memory.GetPhysicalPointer(COLOR_BUFFER_ADDR), 0, COLOR_BUFFER_BYTES);
+        std::memset(memory.GetPhysicalPointer(DEPTH_BUFFER_ADDR), 0xFF, DEPTH_BUFFER_BYTES);
+    }
+
+    /// Returns the contents of the color buffer followed by the depth buffer
+    std::vector<u8> ReadFramebuffer() {
+        const u8* begin = memory.GetPhysicalPointer(COLOR_BUFFER_ADDR);
+        return {begin, begin + COLOR_BUFFER_BYTES + DEPTH_BUFFER_BYTES};
+    }
+
+    /// Generates a deterministic set of triangles covering the framebuffer, three vertices each
+    static std::vector<Vertex> GenerateTriangles(std::size_t count, u32 seed = 1234) {
+        std::mt19937 rng(seed);
+        // Some vertices land outside of the framebuffer to cover partially visible triangles
+        std::uniform_real_distribution<float> coord(-16.0f, FRAMEBUFFER_SIZE - 8.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        std::vector<Vertex> vertices;
+        for (std::size_t i = 0; i < count * 3; ++i) {
+            Pica::Shader::OutputVertex output{};
+            // Varying w, so that attributes are interpolated with perspective correction
+            output.pos.w = float24::FromFloat32(0.5f + unit(rng));
+            for (std::size_t c = 0; c < 4; ++c) {
+                output.color[c] = float24::FromFloat32(unit(rng));
+            }
+
+            Vertex vertex(output);
+            vertex.screenpos = Common::MakeVec(float24::FromFloat32(std::max(coord(rng), 0.0f)),
+                                               float24::FromFloat32(std::max(coord(rng), 0.0f)),
+                                               float24::FromFloat32(unit(rng)));
+            vertices.push_back(vertex);
+        }
+        return vertices;
+    }
+
+private:
+    static void SetupRegisters() {
+        auto& regs = Pica::g_state.regs;
+        std::memset(&regs, 0, sizeof(regs));
+
+        regs.rasterizer.cull_mode.Assign(Pica::RasterizerRegs::CullMode::KeepAll);
+        regs.rasterizer.viewport_depth_range.Assign(0x3F0000); // 1.0 as float24
+        regs.rasterizer.depthmap_enable.Assign(Pica::RasterizerRegs::ZBuffering);
+
+        regs.lighting.disable.Assign(1);
+
+        auto& framebuffer = regs.framebuffer.framebuffer;
+        framebuffer.allow_color_write.Assign(1);
+        framebuffer.allow_depth_stencil_write.Assign(1);
+        framebuffer.color_format.Assign(FramebufferRegs::ColorFormat::RGBA8);
+        framebuffer.depth_format.Assign(FramebufferRegs::DepthFormat::D24S8);
+        framebuffer.color_buffer_address.Assign(COLOR_BUFFER_ADDR / 8);
+        framebuffer.depth_buffer_address.Assign(DEPTH_BUFFER_ADDR / 8);
+        framebuffer.width.Assign(FRAMEBUFFER_SIZE);
+        framebuffer.height.Assign(FRAMEBUFFER_SIZE - 1);
+
+        auto& output_merger = regs.framebuffer.output_merger;
+        output_merger.alphablend_enable.Assign(1);
+        output_merger.alpha_blending.factor_source_rgb.Assign(
+            FramebufferRegs::BlendFactor::SourceAlpha);
+        output_merger.alpha_blending.factor_dest_rgb.Assign(
+            FramebufferRegs::BlendFactor::OneMinusSourceAlpha);
+        output_merger.alpha_blending.factor_source_a.Assign(FramebufferRegs::BlendFactor::One);
+        output_merger.alpha_blending.factor_dest_a.Assign(FramebufferRegs::BlendFactor::Zero);
+        output_merger.depth_test_enable.Assign(1);
+        output_merger.depth_test_func.Assign(FramebufferRegs::CompareFunc::LessThanOrEqual);
+        output_merger.depth_write_enable.Assign(1);
+        output_merger.red_enable.Assign(1);
+        output_merger.green_enable.Assign(1);
+        output_merger.blue_enable.Assign(1);
+        output_merger.alpha_enable.Assign(1);
+    }
+
+    Memory::MemorySystem memory;
+};
+
+} // namespace RasterizerFixtures
@@ -0,0 +1,215 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "tests/video_core/swrasterizer/rasterizer_fixtures.h"
+#include "video_core/swrasterizer/span.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+using namespace Pica::Rasterizer;
+using RasterizerFixtures::RasterizerFixture;
+
+/// Returns the vectorized span evaluators supported by the host CPU
+static std::vector<std::pair<const char*, SpanEvaluator>> GetSimdEvaluators() {
+    std::vector<std::pair<const char*, SpanEvaluator>> evaluators;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse4_1)
+        evaluators.emplace_back("SSE4.1", EvaluateSpanSSE41);
+    if (Common::GetCPUCaps().avx2)
+        evaluators.emplace_back("AVX2", EvaluateSpanAVX2);
+#endif
+    return evaluators;
+}
+
+TEST_CASE("SIMD span evaluators match the scalar evaluator", "[video_core][swrasterizer]") {
+    std::mt19937 rng(42);
+    // Full range of 12.4 fixed point coordinates, so that the edge functions also overflow
+    std::uniform_int_distribution<s32> coord(0, 0xFFFF);
+
+    for (const auto& [name, evaluate_span] : GetSimdEvaluators()) {
+        INFO(name);
+        for (int i = 0; i < 10000; ++i) {
+            EdgeFunctions edges;
+            for (std::size_t edge = 0; edge < 3; ++edge) {
+                edges.x1[edge] = coord(rng);
+                edges.y1[edge] = coord(rng);
+                edges.dx[edge] = coord(rng) - edges.x1[edge];
+                edges.dy[edge] = coord(rng) - edges.y1[edge];
+                edges.bias[edge] = -static_cast<s32>(rng() & 1);
+            }
+            const s32 x = coord(rng);
+            const s32 y = coord(rng);
+            const u32 count = 1 + rng() % SPAN_WIDTH;
+
+            SpanWeights expected;
+            SpanWeights actual;
+            const u32 expected_mask = EvaluateSpanScalar(edges, x, y, count, expected);
+            const u32 actual_mask = evaluate_span(edges, x, y, count, actual);
+
+            REQUIRE(actual_mask == expected_mask);
+            for (u32 lane = 0; lane < count; ++lane) {
+                REQUIRE(actual.w0[lane] == expected.w0[lane]);
+                REQUIRE(actual.w1[lane] == expected.w1[lane]);
+                REQUIRE(actual.w2[lane] == expected.w2[lane]);
+            }
+        }
+    }
+}
+
+/// Returns the vectorized span interpolators supported by the host CPU
+static std::vector<std::pair<const char*, SpanInterpolator>> GetSimdInterpolators() {
+    std::vector<std::pair<const char*, SpanInterpolator>> interpolators;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse4_1)
+        interpolators.emplace_back("SSE4.1", InterpolateSpanSSE41);
+    if (Common::GetCPUCaps().avx2)
+        interpolators.emplace_back("AVX2", InterpolateSpanAVX2);
+#endif
+    return interpolators;
+}
+
+/**
+ * Compares floats by their bits, so that the signs of zeros are checked. Any two NaNs compare
+ * equal: their signs depend on the order the compiler puts operands in, and the rasterizer treats
+ * all of them alike.
+ */
+static bool BitEqual(float a, float b) {
+    if (std::isnan(a) || std::isnan(b))
+        return std::isnan(a) && std::isnan(b);
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+TEST_CASE("SIMD span interpolators match the scalar interpolator", "[video_core][swrasterizer]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(-0.5f, 1.5f);
+    std::uniform_int_distribution<s32> weight(-0x1000000, 0x1000000);
+    // Vertex values the PICA special cases, mixed in with regular ones
+    constexpr std::array<float, 4> special{0.0f, -0.0f, std::numeric_limits<float>::infinity(),
+                                           std::numeric_limits<float>::quiet_NaN()};
+    const auto RandomValue = [&] {
+        return rng() % 16 == 0 ? special[rng() % special.size()] : unit(rng);
+    };
+    const auto RandomValues = [&] {
+        return std::array<float, 3>{RandomValue(), RandomValue(), RandomValue()};
+    };
+
+    for (const auto& [name, interpolate_span] : GetSimdInterpolators()) {
+        INFO(name);
+        for (int i = 0; i < 10000; ++i) {
+            TriangleAttributes triangle;
+            triangle.w_inverse = RandomValues();
+            triangle.z = RandomValues();
+            for (auto& attribute : triangle.attributes) {
+                attribute = RandomValues();
+            }
+            triangle.depth_scale = unit(rng);
+            triangle.depth_offset = unit(rng);
+            triangle.w_buffer = rng() & 1;
+
+            SpanWeights weights;
+            for (u32 lane = 0; lane < SPAN_WIDTH; ++lane) {
+                // Also zero weights, and sums of weights that are zero or overflow
+                weights.w0[lane] = rng() % 8 == 0 ? 0 : weight(rng);
+                weights.w1[lane] = rng() % 8 == 0 ? -weights.w0[lane] : weight(rng);
+                weights.w2[lane] = rng() % 8 == 0 ? std::numeric_limits<s32>::max() : weight(rng);
+            }
+            const u32 count = 1 + rng() % SPAN_WIDTH;
+
+            SpanAttributes expected;
+            SpanAttributes actual;
+            InterpolateSpanScalar(triangle, weights, count, expected);
+            interpolate_span(triangle, weights, count, actual);
+
+            for (u32 lane = 0; lane < count; ++lane) {
+                INFO("lane " << lane);
+                REQUIRE(BitEqual(actual.b0[lane], expected.b0[lane]));
+                REQUIRE(BitEqual(actual.b1[lane], expected.b1[lane]));
+                REQUIRE(BitEqual(actual.b2[lane], expected.b2[lane]));
+                REQUIRE(BitEqual(actual.w[lane], expected.w[lane]));
+                REQUIRE(BitEqual(actual.depth[lane], expected.depth[lane]));
+                for (std::size_t c = 0; c < expected.color.size(); ++c) {
+                    REQUIRE(actual.color[c][lane] == expected.color[c][lane]);
+                }
+                for (std::size_t c = 0; c < expected.uv.size(); ++c) {
+                    REQUIRE(BitEqual(actual.uv[c][lane], expected.uv[c][lane]));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD span kernels render identical images", "[video_core][swrasterizer]") {
+    RasterizerFixture fixture;
+    const auto vertices = RasterizerFixture::GenerateTriangles(300, 5678);
+    const SpanEvaluator default_evaluator = GetSpanEvaluator();
+    const SpanInterpolator default_interpolator = GetSpanInterpolator();
+
+    const auto Render = [&](SpanEvaluator evaluator, SpanInterpolator interpolator) {
+        SetSpanEvaluator(evaluator);
+        SetSpanInterpolator(interpolator);
+        fixture.ClearFramebuffer();
+        for (std::size_t i = 0; i < vertices.size(); i += 3) {
+            ProcessTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+        }
+        return fixture.ReadFramebuffer();
+    };
+
+    const auto golden = Render(EvaluateSpanScalar, InterpolateSpanScalar);
+    for (const auto& [name, evaluate_span] : GetSimdEvaluators()) {
+        INFO(name);
+        REQUIRE(Render(evaluate_span, InterpolateSpanScalar) == golden);
+    }
+    for (const auto& [name, interpolate_span] : GetSimdInterpolators()) {
+        INFO(name);
+        REQUIRE(Render(EvaluateSpanScalar, interpolate_span) == golden);
+    }
+
+    SetSpanEvaluator(default_evaluator);
+    SetSpanInterpolator(default_interpolator);
+}
+
+TEST_CASE("Span interpolators performance", "[video_core][swrasterizer][!benchmark]") {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(0.5f, 1.5f);
+    TriangleAttributes triangle;
+    triangle.w_inverse = {unit(rng), unit(rng), unit(rng)};
+    triangle.z = {unit(rng), unit(rng), unit(rng)};
+    for (auto& attribute : triangle.attributes) {
+        attribute = {unit(rng), unit(rng), unit(rng)};
+    }
+    triangle.depth_scale = 1.0f;
+    triangle.depth_offset = 0.0f;
+    triangle.w_buffer = false;
+    SpanWeights weights;
+    for (u32 lane = 0; lane < SPAN_WIDTH; ++lane) {
+        weights.w0[lane] = 0x1000 + lane * 0x10;
+        weights.w1[lane] = 0x2000 - lane * 0x10;
+        weights.w2[lane] = 0x3000;
+    }
+
+    std::vector<std::pair<const char*, SpanInterpolator>> all_interpolators{
+        {"Scalar", InterpolateSpanScalar}};
+    for (const auto& interpolator : GetSimdInterpolators()) {
+        all_interpolators.push_back(interpolator);
+    }
+
+    for (const auto& [name, interpolate_span] : all_interpolators) {
+        SpanAttributes attributes;
+        BENCHMARK(std::string(name) + ": 100 spans") {
+            for (int i = 0; i < 100; ++i) {
+                interpolate_span(triangle, weights, SPAN_WIDTH, attributes);
+            }
+            return attributes.color[0][0];
+        };
+    }
+}
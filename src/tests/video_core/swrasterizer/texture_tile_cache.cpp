@@ -0,0 +1,68 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/swrasterizer/texture_tile_cache.h"
+#include "video_core/texture/texture_decode.h"
+
+using namespace Pica::Rasterizer;
+using Pica::TexturingRegs;
+
+static u32 ToRGBA(const Common::Vec4<u8>& color) {
+    return (u32{color.r()} << 24) | (u32{color.g()} << 16) | (u32{color.b()} << 8) | color.a();
+}
+
+TEST_CASE("TextureTileCache matches direct texel lookups", "[video_core][swrasterizer]") {
+    constexpr PAddr address = 0x18000000;
+    std::mt19937 rng(1234);
+    std::vector<u8> data(64 * 64 * 4);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+
+    TextureTileCache cache;
+    for (const auto format :
+         {TexturingRegs::TextureFormat::RGBA8, TexturingRegs::TextureFormat::RGB565,
+          TexturingRegs::TextureFormat::I4, TexturingRegs::TextureFormat::ETC1,
+          TexturingRegs::TextureFormat::ETC1A4}) {
+        Pica::Texture::TextureInfo info{};
+        info.physical_address = address;
+        info.width = 64;
+        info.height = 64;
+        info.format = format;
+        info.SetDefaultStride();
+
+        // Same address with a different format must not hit the tiles decoded before
+        std::uniform_int_distribution<unsigned int> coord(0, 63);
+        for (int i = 0; i < 2000; ++i) {
+            const unsigned int x = coord(rng);
+            const unsigned int y = coord(rng);
+            REQUIRE(ToRGBA(cache.LookupTexture(address, data.data(), x, y, info)) ==
+                    ToRGBA(Pica::Texture::LookupTexture(data.data(), x, y, info)));
+        }
+    }
+}
+
+TEST_CASE("TextureTileCache is invalidated", "[video_core][swrasterizer]") {
+    constexpr PAddr address = 0x18000000;
+    std::vector<u8> data(8 * 8 * 4, 0x10);
+
+    Pica::Texture::TextureInfo info{};
+    info.physical_address = address;
+    info.width = 8;
+    info.height = 8;
+    info.format = TexturingRegs::TextureFormat::RGBA8;
+    info.SetDefaultStride();
+
+    TextureTileCache cache;
+    REQUIRE(ToRGBA(cache.LookupTexture(address, data.data(), 3, 3, info)) == 0x10101010);
+
+    // Writes to the texture are only seen after invalidation
+    data.assign(data.size(), 0x20);
+    REQUIRE(ToRGBA(cache.LookupTexture(address, data.data(), 3, 3, info)) == 0x10101010);
+    TextureTileCache::InvalidateAll();
+    REQUIRE(ToRGBA(cache.LookupTexture(address, data.data(), 3, 3, info)) == 0x20202020);
+}
@@ -0,0 +1,30 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "tests/video_core/swrasterizer/rasterizer_fixtures.h"
+#include "video_core/swrasterizer/tile_binner.h"
+
+using RasterizerFixtures::RasterizerFixture;
+
+TEST_CASE("TileBinner matches serial rasterization", "[video_core][swrasterizer]") {
+    RasterizerFixture fixture;
+    const auto vertices = RasterizerFixture::GenerateTriangles(500);
+
+    fixture.ClearFramebuffer();
+    for (std::size_t i = 0; i < vertices.size(); i += 3) {
+        Pica::Rasterizer::ProcessTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+    }
+    const auto serial = fixture.ReadFramebuffer();
+
+    for (const std::size_t num_threads : {1, 2, 4}) {
+        Pica::Rasterizer::TileBinner binner(num_threads);
+        fixture.ClearFramebuffer();
+        for (std::size_t i = 0; i < vertices.size(); i += 3) {
+            binner.AddTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+        }
+        binner.Flush();
+        REQUIRE(fixture.ReadFramebuffer() == serial);
+    }
+}
@@ -0,0 +1,118 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "video_core/texture/texture_decode.h"
+
+using Pica::TexturingRegs;
+using TextureFormat = Pica::TexturingRegs::TextureFormat;
+
+namespace {
+
+constexpr std::array<TextureFormat, 14> ALL_FORMATS{
+    TextureFormat::RGBA8, TextureFormat::RGB8,  TextureFormat::RGB5A1, TextureFormat::RGB565,
+    TextureFormat::RGBA4, TextureFormat::IA8,   TextureFormat::RG8,    TextureFormat::I8,
+    TextureFormat::A8,    TextureFormat::IA4,   TextureFormat::I4,     TextureFormat::A4,
+    TextureFormat::ETC1,  TextureFormat::ETC1A4,
+};
+
+Pica::Texture::TextureInfo MakeInfo(TextureFormat format, u32 width, u32 height) {
+    Pica::Texture::TextureInfo info{};
+    info.width = width;
+    info.height = height;
+    info.format = format;
+    info.SetDefaultStride();
+    return info;
+}
+
+std::vector<u8> MakeTextureData(const Pica::Texture::TextureInfo& info) {
+    std::mt19937 rng(1234);
+    std::vector<u8> data(info.stride * (info.height / 8));
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DecodeTextureRect matches LookupTexture", "[video_core][texture]") {
+    constexpr u32 width = 64;
+    constexpr u32 height = 32;
+    std::mt19937 rng(42);
+
+    for (const auto format : ALL_FORMATS) {
+        INFO("Format " << static_cast<u32>(format));
+        const auto info = MakeInfo(format, width, height);
+        const auto data = MakeTextureData(info);
+
+        // The whole texture as well as rectangles not aligned to tiles
+        std::vector<Common::Rectangle<u32>> rects{{0, 0, width, height}};
+        for (int i = 0; i < 20; ++i) {
+            const u32 left = std::uniform_int_distribution<u32>(0, width - 1)(rng);
+            const u32 top = std::uniform_int_distribution<u32>(0, height - 1)(rng);
+            const u32 right = std::uniform_int_distribution<u32>(left + 1, width)(rng);
+            const u32 bottom = std::uniform_int_distribution<u32>(top + 1, height)(rng);
+            rects.emplace_back(left, top, right, bottom);
+        }
+
+        for (const auto& rect : rects) {
+            const u32 rect_width = rect.right - rect.left;
+            std::vector<u8> decoded(rect_width * (rect.bottom - rect.top) * 4);
+            Pica::Texture::DecodeTextureRect(info, data.data(), decoded.data(), rect);
+
+            for (u32 y = rect.top; y < rect.bottom; ++y) {
+                for (u32 x = rect.left; x < rect.right; ++x) {
+                    auto expected = Pica::Texture::LookupTexture(data.data(), x, y, info);
+                    const u8* texel =
+                        &decoded[((y - rect.top) * rect_width + (x - rect.left)) * 4];
+                    REQUIRE(std::memcmp(texel, expected.AsArray(), 4) == 0);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("DecodeTextureRect performance", "[video_core][texture][!benchmark]") {
+    constexpr u32 width = 512;
+    constexpr u32 height = 512;
+    constexpr int iterations = 20;
+    std::vector<u8> decoded(width * height * 4);
+
+    for (const auto format : ALL_FORMATS) {
+        const auto info = MakeInfo(format, width, height);
+        const auto data = MakeTextureData(info);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            Pica::Texture::DecodeTextureRect(info, data.data(), decoded.data(),
+                                             {0, 0, width, height});
+        }
+        const auto bulk_time = std::chrono::steady_clock::now() - start;
+
+        for (int i = 0; i < iterations; ++i) {
+            for (u32 y = 0; y < height; ++y) {
+                for (u32 x = 0; x < width; ++x) {
+                    auto texel = Pica::Texture::LookupTexture(data.data(), x, y, info);
+                    std::memcpy(&decoded[(y * width + x) * 4], texel.AsArray(), 4);
+                }
+            }
+        }
+        const auto lookup_time = std::chrono::steady_clock::now() - start - bulk_time;
+
+        // Throughput in megabytes of decoded RGBA8 texels per second
+        const auto throughput = [&](auto duration) {
+            const double seconds = std::chrono::duration<double>(duration).count();
+            return decoded.size() * iterations / seconds / 1000000.0;
+        };
+        WARN(fmt::format("Format {:2}: DecodeTextureRect {:8.1f} MB/s, LookupTexture {:8.1f} MB/s",
+                         static_cast<u32>(format), throughput(bulk_time),
+                         throughput(lookup_time)));
+    }
+}
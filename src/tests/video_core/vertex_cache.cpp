@@ -0,0 +1,68 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "video_core/pica_state.h"
+#include "video_core/vertex_cache.h"
+
+using Pica::VertexCache;
+
+static Pica::Shader::AttributeBuffer MakeOutput(u32 vertex) {
+    Pica::Shader::AttributeBuffer output{};
+    output.attr[0].x = Pica::float24::FromFloat32(static_cast<float>(vertex));
+    return output;
+}
+
+TEST_CASE("VertexCache lookup and replacement", "[video_core][vertex_cache]") {
+    Pica::VertexLoader loader;
+    VertexCache cache;
+    cache.BeginDraw(Pica::VertexCacheKey(Pica::g_state, loader, 0));
+
+    REQUIRE(cache.Lookup(0) == nullptr);
+    cache.Insert(0, MakeOutput(0));
+    const auto* cached = cache.Lookup(0);
+    REQUIRE(cached != nullptr);
+    REQUIRE(cached->attr[0].x.ToFloat32() == 0.0f);
+
+    // Fill the set of vertex 0 until it is evicted, other sets are not affected
+    cache.Insert(1, MakeOutput(1));
+    for (u32 way = 1; way <= VertexCache::NUM_WAYS; ++way) {
+        REQUIRE(cache.Lookup(0) != nullptr);
+        cache.Insert(way * VertexCache::NUM_SETS, MakeOutput(way * VertexCache::NUM_SETS));
+    }
+    REQUIRE(cache.Lookup(0) == nullptr);
+    REQUIRE(cache.Lookup(1) != nullptr);
+    REQUIRE(cache.Lookup(VertexCache::NUM_SETS)->attr[0].x.ToFloat32() ==
+            static_cast<float>(VertexCache::NUM_SETS));
+
+    REQUIRE(cache.GetHits() == 3 + VertexCache::NUM_WAYS);
+    REQUIRE(cache.GetMisses() == 2);
+}
+
+TEST_CASE("VertexCache persists across draws with the same key", "[video_core][vertex_cache]") {
+    Pica::VertexLoader loader;
+    VertexCache cache;
+
+    cache.BeginDraw(Pica::VertexCacheKey(Pica::g_state, loader, 0));
+    cache.Insert(5, MakeOutput(5));
+
+    cache.BeginDraw(Pica::VertexCacheKey(Pica::g_state, loader, 0));
+    REQUIRE(cache.Lookup(5) != nullptr);
+    REQUIRE(cache.GetHits() == 1);
+
+    // A different vertex buffer drops the cached vertices
+    cache.BeginDraw(Pica::VertexCacheKey(Pica::g_state, loader, 0x100));
+    REQUIRE(cache.Lookup(5) == nullptr);
+    cache.Insert(5, MakeOutput(5));
+
+    // So does a change of the shader uniforms
+    Pica::g_state.vs.uniforms.f[0].x = Pica::float24::FromFloat32(1.0f);
+    cache.BeginDraw(Pica::VertexCacheKey(Pica::g_state, loader, 0x100));
+    REQUIRE(cache.Lookup(5) == nullptr);
+    Pica::g_state.vs.uniforms.f[0].x = Pica::float24::FromFloat32(0.0f);
+
+    cache.Insert(5, MakeOutput(5));
+    cache.Invalidate();
+    REQUIRE(cache.Lookup(5) == nullptr);
+}
@@ -0,0 +1,104 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/memory.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader.h"
+#include "video_core/video_core.h"
+
+using Pica::PipelineRegs;
+using VertexAttributeFormat = PipelineRegs::VertexAttributeFormat;
+
+constexpr u32 NUM_VERTICES = 64;
+
+static PipelineRegs SetupAttributes(PAddr base_address) {
+    PipelineRegs regs{};
+    auto& attributes = regs.vertex_attributes;
+    attributes.base_address.Assign(base_address / 16);
+
+    // Attribute 0: 3 floats, attribute 1: 4 unsigned bytes
+    attributes.format0.Assign(VertexAttributeFormat::FLOAT);
+    attributes.size0.Assign(2);
+    attributes.format1.Assign(VertexAttributeFormat::UBYTE);
+    attributes.size1.Assign(3);
+    attributes.attribute_loaders[0].data_offset.Assign(0);
+    attributes.attribute_loaders[0].comp0.Assign(0);
+    attributes.attribute_loaders[0].comp1.Assign(1);
+    attributes.attribute_loaders[0].component_count.Assign(2);
+    attributes.attribute_loaders[0].byte_count.Assign(16);
+
+    // Attribute 2: 2 shorts, then 4 bytes of padding and attribute 3: 1 signed byte
+    attributes.format2.Assign(VertexAttributeFormat::SHORT);
+    attributes.size2.Assign(1);
+    attributes.format3.Assign(VertexAttributeFormat::BYTE);
+    attributes.size3.Assign(0);
+    attributes.attribute_loaders[1].data_offset.Assign(NUM_VERTICES * 16);
+    attributes.attribute_loaders[1].comp0.Assign(2);
+    attributes.attribute_loaders[1].comp1.Assign(12);
+    attributes.attribute_loaders[1].comp2.Assign(3);
+    attributes.attribute_loaders[1].component_count.Assign(3);
+    attributes.attribute_loaders[1].byte_count.Assign(12);
+
+    // Attribute 4 comes from the default attributes, attribute 5 is left untouched
+    attributes.attribute_mask.Assign(1 << 4);
+    attributes.max_attribute_index.Assign(5);
+    return regs;
+}
+
+static std::vector<Pica::Shader::AttributeBuffer> LoadVertices(const PipelineRegs& regs,
+                                                               bool use_jit) {
+    VideoCore::g_shader_jit_enabled = use_jit;
+    Pica::VertexLoader loader(regs);
+    Pica::DebugUtils::MemoryAccessTracker memory_accesses;
+
+    std::vector<Pica::Shader::AttributeBuffer> vertices(NUM_VERTICES);
+    for (u32 vertex = 0; vertex < NUM_VERTICES; ++vertex) {
+        std::memset(&vertices[vertex], 0xCD, sizeof(vertices[vertex]));
+        loader.LoadVertex(regs.vertex_attributes.GetPhysicalBaseAddress(), vertex, vertex,
+                          vertices[vertex], memory_accesses);
+    }
+    return vertices;
+}
+
+TEST_CASE("VertexLoaderJit matches the interpreter", "[video_core][vertex_loader]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+
+    constexpr PAddr base_address = Memory::FCRAM_PADDR;
+    const PipelineRegs regs = SetupAttributes(base_address);
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_real_distribution<float> real(-100.0f, 100.0f);
+    u8* data = memory.GetPhysicalPointer(base_address);
+    for (u32 i = 0; i < NUM_VERTICES * 28; ++i) {
+        data[i] = static_cast<u8>(byte(rng));
+    }
+    for (u32 vertex = 0; vertex < NUM_VERTICES; ++vertex) {
+        for (u32 comp = 0; comp < 3; ++comp) {
+            const float value = real(rng);
+            std::memcpy(data + vertex * 16 + comp * sizeof(float), &value, sizeof(float));
+        }
+    }
+    for (u32 comp = 0; comp < 4; ++comp) {
+        Pica::g_state.input_default_attributes.attr[4][comp] =
+            Pica::float24::FromFloat32(real(rng));
+    }
+
+    const auto interpreted = LoadVertices(regs, false);
+    const auto compiled = LoadVertices(regs, true);
+    for (u32 vertex = 0; vertex < NUM_VERTICES; ++vertex) {
+        REQUIRE(std::memcmp(&interpreted[vertex], &compiled[vertex],
+                            sizeof(Pica::Shader::AttributeBuffer)) == 0);
+    }
+
+    Pica::VertexLoader::ClearJitCache();
+    VideoCore::g_memory = nullptr;
+}
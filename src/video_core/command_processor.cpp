@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -17,6 +19,7 @@
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/parallel_vertex_shader.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
 #include "video_core/primitive_assembly.h"
@@ -26,6 +29,7 @@
 #include "video_core/regs_texturing.h"
 #include "video_core/renderer_base.h"
 #include "video_core/shader/shader.h"
+#include "video_core/vertex_cache.h"
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
@@ -39,6 +43,26 @@ constexpr std::array<u32, 16> expand_bits_to_bytes{
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+/// Post-transform cache of indexed vertices, shared by consecutive draws of a command list
+static VertexCache vertex_cache;
+
+/// Draws with fewer vertices are shaded serially, as distributing them costs more than it saves
+constexpr unsigned int PARALLEL_SHADING_MIN_VERTICES = 256;
+
+static std::unique_ptr<ParallelVertexShader> parallel_vertex_shader;
+static std::vector<u32> parallel_draw_vertices;
+
+/// Returns the parallel vertex shader matching the current settings, or nullptr if disabled
+static ParallelVertexShader* GetParallelVertexShader() {
+    const u16 num_threads = VideoCore::g_vertex_shader_threads;
+    if (num_threads <= 1) {
+        parallel_vertex_shader = nullptr;
+    } else if (!parallel_vertex_shader || parallel_vertex_shader->NumThreads() != num_threads) {
+        parallel_vertex_shader = std::make_unique<ParallelVertexShader>(num_threads);
+    }
+    return parallel_vertex_shader.get();
+}
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -312,8 +336,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         }
 
         // Processes information about internal vertex attributes to figure out how a vertex is
-        // loaded.
-        // Later, these can be compiled and cached.
+        // loaded. Loaders are compiled and cached per attribute layout when the JIT is enabled.
         const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
         VertexLoader loader(regs.pipeline);
         Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
@@ -343,16 +366,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         DebugUtils::MemoryAccessTracker memory_accesses;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const std::size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
         Shader::AttributeBuffer vs_output;
 
-        unsigned int vertex_cache_pos = 0;
-
         auto* shader_engine = Shader::GetEngine();
         Shader::UnitState shader_unit;
 
@@ -363,58 +378,105 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_state.geometry_pipeline.NeedIndexInput())
             ASSERT(is_indexed);
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
+        ParallelVertexShader* parallel_shader = GetParallelVertexShader();
+        if (parallel_shader && regs.pipeline.use_gs == PipelineRegs::UseGS::No &&
+            !g_debug_context && regs.pipeline.num_vertices >= PARALLEL_SHADING_MIN_VERTICES &&
+            parallel_shader->CanShade(g_state.vs, regs.vs, regs.rasterizer)) {
+            std::vector<u32>& vertices = parallel_draw_vertices;
+            vertices.resize(regs.pipeline.num_vertices);
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                // Indexed rendering doesn't use the start offset
+                vertices[index] =
+                    is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                               : (index + regs.pipeline.vertex_offset);
+            }
 
-            bool vertex_cache_hit = false;
+            parallel_shader->Run(*shader_engine, g_state.vs, regs.vs, shader_unit, loader,
+                                 base_address, vertices, is_indexed);
 
-            if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
+            for (std::size_t i = 0; i < vertices.size(); ++i) {
+                g_state.geometry_pipeline.SubmitVertex(parallel_shader->GetOutput(i));
+            }
+        } else if (!is_indexed && !g_debug_context) {
+            // Non-indexed draws never reuse vertices, so they are shaded in batches to amortize the
+            // per-vertex overhead of the shader engine
+            constexpr unsigned int VERTEX_BATCH_SIZE = 64;
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> batch_input;
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> batch_output;
+
+            const unsigned int num_vertices = regs.pipeline.num_vertices;
+            for (unsigned int first = 0; first < num_vertices; first += VERTEX_BATCH_SIZE) {
+                const unsigned int count = std::min(VERTEX_BATCH_SIZE, num_vertices - first);
+                for (unsigned int i = 0; i < count; ++i) {
+                    const unsigned int index = first + i;
+                    loader.LoadVertex(base_address, index, index + regs.pipeline.vertex_offset,
+                                      batch_input[i], memory_accesses);
                 }
 
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
+                shader_engine->RunBatch(g_state.vs, shader_unit, regs.vs, batch_input.data(),
+                                        batch_output.data(), count);
+
+                for (unsigned int i = 0; i < count; ++i) {
+                    g_state.geometry_pipeline.SubmitVertex(batch_output[i]);
                 }
+            }
+        } else {
+            if (is_indexed) {
+                vertex_cache.BeginDraw(VertexCacheKey(g_state, loader, base_address));
+            }
+
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                // Indexed rendering doesn't use the start offset
+                unsigned int vertex =
+                    is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                               : (index + regs.pipeline.vertex_offset);
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
+                bool vertex_cache_hit = false;
+
+                if (is_indexed) {
+                    if (g_state.geometry_pipeline.NeedIndexInput()) {
+                        g_state.geometry_pipeline.SubmitIndex(vertex);
+                        continue;
+                    }
+
+                    if (g_debug_context && Pica::g_debug_context->recorder) {
+                        int size = index_u16 ? 2 : 1;
+                        memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                                  size);
+                    }
+
+                    if (const auto* cached_output = vertex_cache.Lookup(vertex)) {
+                        vs_output = *cached_output;
                         vertex_cache_hit = true;
-                        break;
                     }
                 }
-            }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+                if (!vertex_cache_hit) {
+                    // Initialize data for the current vertex
+                    Shader::AttributeBuffer input;
+                    loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
 
-                // Send to vertex shader
-                if (g_debug_context)
-                    g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
+                    // Send to vertex shader
+                    if (g_debug_context)
+                        g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                                 (void*)&input);
+                    shader_unit.LoadInput(regs.vs, input);
+                    shader_engine->Run(g_state.vs, shader_unit);
+                    shader_unit.WriteOutput(regs.vs, vs_output);
 
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                    if (is_indexed) {
+                        vertex_cache.Insert(vertex, vs_output);
+                    }
                 }
+
+                // Send to geometry pipeline
+                g_state.geometry_pipeline.SubmitVertex(vs_output);
             }
 
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
+            if (is_indexed) {
+                MICROPROFILE_META_CPU("Vertex Cache Hits", vertex_cache.GetHits());
+                MICROPROFILE_META_CPU("Vertex Cache Misses", vertex_cache.GetMisses());
+            }
         }
 
         for (auto& range : memory_accesses.ranges) {
@@ -646,6 +708,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 }
 
 void ProcessCommandList(PAddr list, u32 size) {
+    // The emulated CPU may have modified vertex data since the previous command list
+    vertex_cache.Invalidate();
 
     u32* buffer = (u32*)VideoCore::g_memory->GetPhysicalPointer(list);
 
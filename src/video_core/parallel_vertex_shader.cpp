@@ -0,0 +1,134 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <numeric>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/microprofile.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/parallel_vertex_shader.h"
+#include "video_core/regs_rasterizer.h"
+#include "video_core/regs_shader.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+MICROPROFILE_DEFINE(GPU_ParallelVertexShading, "GPU", "Parallel Vertex Shading",
+                    MP_RGB(50, 100, 200));
+
+/// Number of distinct 16-bit vertex indices
+constexpr std::size_t NUM_INDICES = 0x10000;
+
+ParallelVertexShader::ParallelVertexShader(std::size_t num_threads)
+    : thread_pool(num_threads, "VertexShader"), index_slots(NUM_INDICES),
+      index_stamps(NUM_INDICES) {}
+
+ParallelVertexShader::~ParallelVertexShader() = default;
+
+void ParallelVertexShader::DeduplicateIndices(const std::vector<u32>& vertices) {
+    if (++draw_stamp == 0) {
+        // The stamp wrapped around, so old stamps could match again
+        std::fill(index_stamps.begin(), index_stamps.end(), 0);
+        draw_stamp = 1;
+    }
+
+    unique_vertices.clear();
+    slots.resize(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const u32 vertex = vertices[i];
+        ASSERT(vertex < NUM_INDICES);
+        if (index_stamps[vertex] != draw_stamp) {
+            index_stamps[vertex] = draw_stamp;
+            index_slots[vertex] = static_cast<u32>(unique_vertices.size());
+            unique_vertices.push_back(vertex);
+        }
+        slots[i] = index_slots[vertex];
+    }
+}
+
+/// Returns the output register components read by primitive assembly, four bits per register
+static u64 GetUsedOutputs(const ShaderRegs& config, const RasterizerRegs& rasterizer) {
+    const unsigned num_attributes = rasterizer.vs_output_total;
+    unsigned attribute = 0;
+    u64 used = 0;
+    for (int reg : Common::BitSet<u32>(config.output_mask)) {
+        if (attribute == num_attributes) {
+            break;
+        }
+        const auto& map = rasterizer.vs_output_attributes[attribute++];
+        const u32 semantics[] = {map.map_x, map.map_y, map.map_z, map.map_w};
+        for (int comp = 0; comp < 4; ++comp) {
+            if (semantics[comp] != RasterizerRegs::VSOutputAttributes::INVALID) {
+                used |= u64{1} << (reg * 4 + comp);
+            }
+        }
+    }
+    return used;
+}
+
+bool ParallelVertexShader::CanShade(Shader::ShaderSetup& setup, const ShaderRegs& config,
+                                    const RasterizerRegs& rasterizer) {
+    const unsigned entry_point = config.main_offset;
+    const auto key =
+        std::make_tuple(setup.GetProgramCodeHash(), setup.GetSwizzleDataHash(), entry_point);
+    auto usage = state_usages.find(key);
+    if (usage == state_usages.end()) {
+        usage = state_usages.emplace(key, Shader::AnalyzeStateUsage(setup, entry_point)).first;
+    }
+
+    if (usage->second.reads_unwritten_registers) {
+        return false;
+    }
+
+    // Input registers without an attribute keep the value of the previous vertex
+    u32 loaded_inputs = 0;
+    for (unsigned attr = 0; attr <= config.max_input_attribute_index; ++attr) {
+        loaded_inputs |= 1 << config.GetRegisterForAttribute(attr);
+    }
+    if ((usage->second.read_inputs & ~loaded_inputs) != 0) {
+        return false;
+    }
+
+    // So do output components the shader does not write on some paths
+    return (usage->second.unwritten_outputs & GetUsedOutputs(config, rasterizer)) == 0;
+}
+
+void ParallelVertexShader::Run(Shader::ShaderEngine& engine, const Shader::ShaderSetup& setup,
+                               const ShaderRegs& config, const Shader::UnitState& initial_state,
+                               const VertexLoader& loader, u32 base_address,
+                               const std::vector<u32>& vertices, bool is_indexed) {
+    MICROPROFILE_SCOPE(GPU_ParallelVertexShading);
+
+    if (is_indexed) {
+        DeduplicateIndices(vertices);
+    } else {
+        unique_vertices = vertices;
+        slots.resize(vertices.size());
+        std::iota(slots.begin(), slots.end(), 0);
+    }
+
+    const std::size_t num_vertices = unique_vertices.size();
+    inputs.resize(num_vertices);
+    outputs.resize(num_vertices);
+
+    const std::size_t num_chunks = (num_vertices + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    thread_pool.ParallelFor(num_chunks, [&](std::size_t chunk) {
+        const std::size_t first = chunk * CHUNK_SIZE;
+        const std::size_t count = std::min(CHUNK_SIZE, num_vertices - first);
+
+        // Loaders cache host pointers while loading, so every chunk uses its own copy
+        VertexLoader chunk_loader = loader;
+        DebugUtils::MemoryAccessTracker memory_accesses;
+        for (std::size_t i = first; i < first + count; ++i) {
+            chunk_loader.LoadVertex(base_address, static_cast<int>(i), unique_vertices[i],
+                                    inputs[i], memory_accesses);
+        }
+
+        Shader::UnitState state = initial_state;
+        engine.RunBatch(setup, state, config, &inputs[first], &outputs[first], count);
+    });
+}
+
+} // namespace Pica
@@ -0,0 +1,88 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_state_usage.h"
+
+namespace Pica {
+
+struct RasterizerRegs;
+struct ShaderRegs;
+class VertexLoader;
+
+/**
+ * Loads and shades the vertices of a draw on a pool of threads. The vertex stream is split into
+ * chunks that are shaded by separate shader units, each starting from a copy of the given unit
+ * state. This only produces the same output as serial shading if the shader uses no register left
+ * over from a previous vertex, which CanShade checks.
+ *
+ * Only the vertex shader stage is handled, so this must not be used while a geometry shader is
+ * active.
+ */
+class ParallelVertexShader {
+public:
+    /// Number of vertices shaded by one work item
+    static constexpr std::size_t CHUNK_SIZE = 64;
+
+    explicit ParallelVertexShader(std::size_t num_threads);
+    ~ParallelVertexShader();
+
+    std::size_t NumThreads() const {
+        return thread_pool.NumThreads();
+    }
+
+    /**
+     * Returns whether the shader set up for a draw only uses registers it writes itself, or inputs
+     * loaded with a vertex attribute, so that parallel shading produces the same output as serial
+     * shading. The shader is analyzed on first use.
+     */
+    bool CanShade(Shader::ShaderSetup& setup, const ShaderRegs& config,
+                  const RasterizerRegs& rasterizer);
+
+    /**
+     * Shades the vertices of a draw.
+     * @param vertices Index of the vertex at each position of the draw. If is_indexed is set, the
+     *                 indices are at most 16 bits wide and each distinct vertex is shaded once.
+     */
+    void Run(Shader::ShaderEngine& engine, const Shader::ShaderSetup& setup,
+             const ShaderRegs& config, const Shader::UnitState& initial_state,
+             const VertexLoader& loader, u32 base_address, const std::vector<u32>& vertices,
+             bool is_indexed);
+
+    /// Returns the shader output of the vertex at the given position of the last draw
+    const Shader::AttributeBuffer& GetOutput(std::size_t position) const {
+        return outputs[slots[position]];
+    }
+
+private:
+    /// Assigns each distinct vertex of an indexed draw its own output slot
+    void DeduplicateIndices(const std::vector<u32>& vertices);
+
+    Common::ThreadPool thread_pool;
+
+    /// Registers used by each analyzed shader, by program hash, swizzle hash and entry point
+    std::map<std::tuple<u64, u64, unsigned>, Shader::StateUsage> state_usages;
+
+    /// Distinct vertices to shade, in order of first use
+    std::vector<u32> unique_vertices;
+    /// Output slot of each position of the draw
+    std::vector<u32> slots;
+    std::vector<Shader::AttributeBuffer> inputs;
+    std::vector<Shader::AttributeBuffer> outputs;
+
+    /// Output slot of each vertex index, only valid if the stamp of the index matches draw_stamp
+    std::vector<u32> index_slots;
+    std::vector<u32> index_stamps;
+    u32 draw_stamp = 0;
+};
+
+} // namespace Pica
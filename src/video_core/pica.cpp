@@ -9,6 +9,7 @@
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
+#include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
 namespace Core {
@@ -28,6 +29,7 @@ void Init() {
 
 void Shutdown() {
     Shader::Shutdown();
+    VertexLoader::ClearJitCache();
 }
 
 template <typename T>
@@ -18,8 +18,11 @@ void RendererBase::UpdateCurrentFramebufferLayout() {
 
 void RendererBase::RefreshRasterizerSetting() {
     bool hw_renderer_enabled = VideoCore::g_hw_renderer_enabled;
-    if (rasterizer == nullptr || opengl_rasterizer_active != hw_renderer_enabled) {
+    u16 num_sw_threads = VideoCore::g_sw_rasterizer_threads;
+    if (rasterizer == nullptr || opengl_rasterizer_active != hw_renderer_enabled ||
+        (!hw_renderer_enabled && sw_rasterizer_threads != num_sw_threads)) {
         opengl_rasterizer_active = hw_renderer_enabled;
+        sw_rasterizer_threads = num_sw_threads;
 
         if (hw_renderer_enabled) {
             rasterizer = std::make_unique<OpenGL::RasterizerOpenGL>();
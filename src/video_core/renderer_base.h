@@ -74,4 +74,5 @@ protected:
 
 private:
     bool opengl_rasterizer_active = false;
+    u16 sw_rasterizer_threads = 0;
 };
@@ -631,13 +631,15 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
-                }
+            // Textures are stored from top to bottom, the buffer from bottom to top
+            const u32 rect_width = rect.GetWidth();
+            std::vector<u8> decoded(rect_width * rect.GetHeight() * 4);
+            Pica::Texture::DecodeTextureRect(
+                tex_info, texture_src_data, decoded.data(),
+                {rect.left, height - rect.top, rect.right, height - rect.bottom});
+            for (u32 row = 0; row < rect.GetHeight(); ++row) {
+                const std::size_t offset = (rect.left + width * (rect.top - 1 - row)) * 4;
+                std::memcpy(&gl_buffer[offset], &decoded[row * rect_width * 4], rect_width * 4);
             }
         } else {
             morton_to_gl_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
@@ -1787,6 +1789,7 @@ void RasterizerCacheOpenGL::ClearAll(bool flush) {
     // Remove the whole cache without really looking at it.
     cached_pages -= flush_interval;
     dirty_regions -= SurfaceInterval(0x0, 0xFFFFFFFF);
+    VideoCore::g_memory->RasterizerMarkRegionDirty(0x0, 0xFFFFFFFF, false);
     surface_cache -= SurfaceInterval(0x0, 0xFFFFFFFF);
     remove_surfaces.clear();
 }
@@ -1821,6 +1824,9 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surf
     }
     // Reset dirty regions
     dirty_regions -= flushed_intervals;
+    for (const auto& interval : flushed_intervals) {
+        UpdatePagesDirty(interval);
+    }
 }
 
 void RasterizerCacheOpenGL::FlushAll() {
@@ -1866,10 +1872,13 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         }
     }
 
-    if (region_owner != nullptr)
+    if (region_owner != nullptr) {
         dirty_regions.set({invalid_interval, region_owner});
-    else
+        VideoCore::g_memory->RasterizerMarkRegionDirty(addr, size, true);
+    } else {
         dirty_regions.erase(invalid_interval);
+        UpdatePagesDirty(invalid_interval);
+    }
 
     for (const auto& remove_surface : remove_surfaces) {
         if (remove_surface == region_owner) {
@@ -1955,4 +1964,18 @@ void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int del
         cached_pages.add({pages_interval, delta});
 }
 
+void RasterizerCacheOpenGL::UpdatePagesDirty(const SurfaceInterval& interval) {
+    const PAddr start = boost::icl::first(interval) & ~Memory::PAGE_MASK;
+    const u64 end = Common::AlignUp<u64>(boost::icl::last_next(interval), Memory::PAGE_SIZE);
+    const u32 size = static_cast<u32>(std::min<u64>(end, 0xFFFFFFFF) - start);
+
+    VideoCore::g_memory->RasterizerMarkRegionDirty(start, size, false);
+    const SurfaceInterval pages(start, start + size);
+    for (const auto& pair : RangeFromInterval(dirty_regions, pages)) {
+        const PAddr dirty_start = boost::icl::first(pair.first);
+        const u32 dirty_size = boost::icl::last_next(pair.first) - dirty_start;
+        VideoCore::g_memory->RasterizerMarkRegionDirty(dirty_start, dirty_size, true);
+    }
+}
+
 } // namespace OpenGL
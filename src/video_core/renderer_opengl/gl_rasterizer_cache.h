@@ -313,6 +313,10 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Marks the pages touching the interval as dirty if dirty_regions still overlaps them, so
+    /// that the CPU only flushes the cache before reading pages holding unflushed GPU writes
+    void UpdatePagesDirty(const SurfaceInterval& interval);
+
     SurfaceCache surface_cache;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
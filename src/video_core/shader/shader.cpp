@@ -14,6 +14,7 @@
 #include "video_core/shader/shader_interpreter.h"
 #ifdef ARCHITECTURE_x86_64
 #include "video_core/shader/shader_jit_x64.h"
+#include "video_core/shader/shader_jit_x64_disk_cache.h"
 #endif // ARCHITECTURE_x86_64
 #include "video_core/video_core.h"
 
@@ -132,6 +133,16 @@ void GSUnitState::ConfigOutput(const ShaderRegs& config) {
     emitter.output_mask = config.output_mask;
 }
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, UnitState& state, const ShaderRegs& config,
+                            const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                            std::size_t count) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        state.LoadInput(config, inputs[i]);
+        Run(setup, state);
+        state.WriteOutput(config, outputs[i]);
+    }
+}
+
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 
 #ifdef ARCHITECTURE_x86_64
@@ -145,7 +156,12 @@ ShaderEngine* GetEngine() {
     if (VideoCore::g_shader_jit_enabled) {
         if (jit_engine == nullptr) {
             jit_engine = std::make_unique<JitX64Engine>();
+            if (VideoCore::g_use_disk_shader_jit_cache) {
+                jit_engine->SetDiskCache(JitDiskCache::OpenForCurrentTitle());
+            }
         }
+        jit_engine->SetCacheBudget(std::size_t{VideoCore::g_shader_jit_cache_size} * 1024 * 1024);
+        jit_engine->SetAsyncCompilation(VideoCore::g_async_shader_jit);
         return jit_engine.get();
     }
 #endif // ARCHITECTURE_x86_64
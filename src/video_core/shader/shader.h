@@ -282,10 +282,17 @@ struct ShaderSetup {
 
     void MarkProgramCodeDirty() {
         program_code_hash_dirty = true;
+        ++data_version;
     }
 
     void MarkSwizzleDataDirty() {
         swizzle_data_hash_dirty = true;
+        ++data_version;
+    }
+
+    /// Returns a counter incremented whenever the program code or swizzle data changes
+    u64 GetDataVersion() const {
+        return data_version;
     }
 
     u64 GetProgramCodeHash() {
@@ -309,6 +316,7 @@ private:
     bool swizzle_data_hash_dirty = true;
     u64 program_code_hash = 0xDEADC0DE;
     u64 swizzle_data_hash = 0xDEADC0DE;
+    u64 data_version = 0;
 
     friend class boost::serialization::access;
     template <class Archive>
@@ -320,6 +328,9 @@ private:
         ar& swizzle_data_hash_dirty;
         ar& program_code_hash;
         ar& swizzle_data_hash;
+        if (Archive::is_loading::value) {
+            ++data_version;
+        }
     }
 };
 
@@ -340,6 +351,21 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader for each vertex of a batch, in order. This is equivalent to
+     * loading each input with UnitState::LoadInput, calling Run and storing the result with
+     * UnitState::WriteOutput, but engines may implement it with less overhead per vertex.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param state Shader unit state, carried over from one vertex to the next.
+     * @param config Shader configuration registers corresponding to the unit.
+     * @param inputs Input vertices, `count` elements.
+     * @param outputs Buffers receiving the output vertices, `count` elements.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, UnitState& state, const ShaderRegs& config,
+                          const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                          std::size_t count) const;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
@@ -2,39 +2,91 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/shader/shader_jit_x64_disk_cache.h"
 
 namespace Pica::Shader {
 
+/// Memory held by a cached shader. The code buffer is always allocated at its maximum size.
+constexpr std::size_t CACHE_ENTRY_SIZE = MAX_SHADER_SIZE + sizeof(ProgramCode) +
+                                         sizeof(SwizzleData) + sizeof(JitShader);
+
 JitX64Engine::JitX64Engine() = default;
-JitX64Engine::~JitX64Engine() = default;
+
+JitX64Engine::~JitX64Engine() {
+    if (compile_thread.joinable()) {
+        queued_jobs.Push(nullptr);
+        compile_thread.join();
+    }
+}
 
 void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
 
-    u64 code_hash = setup.GetProgramCodeHash();
-    u64 swizzle_hash = setup.GetSwizzleDataHash();
+    if (!pending_jobs.empty()) {
+        AddCompiledShaders();
+    }
 
-    u64 cache_key = code_hash ^ swizzle_hash;
-    auto iter = cache.find(cache_key);
-    if (iter != cache.end()) {
-        setup.engine_data.cached_shader = iter->second.get();
+    const CacheKey key{setup.GetProgramCodeHash(), setup.GetSwizzleDataHash()};
+
+    // The shader set up last time is still correct if the program didn't change since then
+    EntryIterator entry;
+    auto binding = bindings.find(&setup);
+    if (binding != bindings.end() && binding->second.entry->key == key &&
+        binding->second.data_version == setup.GetDataVersion()) {
+        entry = binding->second.entry;
     } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.engine_data.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        entry = FindShader(key, setup);
+    }
+
+    if (entry == entries.end() && async_compilation) {
+        if (auto shader = LoadShader(key, setup)) {
+            ++stats.misses;
+            entry = AddShader(key, setup.program_code, setup.swizzle_data, std::move(shader));
+        } else {
+            // Run on the interpreter until the shader is compiled
+            QueueCompilation(key, setup);
+            UnbindShader(setup);
+            setup.engine_data.cached_shader = nullptr;
+            ++stats.interpreted_setups;
+            return;
+        }
+    } else if (entry == entries.end()) {
+        ++stats.misses;
+        entry = CompileShader(key, setup);
+    } else {
+        ++stats.hits;
+        entries.splice(entries.begin(), entries, entry);
+    }
+
+    if (binding == bindings.end()) {
+        binding = bindings.emplace(&setup, Binding{entry, 0}).first;
+        ++entry->num_bindings;
+    } else if (binding->second.entry != entry) {
+        --binding->second.entry->num_bindings;
+        binding->second.entry = entry;
+        ++entry->num_bindings;
     }
+    binding->second.data_version = setup.GetDataVersion();
+    setup.engine_data.cached_shader = entry->shader.get();
+
+    EvictShaders();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
-    ASSERT(setup.engine_data.cached_shader != nullptr);
+    if (setup.engine_data.cached_shader == nullptr) {
+        interpreter.Run(setup, state);
+        return;
+    }
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
@@ -42,4 +94,186 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunBatch(const ShaderSetup& setup, UnitState& state, const ShaderRegs& config,
+                            const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                            std::size_t count) const {
+    if (setup.engine_data.cached_shader == nullptr) {
+        interpreter.RunBatch(setup, state, config, inputs, outputs, count);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.engine_data.cached_shader);
+    shader->RunBatch(setup, state, setup.engine_data.entry_point, config, inputs, outputs, count);
+}
+
+void JitX64Engine::SetCacheBudget(std::size_t bytes) {
+    cache_budget = bytes;
+}
+
+void JitX64Engine::SetDiskCache(std::unique_ptr<JitDiskCache> disk_cache_) {
+    disk_cache = std::move(disk_cache_);
+}
+
+void JitX64Engine::SetAsyncCompilation(bool enabled) {
+    async_compilation = enabled;
+    if (enabled && !compile_thread.joinable()) {
+        compile_thread = std::thread([this] { CompileThreadLoop(); });
+    }
+}
+
+void JitX64Engine::WaitForPendingCompilations() {
+    while (!pending_jobs.empty()) {
+        AddCompiledShader(finished_jobs.PopWait());
+    }
+}
+
+JitX64Engine::EntryIterator JitX64Engine::FindShader(const CacheKey& key,
+                                                     const ShaderSetup& setup) {
+    const auto [begin, end] = cache.equal_range(key);
+    for (auto it = begin; it != end; ++it) {
+        const CacheEntry& entry = *it->second;
+        if (entry.program_code == setup.program_code &&
+            entry.swizzle_data == setup.swizzle_data) {
+            return it->second;
+        }
+    }
+    return entries.end();
+}
+
+JitX64Engine::EntryIterator JitX64Engine::CompileShader(const CacheKey& key,
+                                                        const ShaderSetup& setup) {
+    auto shader = LoadShader(key, setup);
+    if (!shader) {
+        const auto start = std::chrono::steady_clock::now();
+        shader = std::make_unique<JitShader>();
+        shader->Compile(&setup.program_code, &setup.swizzle_data);
+        stats.compile_time += std::chrono::steady_clock::now() - start;
+
+        if (disk_cache) {
+            disk_cache->Save(key.program_code_hash, key.swizzle_data_hash, setup.program_code,
+                             setup.swizzle_data, shader->GetImage());
+        }
+    }
+    return AddShader(key, setup.program_code, setup.swizzle_data, std::move(shader));
+}
+
+std::unique_ptr<JitShader> JitX64Engine::LoadShader(const CacheKey& key,
+                                                    const ShaderSetup& setup) {
+    if (!disk_cache) {
+        return nullptr;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto image = disk_cache->Find(key.program_code_hash, key.swizzle_data_hash,
+                                        setup.program_code, setup.swizzle_data);
+    if (!image) {
+        return nullptr;
+    }
+    auto shader = std::make_unique<JitShader>();
+    if (!shader->Load(*image)) {
+        return nullptr;
+    }
+    stats.compile_time += std::chrono::steady_clock::now() - start;
+    ++stats.disk_hits;
+    return shader;
+}
+
+JitX64Engine::EntryIterator JitX64Engine::AddShader(const CacheKey& key,
+                                                    const ProgramCode& program_code,
+                                                    const SwizzleData& swizzle_data,
+                                                    std::unique_ptr<JitShader> shader) {
+    entries.push_front({key, std::move(shader), program_code, swizzle_data, 0});
+    cache.emplace(key, entries.begin());
+    ++stats.num_shaders;
+    stats.resident_bytes += CACHE_ENTRY_SIZE;
+    return entries.begin();
+}
+
+void JitX64Engine::EvictShaders() {
+    if (cache_budget == 0) {
+        return;
+    }
+
+    auto it = entries.end();
+    while (stats.resident_bytes > cache_budget && it != entries.begin()) {
+        --it;
+        if (it->num_bindings != 0) {
+            continue;
+        }
+
+        const auto [begin, end] = cache.equal_range(it->key);
+        for (auto cache_it = begin; cache_it != end; ++cache_it) {
+            if (cache_it->second == it) {
+                cache.erase(cache_it);
+                break;
+            }
+        }
+        it = entries.erase(it);
+        --stats.num_shaders;
+        stats.resident_bytes -= CACHE_ENTRY_SIZE;
+        ++stats.evictions;
+    }
+    LOG_TRACE(HW_GPU, "Shader cache holds {} shaders in {} bytes", stats.num_shaders,
+              stats.resident_bytes);
+}
+
+void JitX64Engine::QueueCompilation(const CacheKey& key, const ShaderSetup& setup) {
+    for (const CompileJob* job : pending_jobs) {
+        if (job->key == key && job->program_code == setup.program_code &&
+            job->swizzle_data == setup.swizzle_data) {
+            return;
+        }
+    }
+
+    ++stats.misses;
+    auto job = std::make_unique<CompileJob>();
+    job->key = key;
+    job->program_code = setup.program_code;
+    job->swizzle_data = setup.swizzle_data;
+    pending_jobs.push_back(job.get());
+    queued_jobs.Push(std::move(job));
+}
+
+void JitX64Engine::AddCompiledShaders() {
+    std::unique_ptr<CompileJob> job;
+    while (finished_jobs.Pop(job)) {
+        AddCompiledShader(std::move(job));
+    }
+}
+
+void JitX64Engine::AddCompiledShader(std::unique_ptr<CompileJob> job) {
+    pending_jobs.erase(std::find(pending_jobs.begin(), pending_jobs.end(), job.get()));
+    stats.compile_time += job->compile_time;
+
+    if (disk_cache) {
+        disk_cache->Save(job->key.program_code_hash, job->key.swizzle_data_hash,
+                         job->program_code, job->swizzle_data, job->shader->GetImage());
+    }
+    AddShader(job->key, job->program_code, job->swizzle_data, std::move(job->shader));
+    EvictShaders();
+}
+
+void JitX64Engine::UnbindShader(const ShaderSetup& setup) {
+    const auto binding = bindings.find(&setup);
+    if (binding != bindings.end()) {
+        --binding->second.entry->num_bindings;
+        bindings.erase(binding);
+    }
+}
+
+void JitX64Engine::CompileThreadLoop() {
+    Common::SetCurrentThreadName("ShaderJitCompiler");
+
+    std::unique_ptr<CompileJob> job;
+    while ((job = queued_jobs.PopWait())) {
+        const auto start = std::chrono::steady_clock::now();
+        job->shader = std::make_unique<JitShader>();
+        job->shader->Compile(&job->program_code, &job->swizzle_data);
+        job->compile_time = std::chrono::steady_clock::now() - start;
+        finished_jobs.Push(std::move(job));
+    }
+}
+
 } // namespace Pica::Shader
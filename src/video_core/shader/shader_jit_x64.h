@@ -4,25 +4,156 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <list>
 #include <memory>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
+#include "common/threadsafe_queue.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
 
 namespace Pica::Shader {
 
+class JitDiskCache;
 class JitShader;
 
 class JitX64Engine final : public ShaderEngine {
 public:
+    struct CacheStats {
+        u64 hits = 0;
+        u64 misses = 0;
+        u64 evictions = 0;
+        /// Misses served by loading the shader from the disk cache instead of compiling it
+        u64 disk_hits = 0;
+        /// Setups that ran on the interpreter while their shader was compiled in the background
+        u64 interpreted_setups = 0;
+        /// Total time spent compiling or loading shaders
+        std::chrono::nanoseconds compile_time{};
+        /// Number of shaders in the cache
+        std::size_t num_shaders = 0;
+        /// Memory held by the cached shaders, including their whole code buffers
+        std::size_t resident_bytes = 0;
+    };
+
     JitX64Engine();
     ~JitX64Engine() override;
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, UnitState& state, const ShaderRegs& config,
+                  const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                  std::size_t count) const override;
+
+    /**
+     * Sets the maximum amount of memory held by cached shaders, 0 for no limit. When exceeded, the
+     * least recently used shaders are evicted, except for those still set up for a ShaderSetup.
+     */
+    void SetCacheBudget(std::size_t bytes);
+
+    /**
+     * Sets the disk cache to load shaders from instead of compiling them, and to save newly
+     * compiled shaders to. nullptr disables the disk cache.
+     */
+    void SetDiskCache(std::unique_ptr<JitDiskCache> disk_cache);
+
+    /**
+     * Enables compiling shaders on a worker thread. A setup missing the cache then runs on the
+     * interpreter until its shader is compiled, instead of waiting for the compilation.
+     */
+    void SetAsyncCompilation(bool enabled);
+
+    /// Waits for all shaders compiling in the background and adds them to the cache
+    void WaitForPendingCompilations();
+
+    const CacheStats& GetCacheStats() const {
+        return stats;
+    }
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    struct CacheKey {
+        u64 program_code_hash;
+        u64 swizzle_data_hash;
+
+        bool operator==(const CacheKey& other) const {
+            return program_code_hash == other.program_code_hash &&
+                   swizzle_data_hash == other.swizzle_data_hash;
+        }
+    };
+
+    struct CacheKeyHash {
+        std::size_t operator()(const CacheKey& key) const {
+            return static_cast<std::size_t>(key.program_code_hash ^
+                                            (key.swizzle_data_hash * 0x9E3779B97F4A7C15));
+        }
+    };
+
+    struct CacheEntry {
+        CacheKey key;
+        std::unique_ptr<JitShader> shader;
+        /// Compiled program, compared on lookup to rule out hash collisions
+        ProgramCode program_code;
+        SwizzleData swizzle_data;
+        /// Number of ShaderSetups the shader is set up for
+        u32 num_bindings = 0;
+    };
+    using EntryIterator = std::list<CacheEntry>::iterator;
+
+    /// Shader set up for a ShaderSetup, and the data version of the setup at that time
+    struct Binding {
+        EntryIterator entry;
+        u64 data_version;
+    };
+
+    /// Shader compiled on the worker thread
+    struct CompileJob {
+        CacheKey key;
+        ProgramCode program_code;
+        SwizzleData swizzle_data;
+        std::unique_ptr<JitShader> shader;
+        std::chrono::nanoseconds compile_time{};
+    };
+
+    EntryIterator FindShader(const CacheKey& key, const ShaderSetup& setup);
+    EntryIterator CompileShader(const CacheKey& key, const ShaderSetup& setup);
+    /// Loads the shader from the disk cache. Returns nullptr if it isn't found there.
+    std::unique_ptr<JitShader> LoadShader(const CacheKey& key, const ShaderSetup& setup);
+    EntryIterator AddShader(const CacheKey& key, const ProgramCode& program_code,
+                            const SwizzleData& swizzle_data, std::unique_ptr<JitShader> shader);
+    void EvictShaders();
+
+    /// Queues the compilation of the shader, unless it is already compiling
+    void QueueCompilation(const CacheKey& key, const ShaderSetup& setup);
+    /// Adds the shaders finished by the worker thread to the cache
+    void AddCompiledShaders();
+    void AddCompiledShader(std::unique_ptr<CompileJob> job);
+    void UnbindShader(const ShaderSetup& setup);
+    void CompileThreadLoop();
+
+    /// Cached shaders, ordered from most to least recently used
+    std::list<CacheEntry> entries;
+    /// Shaders with colliding keys are told apart by their program
+    std::unordered_multimap<CacheKey, EntryIterator, CacheKeyHash> cache;
+    std::unordered_map<const ShaderSetup*, Binding> bindings;
+
+    std::unique_ptr<JitDiskCache> disk_cache;
+
+    /// Runs setups whose shader is compiling in the background
+    InterpreterEngine interpreter;
+
+    bool async_compilation = false;
+    std::thread compile_thread;
+    /// Jobs queued for the worker thread, a nullptr job stops it
+    Common::SPSCQueue<std::unique_ptr<CompileJob>> queued_jobs;
+    Common::SPSCQueue<std::unique_ptr<CompileJob>> finished_jobs;
+    /// Jobs queued or running on the worker thread. Only the program is read from them.
+    std::vector<const CompileJob*> pending_jobs;
+
+    std::size_t cache_budget = 0;
+    CacheStats stats;
 };
 
 } // namespace Pica::Shader
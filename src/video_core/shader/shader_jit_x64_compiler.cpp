@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <nihstro/shader_bytecode.h>
 #include <smmintrin.h>
 #include <xmmintrin.h>
@@ -118,6 +120,8 @@ static const Reg64 COND0 = r13;
 static const Reg64 COND1 = r14;
 /// Pointer to the UnitState instance for the current VS unit
 static const Reg64 STATE = r15;
+/// Pointer to the JitBatch being processed by the batch entry point
+static const Reg64 BATCH = rbp;
 /// SIMD scratch register
 static const Xmm SCRATCH = xmm0;
 /// Loaded with the first swizzled source register, otherwise can be used as a scratch register
@@ -164,11 +168,21 @@ static void LogCritical(const char* msg) {
 
 void JitShader::Compile_Assert(bool condition, const char* msg) {
     if (!condition) {
-        mov(ABI_PARAM1, reinterpret_cast<std::size_t>(msg));
-        CallFarFunction(*this, LogCritical);
+        Compile_LogCritical(msg);
     }
 }
 
+void JitShader::Compile_LogCritical(const char* msg) {
+    Label message, end;
+    lea(ABI_PARAM1, ptr[rip + message]);
+    call(qword[rip + log_critical_pointer]);
+    jmp(end);
+
+    L(message);
+    db(reinterpret_cast<const u8*>(msg), std::strlen(msg) + 1);
+    L(end);
+}
+
 /**
  * Loads and swizzles a source register into the specified XMM register.
  * @param instr VS instruction, used for determining how to load the source register
@@ -590,7 +604,7 @@ void JitShader::Compile_END(Instruction instr) {
     mov(dword[STATE + offsetof(UnitState, address_registers[1])], ADDROFFS_REG_1.cvt32());
     mov(dword[STATE + offsetof(UnitState, address_registers[2])], LOOPCOUNT_REG);
 
-    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    // Return to the entry point that called the program
     ret();
 }
 
@@ -788,8 +802,7 @@ void JitShader::Compile_EMIT(Instruction instr) {
     jnz(have_emitter);
 
     ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-    mov(ABI_PARAM1, reinterpret_cast<std::size_t>("Execute EMIT on VS"));
-    CallFarFunction(*this, LogCritical);
+    Compile_LogCritical("Execute EMIT on VS");
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     jmp(end);
 
@@ -798,7 +811,7 @@ void JitShader::Compile_EMIT(Instruction instr) {
     mov(ABI_PARAM1, rax);
     mov(ABI_PARAM2, STATE);
     add(ABI_PARAM2, static_cast<Xbyak::uint32>(offsetof(UnitState, registers.output)));
-    CallFarFunction(*this, Emit);
+    call(qword[rip + emit_pointer]);
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     L(end);
 }
@@ -810,8 +823,7 @@ void JitShader::Compile_SETE(Instruction instr) {
     jnz(have_emitter);
 
     ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-    mov(ABI_PARAM1, reinterpret_cast<std::size_t>("Execute SETEMIT on VS"));
-    CallFarFunction(*this, LogCritical);
+    Compile_LogCritical("Execute SETEMIT on VS");
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     jmp(end);
 
@@ -840,6 +852,34 @@ void JitShader::Compile_Return() {
     L(b);
 }
 
+void JitShader::Compile_LoadConstants() {
+    movaps(ONE, xword[rip + one_vector]);
+    movaps(NEGBIT, xword[rip + negbit_vector]);
+}
+
+void JitShader::Compile_LoadUnitState() {
+    // Load address/loop registers
+    movsxd(ADDROFFS_REG_0, dword[STATE + offsetof(UnitState, address_registers[0])]);
+    movsxd(ADDROFFS_REG_1, dword[STATE + offsetof(UnitState, address_registers[1])]);
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(UnitState, address_registers[2])]);
+    shl(ADDROFFS_REG_0, 4);
+    shl(ADDROFFS_REG_1, 4);
+    shl(LOOPCOUNT_REG, 4);
+
+    // Load conditional code
+    mov(COND0, byte[STATE + offsetof(UnitState, conditional_code[0])]);
+    mov(COND1, byte[STATE + offsetof(UnitState, conditional_code[1])]);
+}
+
+void JitShader::Compile_CallProgram(Reg64 entry) {
+    // Push a dummy return offset to catch any potential return checks (see Compile_Return) that
+    // happen in the shader main routine. Together with the return address, this keeps the stack
+    // aligned in the program.
+    push(qword, 0xFFFFFFFF);
+    call(entry);
+    add(rsp, 8);
+}
+
 void JitShader::Compile_NextInstr() {
     if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
         Compile_Return();
@@ -890,7 +930,6 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     swizzle_data = swizzle_data_;
 
     // Reset flow control state
-    program = (CompiledShader*)getCurr();
     program_counter = 0;
     looping = false;
     instruction_labels.fill(Xbyak::Label());
@@ -898,39 +937,97 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     // Find all `CALL` instructions and identify return locations
     FindReturnOffsets();
 
-    // The stack pointer is 8 modulo 16 at the entry of a procedure
-    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
-    // return checks (see Compile_Return) that happen in shader main routine.
-    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
-    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+    // Entry point running the program once.
+    // The stack pointer is 8 modulo 16 at the entry of a procedure, and is aligned again after
+    // saving the registers. It stays aligned in the program, as in its subroutines.
+    program = (CompiledShader*)getCurr();
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8);
 
     mov(UNIFORMS, ABI_PARAM1);
     mov(STATE, ABI_PARAM2);
+    Compile_LoadConstants();
+    Compile_LoadUnitState();
+    Compile_CallProgram(ABI_PARAM3.cvt64());
 
-    // Load address/loop registers
-    movsxd(ADDROFFS_REG_0, dword[STATE + offsetof(UnitState, address_registers[0])]);
-    movsxd(ADDROFFS_REG_1, dword[STATE + offsetof(UnitState, address_registers[1])]);
-    mov(LOOPCOUNT_REG, dword[STATE + offsetof(UnitState, address_registers[2])]);
-    shl(ADDROFFS_REG_0, 4);
-    shl(ADDROFFS_REG_1, 4);
-    shl(LOOPCOUNT_REG, 4);
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8);
+    ret();
 
-    // Load conditional code
-    mov(COND0, byte[STATE + offsetof(UnitState, conditional_code[0])]);
-    mov(COND1, byte[STATE + offsetof(UnitState, conditional_code[1])]);
+    // Entry point running the program for each vertex of a batch. The stack frame holds the start
+    // address, the number of remaining vertices and the current input and output buffers.
+    constexpr std::size_t BATCH_FRAME_SIZE = 32;
+    const auto start_address = qword[rsp];
+    const auto remaining = qword[rsp + 8];
+    const auto input = qword[rsp + 16];
+    const auto output = qword[rsp + 24];
 
-    // Used to set a register to one
-    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
-    mov(rax, reinterpret_cast<std::size_t>(&one));
-    movaps(ONE, xword[rax]);
+    batch_program = (CompiledBatch*)getCurr();
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, BATCH_FRAME_SIZE);
 
-    // Used to negate registers
-    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
-    mov(rax, reinterpret_cast<std::size_t>(&neg));
-    movaps(NEGBIT, xword[rax]);
+    // UNIFORMS aliases ABI_PARAM4 on Windows, so the batch is read first
+    mov(BATCH, ABI_PARAM4);
+    mov(start_address, ABI_PARAM3);
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+    Compile_LoadConstants();
+
+    mov(eax, dword[BATCH + offsetof(JitBatch, count)]);
+    mov(remaining, rax);
+    mov(rax, qword[BATCH + offsetof(JitBatch, inputs)]);
+    mov(input, rax);
+    mov(rax, qword[BATCH + offsetof(JitBatch, outputs)]);
+    mov(output, rax);
+
+    Label batch_loop, batch_end;
+    L(batch_loop);
+    cmp(remaining, 0);
+    je(batch_end);
+
+    // Load the input registers, as in UnitState::LoadInput
+    {
+        Label loop, end;
+        mov(rcx, input);
+        xor_(edx, edx);
+        L(loop);
+        cmp(edx, dword[BATCH + offsetof(JitBatch, num_inputs)]);
+        jae(end);
+        mov(eax, dword[BATCH + rdx * 4 + offsetof(JitBatch, input_offsets)]);
+        movaps(SCRATCH, xword[rcx]);
+        movaps(xword[STATE + rax], SCRATCH);
+        add(rcx, sizeof(Common::Vec4<float24>));
+        inc(edx);
+        jmp(loop);
+        L(end);
+    }
 
-    // Jump to start of the shader program
-    jmp(ABI_PARAM3);
+    Compile_LoadUnitState();
+    mov(rax, start_address);
+    Compile_CallProgram(rax);
+
+    // Store the output registers, as in UnitState::WriteOutput
+    {
+        Label loop, end;
+        mov(rcx, output);
+        xor_(edx, edx);
+        L(loop);
+        cmp(edx, dword[BATCH + offsetof(JitBatch, num_outputs)]);
+        jae(end);
+        mov(eax, dword[BATCH + rdx * 4 + offsetof(JitBatch, output_offsets)]);
+        movaps(SCRATCH, xword[STATE + rax]);
+        movaps(xword[rcx], SCRATCH);
+        add(rcx, sizeof(Common::Vec4<float24>));
+        inc(edx);
+        jmp(loop);
+        L(end);
+    }
+
+    add(input, sizeof(AttributeBuffer));
+    add(output, sizeof(AttributeBuffer));
+    dec(remaining);
+    jmp(batch_loop);
+    L(batch_end);
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, BATCH_FRAME_SIZE);
+    ret();
 
     // Compile entire program
     Compile_Block(static_cast<unsigned>(program_code->size()));
@@ -943,19 +1040,111 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
 
     ready();
 
+    for (std::size_t i = 0; i < instruction_labels.size(); ++i) {
+        instruction_offsets[i] = static_cast<u32>(instruction_labels[i].getAddress() - getCode());
+    }
+
     ASSERT_MSG(getSize() <= MAX_SHADER_SIZE, "Compiled a shader that exceeds the allocated size!");
     LOG_DEBUG(HW_GPU, "Compiled shader size={}", getSize());
 }
 
+JitShaderImage JitShader::GetImage() const {
+    JitShaderImage image;
+    image.code.assign(getCode(), getCode() + getSize());
+    image.program_offset = static_cast<u32>(reinterpret_cast<const u8*>(program) - getCode());
+    image.batch_program_offset =
+        static_cast<u32>(reinterpret_cast<const u8*>(batch_program) - getCode());
+    image.instruction_offsets = instruction_offsets;
+    return image;
+}
+
+bool JitShader::Load(const JitShaderImage& image) {
+    // The prelude emitted by the constructor must match the one the image was compiled with
+    const std::size_t prelude_size = getSize();
+    if (image.code.size() > MAX_SHADER_SIZE || image.code.size() < prelude_size ||
+        image.program_offset >= image.code.size() ||
+        image.batch_program_offset >= image.code.size()) {
+        return false;
+    }
+    for (u32 offset : image.instruction_offsets) {
+        if (offset >= image.code.size()) {
+            return false;
+        }
+    }
+
+    // Keep the host pointers of the prelude, everything else is position-independent
+    u8* code = const_cast<u8*>(getCode());
+    std::memcpy(code + prelude_size, image.code.data() + prelude_size,
+                image.code.size() - prelude_size);
+    setSize(image.code.size());
+
+    program = reinterpret_cast<CompiledShader*>(code + image.program_offset);
+    batch_program = reinterpret_cast<CompiledBatch*>(code + image.batch_program_offset);
+    instruction_offsets = image.instruction_offsets;
+    return true;
+}
+
+void JitShader::RunBatch(const ShaderSetup& setup, UnitState& state, unsigned offset,
+                         const ShaderRegs& config, const AttributeBuffer* inputs,
+                         AttributeBuffer* outputs, std::size_t count) const {
+    ASSERT(count <= std::numeric_limits<u32>::max());
+
+    JitBatch batch;
+    batch.inputs = inputs;
+    batch.outputs = outputs;
+    batch.count = static_cast<u32>(count);
+
+    batch.num_inputs = config.max_input_attribute_index + 1;
+    for (u32 attr = 0; attr < batch.num_inputs; ++attr) {
+        batch.input_offsets[attr] =
+            static_cast<u32>(offsetof(UnitState, registers.input) +
+                             config.GetRegisterForAttribute(attr) * sizeof(Common::Vec4<float24>));
+    }
+
+    batch.num_outputs = 0;
+    for (int reg : Common::BitSet<u32>(config.output_mask)) {
+        batch.output_offsets[batch.num_outputs++] = static_cast<u32>(
+            offsetof(UnitState, registers.output) + reg * sizeof(Common::Vec4<float24>));
+    }
+
+    batch_program(&setup.uniforms, &state, getCode() + instruction_offsets[offset], &batch);
+}
+
 JitShader::JitShader() : Xbyak::CodeGenerator(MAX_SHADER_SIZE) {
     CompilePrelude();
 }
 
 void JitShader::CompilePrelude() {
+    CompilePrelude_HostPointers();
+    CompilePrelude_Constants();
     log2_subroutine = CompilePrelude_Log2();
     exp2_subroutine = CompilePrelude_Exp2();
 }
 
+void JitShader::CompilePrelude_HostPointers() {
+    // Host functions are called through these slots, so that no host address is embedded in the
+    // code compiled after the prelude
+    align(8);
+    L(log_critical_pointer);
+    dq(reinterpret_cast<u64>(&LogCritical));
+    L(emit_pointer);
+    dq(reinterpret_cast<u64>(&Emit));
+}
+
+void JitShader::CompilePrelude_Constants() {
+    align(16);
+    // Used to set a register to one
+    L(one_vector);
+    for (int i = 0; i < 4; ++i) {
+        dd(0x3f800000);
+    }
+    // Used to negate registers
+    L(negbit_vector);
+    for (int i = 0; i < 4; ++i) {
+        dd(0x80000000);
+    }
+}
+
 Xbyak::Label JitShader::CompilePrelude_Log2() {
     Xbyak::Label subroutine;
 
@@ -24,6 +24,31 @@ namespace Pica::Shader {
 /// Memory allocated for each compiled shader
 constexpr std::size_t MAX_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 64;
 
+/// Vertices and register mappings of a batch processed by a single call into a compiled shader
+struct JitBatch {
+    const AttributeBuffer* inputs;
+    AttributeBuffer* outputs;
+    u32 count;
+    u32 num_inputs;
+    u32 num_outputs;
+    /// Offsets within UnitState of the input register loaded from each input attribute
+    std::array<u32, 16> input_offsets;
+    /// Offsets within UnitState of the output register stored to each output attribute
+    std::array<u32, 16> output_offsets;
+};
+
+/**
+ * Position-independent image of a compiled shader, as stored in the disk cache. Host addresses are
+ * only referenced through a pointer table in the prelude, which is rewritten when loading.
+ */
+struct JitShaderImage {
+    std::vector<u8> code;
+    u32 program_offset;
+    u32 batch_program_offset;
+    /// Offset in code of each Pica VS instruction
+    std::array<u32, MAX_PROGRAM_CODE_LENGTH> instruction_offsets;
+};
+
 /**
  * This class implements the shader JIT compiler. It recompiles a Pica shader program into x86_64
  * code that can be executed on the host machine directly.
@@ -33,12 +58,30 @@ public:
     JitShader();
 
     void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
-        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+        program(&setup.uniforms, &state, getCode() + instruction_offsets[offset]);
     }
 
+    /**
+     * Runs the shader for each vertex of a batch. This is equivalent to calling
+     * UnitState::LoadInput, Run and UnitState::WriteOutput for every vertex in order, while the
+     * uniforms and constants stay loaded in host registers for the whole batch.
+     */
+    void RunBatch(const ShaderSetup& setup, UnitState& state, unsigned offset,
+                  const ShaderRegs& config, const AttributeBuffer* inputs,
+                  AttributeBuffer* outputs, std::size_t count) const;
+
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
                  const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
 
+    /// Returns the image of the compiled shader, to be loaded by another JitShader with Load
+    JitShaderImage GetImage() const;
+
+    /**
+     * Loads a shader compiled by the same build of the emulator, instead of compiling it.
+     * @return false if the image is not valid for this build
+     */
+    bool Load(const JitShaderImage& image);
+
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
     void Compile_DP4(Instruction instr);
@@ -100,6 +143,26 @@ private:
      */
     void Compile_Assert(bool condition, const char* msg);
 
+    /**
+     * Emits the code to log a critical error. The message is stored inline in the code.
+     */
+    void Compile_LogCritical(const char* msg);
+
+    /**
+     * Emits the code to load the constant vectors ONE and NEGBIT.
+     */
+    void Compile_LoadConstants();
+
+    /**
+     * Emits the code to load the address registers and conditional code from the unit state.
+     */
+    void Compile_LoadUnitState();
+
+    /**
+     * Emits the code to call the shader program at `entry`, which returns once it reaches END.
+     */
+    void Compile_CallProgram(Xbyak::Reg64 entry);
+
     /**
      * Analyzes the entire shader program for `CALL` instructions before emitting any code,
      * identifying the locations where a return needs to be inserted.
@@ -110,6 +173,8 @@ private:
      * Emits data and code for utility functions.
      */
     void CompilePrelude();
+    void CompilePrelude_HostPointers();
+    void CompilePrelude_Constants();
     Xbyak::Label CompilePrelude_Log2();
     Xbyak::Label CompilePrelude_Exp2();
 
@@ -119,6 +184,9 @@ private:
     /// Mapping of Pica VS instructions to pointers in the emitted code
     std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
 
+    /// Offset in the code of each Pica VS instruction, kept after compilation or loading
+    std::array<u32, MAX_PROGRAM_CODE_LENGTH> instruction_offsets{};
+
     /// Label pointing to the end of the current LOOP block. Used by the BREAKC instruction to break
     /// out of the loop.
     std::optional<Xbyak::Label> loop_break_label;
@@ -132,8 +200,20 @@ private:
     using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
     CompiledShader* program = nullptr;
 
+    using CompiledBatch = void(const void* setup, void* state, const u8* start_addr,
+                               const JitBatch* batch);
+    CompiledBatch* batch_program = nullptr;
+
     Xbyak::Label log2_subroutine;
     Xbyak::Label exp2_subroutine;
+
+    /// Slots in the prelude holding the host functions called by the compiled code
+    Xbyak::Label log_critical_pointer;
+    Xbyak::Label emit_pointer;
+
+    /// Constant vectors loaded into ONE and NEGBIT
+    Xbyak::Label one_vector;
+    Xbyak::Label negbit_vector;
 };
 
 } // namespace Pica::Shader
@@ -0,0 +1,234 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/x64/cpu_detect.h"
+#include "common/zstd_compression.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/shader/shader_jit_x64_disk_cache.h"
+
+namespace Pica::Shader {
+
+constexpr u32 NativeVersion = 1;
+
+constexpr std::size_t HASH_LENGTH = 64;
+using ShaderCacheVersionHash = std::array<u8, HASH_LENGTH>;
+
+enum class EntryKind : u32 {
+    Compiled,
+};
+
+static ShaderCacheVersionHash GetShaderCacheVersionHash() {
+    ShaderCacheVersionHash hash{};
+    const std::size_t length = std::min(std::strlen(Common::g_shader_cache_version), hash.size());
+    std::memcpy(hash.data(), Common::g_shader_cache_version, length);
+    return hash;
+}
+
+/// Returns the host CPU features, as the compiled code depends on them
+static u32 GetHostFeatures() {
+    const auto& caps = Common::GetCPUCaps();
+    u32 mask = 0;
+    int bit = 0;
+    for (bool feature : {caps.sse, caps.sse2, caps.sse3, caps.ssse3, caps.sse4_1, caps.sse4_2,
+                         caps.avx, caps.avx2, caps.bmi1, caps.bmi2, caps.fma, caps.fma4,
+                         caps.aes}) {
+        mask |= static_cast<u32>(feature) << bit++;
+    }
+    return mask;
+}
+
+template <typename T>
+static void AppendObject(std::vector<u8>& buffer, const T& object) {
+    const u8* data = reinterpret_cast<const u8*>(&object);
+    buffer.insert(buffer.end(), data, data + sizeof(T));
+}
+
+template <typename T>
+static bool ReadObject(const std::vector<u8>& buffer, std::size_t& offset, T& object) {
+    if (buffer.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&object, buffer.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+JitDiskCache::JitDiskCache(std::string path_) : path{std::move(path_)} {
+    if (!FileUtil::Exists(path)) {
+        return;
+    }
+    if (!LoadFile()) {
+        LOG_INFO(HW_GPU, "Discarding shader JIT cache file={}", path);
+        Invalidate();
+        return;
+    }
+    LOG_INFO(HW_GPU, "Found a shader JIT cache with {} entries", entries.size());
+}
+
+JitDiskCache::~JitDiskCache() = default;
+
+std::unique_ptr<JitDiskCache> JitDiskCache::OpenForCurrentTitle() {
+    Core::System& system = Core::System::GetInstance();
+    u64 program_id{};
+    if (!system.IsPoweredOn() ||
+        system.GetAppLoader().ReadProgramId(program_id) != Loader::ResultStatus::Success ||
+        program_id == 0) {
+        return nullptr;
+    }
+
+    const std::string dir = FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + "jit_x64";
+    if (!FileUtil::CreateFullPath(dir + DIR_SEP)) {
+        LOG_ERROR(HW_GPU, "Failed to create directory={}", dir);
+        return nullptr;
+    }
+    return std::make_unique<JitDiskCache>(
+        FileUtil::SanitizePath(fmt::format("{}{}{:016X}.bin", dir, DIR_SEP, program_id)));
+}
+
+bool JitDiskCache::LoadFile() {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    u32 version{};
+    ShaderCacheVersionHash version_hash{};
+    u32 host_features{};
+    if (file.ReadBytes(&version, sizeof(version)) != sizeof(version) ||
+        file.ReadBytes(version_hash.data(), version_hash.size()) != version_hash.size() ||
+        file.ReadBytes(&host_features, sizeof(host_features)) != sizeof(host_features)) {
+        LOG_ERROR(HW_GPU, "Failed to read shader JIT cache header");
+        return false;
+    }
+    if (version != NativeVersion || version_hash != GetShaderCacheVersionHash()) {
+        LOG_INFO(HW_GPU, "Shader JIT cache is from another version of the emulator");
+        return false;
+    }
+    if (host_features != GetHostFeatures()) {
+        LOG_INFO(HW_GPU, "Shader JIT cache was compiled for another host CPU");
+        return false;
+    }
+
+    while (file.Tell() < file.GetSize()) {
+        EntryKind kind{};
+        u64 program_code_hash{};
+        u64 swizzle_data_hash{};
+        u32 compressed_size{};
+        if (file.ReadBytes(&kind, sizeof(kind)) != sizeof(kind) ||
+            file.ReadBytes(&program_code_hash, sizeof(u64)) != sizeof(u64) ||
+            file.ReadBytes(&swizzle_data_hash, sizeof(u64)) != sizeof(u64) ||
+            file.ReadBytes(&compressed_size, sizeof(u32)) != sizeof(u32)) {
+            LOG_ERROR(HW_GPU, "Failed to read shader JIT cache entry");
+            return false;
+        }
+        if (kind != EntryKind::Compiled || compressed_size > file.GetSize() - file.Tell()) {
+            LOG_ERROR(HW_GPU, "Invalid shader JIT cache entry kind={}", static_cast<u32>(kind));
+            return false;
+        }
+
+        std::vector<u8> compressed(compressed_size);
+        if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+            LOG_ERROR(HW_GPU, "Failed to read shader JIT cache entry");
+            return false;
+        }
+        entries.emplace(std::make_pair(program_code_hash, swizzle_data_hash),
+                        std::move(compressed));
+    }
+    return true;
+}
+
+std::optional<JitShaderImage> JitDiskCache::Find(u64 program_code_hash, u64 swizzle_data_hash,
+                                                 const ProgramCode& program_code,
+                                                 const SwizzleData& swizzle_data) const {
+    const auto [begin, end] = entries.equal_range({program_code_hash, swizzle_data_hash});
+    for (auto it = begin; it != end; ++it) {
+        const std::vector<u8> data = Common::Compression::DecompressDataZSTD(it->second);
+
+        std::size_t offset = 0;
+        ProgramCode entry_program_code;
+        SwizzleData entry_swizzle_data;
+        JitShaderImage image;
+        u32 code_size{};
+        if (!ReadObject(data, offset, entry_program_code) ||
+            !ReadObject(data, offset, entry_swizzle_data) ||
+            !ReadObject(data, offset, image.program_offset) ||
+            !ReadObject(data, offset, image.batch_program_offset) ||
+            !ReadObject(data, offset, image.instruction_offsets) ||
+            !ReadObject(data, offset, code_size) || data.size() - offset != code_size) {
+            LOG_ERROR(HW_GPU, "Corrupted shader JIT cache entry");
+            continue;
+        }
+
+        // Shaders with colliding hashes are told apart by their program
+        if (entry_program_code != program_code || entry_swizzle_data != swizzle_data) {
+            continue;
+        }
+
+        image.code.assign(data.begin() + offset, data.end());
+        return image;
+    }
+    return std::nullopt;
+}
+
+void JitDiskCache::Save(u64 program_code_hash, u64 swizzle_data_hash,
+                        const ProgramCode& program_code, const SwizzleData& swizzle_data,
+                        const JitShaderImage& image) {
+    std::vector<u8> data;
+    AppendObject(data, program_code);
+    AppendObject(data, swizzle_data);
+    AppendObject(data, image.program_offset);
+    AppendObject(data, image.batch_program_offset);
+    AppendObject(data, image.instruction_offsets);
+    AppendObject(data, static_cast<u32>(image.code.size()));
+    data.insert(data.end(), image.code.begin(), image.code.end());
+    std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTDDefault(data.data(), data.size());
+
+    const bool existed = FileUtil::Exists(path);
+    FileUtil::IOFile file(path, "ab");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to open shader JIT cache in path={}", path);
+        return;
+    }
+
+    bool written = true;
+    if (!existed || file.GetSize() == 0) {
+        const auto version_hash = GetShaderCacheVersionHash();
+        written = file.WriteObject(NativeVersion) == 1 &&
+                  file.WriteArray(version_hash.data(), version_hash.size()) ==
+                      version_hash.size() &&
+                  file.WriteObject(GetHostFeatures()) == 1;
+    }
+    written = written && file.WriteObject(EntryKind::Compiled) == 1 &&
+              file.WriteObject(program_code_hash) == 1 &&
+              file.WriteObject(swizzle_data_hash) == 1 &&
+              file.WriteObject(static_cast<u32>(compressed.size())) == 1 &&
+              file.WriteBytes(compressed.data(), compressed.size()) == compressed.size();
+    if (!written) {
+        LOG_ERROR(HW_GPU, "Failed to save shader JIT cache entry - removing");
+        file.Close();
+        Invalidate();
+        return;
+    }
+    entries.emplace(std::make_pair(program_code_hash, swizzle_data_hash), std::move(compressed));
+}
+
+void JitDiskCache::Invalidate() {
+    entries.clear();
+    if (FileUtil::Exists(path) && !FileUtil::Delete(path)) {
+        LOG_ERROR(HW_GPU, "Failed to invalidate shader JIT cache file={}", path);
+    }
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,61 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica::Shader {
+
+struct JitShaderImage;
+
+/**
+ * Per-title cache of the shaders compiled by the x64 JIT, so that they can be loaded instead of
+ * recompiled on later boots. Entries are appended to the cache file as shaders get compiled. The
+ * whole file is discarded if it was written by another version of the emulator or on a host CPU
+ * with different features.
+ */
+class JitDiskCache {
+public:
+    /// Opens the cache file at the given path, creating it if it doesn't exist
+    explicit JitDiskCache(std::string path);
+    ~JitDiskCache();
+
+    /// Opens the cache of the running title. Returns nullptr if the title has no title id.
+    static std::unique_ptr<JitDiskCache> OpenForCurrentTitle();
+
+    /// Looks up the image of a shader compiled from the given program
+    std::optional<JitShaderImage> Find(u64 program_code_hash, u64 swizzle_data_hash,
+                                       const ProgramCode& program_code,
+                                       const SwizzleData& swizzle_data) const;
+
+    /// Appends the image of a newly compiled shader to the cache file
+    void Save(u64 program_code_hash, u64 swizzle_data_hash, const ProgramCode& program_code,
+              const SwizzleData& swizzle_data, const JitShaderImage& image);
+
+    std::size_t GetEntryCount() const {
+        return entries.size();
+    }
+
+private:
+    /// Loads the entries of the cache file. Returns false if the file must be discarded.
+    bool LoadFile();
+
+    /// Removes the cache file and all loaded entries
+    void Invalidate();
+
+    std::string path;
+
+    /// Compressed entries, keyed by the program and swizzle data hashes
+    std::multimap<std::pair<u64, u64>, std::vector<u8>> entries;
+};
+
+} // namespace Pica::Shader
@@ -0,0 +1,495 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_state_usage.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::RegisterType;
+using nihstro::SourceRegister;
+using nihstro::SwizzlePattern;
+
+namespace Pica::Shader {
+
+namespace {
+
+/// Matches the size of the call stack of the interpreter
+constexpr std::size_t MAX_SCOPES = 16;
+
+/// Bounds the time spent on pathological programs, which are then treated as not analyzable
+constexpr std::size_t MAX_STEPS = 1 << 20;
+
+/// Registers written on every path that leads to an instruction
+struct WrittenRegisters {
+    u64 temporaries = 0; ///< Four bits per register
+    u64 outputs = 0;     ///< Four bits per register
+    u8 address = 0;      ///< a0.x, a0.y and aL
+    u8 conditional = 0;  ///< One bit per conditional code
+
+    WrittenRegisters& operator&=(const WrittenRegisters& other) {
+        temporaries &= other.temporaries;
+        outputs &= other.outputs;
+        address &= other.address;
+        conditional &= other.conditional;
+        return *this;
+    }
+
+    /// Returns whether all the registers written in other are also written in this
+    bool Includes(const WrittenRegisters& other) const {
+        return (other.temporaries & ~temporaries) == 0 && (other.outputs & ~outputs) == 0 &&
+               (other.address & ~address) == 0 && (other.conditional & ~conditional) == 0;
+    }
+};
+
+/// Entry of the call stack of the interpreter: a subroutine, a branch of an IF or a LOOP body
+struct Scope {
+    u32 final_address;
+    u32 return_address;
+    u32 loop_address;
+    bool is_loop;
+};
+
+struct Path {
+    u32 program_counter;
+    std::vector<Scope> scopes;
+    WrittenRegisters written;
+};
+
+/// Returns the components selected by the given lanes of a source operand, as a 4 bit mask
+template <SwizzlePattern::Selector (SwizzlePattern::*getter)(int) const>
+u32 SelectedComponents(const SwizzlePattern& swizzle, u32 lanes) {
+    u32 components = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+        if (lanes & (1 << lane)) {
+            components |= 1 << static_cast<u32>((swizzle.*getter)(lane));
+        }
+    }
+    return components;
+}
+
+/**
+ * Walks every path through a shader program, following the control flow of the interpreter but
+ * taking both sides of each condition and repeating each loop any number of times. A path is only
+ * explored again from an instruction if it reaches it with fewer registers written than before,
+ * so this terminates even though programs may loop.
+ */
+class StateUsageAnalyzer {
+public:
+    explicit StateUsageAnalyzer(const ShaderSetup& setup)
+        : program_code(setup.program_code), swizzle_data(setup.swizzle_data) {}
+
+    StateUsage Analyze(unsigned entry_point) {
+        pending.push_back({entry_point, {}, {}});
+        while (!pending.empty() && !failed) {
+            Path path = std::move(pending.back());
+            pending.pop_back();
+            Explore(std::move(path));
+        }
+
+        if (failed) {
+            return {};
+        }
+        StateUsage usage;
+        usage.reads_unwritten_registers = false;
+        usage.read_inputs = read_inputs;
+        usage.unwritten_outputs = unwritten_outputs;
+        return usage;
+    }
+
+private:
+    void Explore(Path path) {
+        while (!failed) {
+            if (++steps > MAX_STEPS) {
+                failed = true;
+                return;
+            }
+
+            // Like the interpreter, leave the scope ending here before executing the instruction
+            if (!path.scopes.empty() &&
+                path.program_counter == path.scopes.back().final_address) {
+                const Scope scope = path.scopes.back();
+                if (scope.is_loop) {
+                    Path repeat = path;
+                    repeat.program_counter = scope.loop_address;
+                    pending.push_back(std::move(repeat));
+                }
+                path.program_counter = scope.return_address;
+                path.scopes.pop_back();
+                continue;
+            }
+
+            if (!Visit(path)) {
+                return;
+            }
+            if (path.program_counter >= MAX_PROGRAM_CODE_LENGTH) {
+                failed = true;
+                return;
+            }
+
+            const Instruction instr = {program_code[path.program_counter]};
+            switch (instr.opcode.Value().GetInfo().type) {
+            case OpCode::Type::Arithmetic:
+                failed = !ExecuteArithmetic(instr, path.written);
+                ++path.program_counter;
+                break;
+            case OpCode::Type::MultiplyAdd:
+                failed = !ExecuteMultiplyAdd(instr, path.written);
+                ++path.program_counter;
+                break;
+            default:
+                if (!ExecuteFlowControl(instr, path)) {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+
+    /**
+     * Records that a path reached its current instruction, keeping for each instruction and call
+     * stack only the registers written on every path that reached it.
+     * @returns Whether the path needs to be explored further
+     */
+    bool Visit(Path& path) {
+        std::vector<u32> key{path.program_counter};
+        for (const Scope& scope : path.scopes) {
+            key.push_back(scope.final_address);
+            key.push_back(scope.return_address);
+            key.push_back(scope.is_loop ? scope.loop_address : ~0u);
+        }
+
+        const auto [it, inserted] = visited.emplace(std::move(key), path.written);
+        if (inserted) {
+            return true;
+        }
+        if (path.written.Includes(it->second)) {
+            return false;
+        }
+        it->second &= path.written;
+        path.written = it->second;
+        return true;
+    }
+
+    /**
+     * Records the read of the given components of a source register.
+     * @param address_register_index Address register offsetting the source, 0 for none
+     * @returns Whether the components were written before
+     */
+    bool ReadSource(SourceRegister reg, u32 components, u32 address_register_index,
+                    const WrittenRegisters& written) {
+        if (address_register_index != 0) {
+            // Offsets are only tracked for uniforms, other registers could be any of the unit
+            if (reg.GetRegisterType() != RegisterType::FloatUniform) {
+                return false;
+            }
+            const u8 address_register = 1 << (address_register_index - 1);
+            if ((written.address & address_register) == 0) {
+                return false;
+            }
+        }
+
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Input:
+            read_inputs |= 1 << reg.GetIndex();
+            return true;
+        case RegisterType::Temporary: {
+            const u64 mask = u64{components} << (reg.GetIndex() * 4);
+            return (written.temporaries & mask) == mask;
+        }
+        case RegisterType::FloatUniform:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    template <typename DestRegister>
+    static void WriteDest(DestRegister dest, u32 components, WrittenRegisters& written) {
+        if (dest < 0x10) {
+            written.outputs |= u64{components} << (dest.GetIndex() * 4);
+        } else if (dest < 0x20) {
+            written.temporaries |= u64{components} << (dest.GetIndex() * 4);
+        }
+    }
+
+    bool ExecuteArithmetic(Instruction instr, WrittenRegisters& written) {
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+        u32 dest_lanes = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (swizzle.DestComponentEnabled(i)) {
+                dest_lanes |= 1 << i;
+            }
+        }
+
+        // Lanes of each source that contribute to the result
+        u32 src1_lanes = 0;
+        u32 src2_lanes = 0;
+        switch (instr.opcode.Value().EffectiveOpCode()) {
+        case OpCode::Id::ADD:
+        case OpCode::Id::MUL:
+        case OpCode::Id::MAX:
+        case OpCode::Id::MIN:
+        case OpCode::Id::SGE:
+        case OpCode::Id::SGEI:
+        case OpCode::Id::SLT:
+        case OpCode::Id::SLTI:
+            src1_lanes = src2_lanes = dest_lanes;
+            break;
+        case OpCode::Id::FLR:
+        case OpCode::Id::MOV:
+            src1_lanes = dest_lanes;
+            break;
+        case OpCode::Id::DP3:
+            src1_lanes = src2_lanes = 0b0111;
+            break;
+        case OpCode::Id::DP4:
+            src1_lanes = src2_lanes = 0b1111;
+            break;
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            src1_lanes = 0b0111;
+            src2_lanes = 0b1111;
+            break;
+        case OpCode::Id::RCP:
+        case OpCode::Id::RSQ:
+        case OpCode::Id::EX2:
+        case OpCode::Id::LG2:
+            src1_lanes = 0b0001;
+            break;
+        case OpCode::Id::MOVA:
+            src1_lanes = dest_lanes & 0b0011;
+            break;
+        case OpCode::Id::CMP:
+            src1_lanes = src2_lanes = 0b0011;
+            break;
+        default:
+            return false;
+        }
+
+        const u32 address_register_index = instr.common.address_register_index;
+        if (!ReadSource(instr.common.GetSrc1(is_inverted),
+                        SelectedComponents<&SwizzlePattern::GetSelectorSrc1>(swizzle, src1_lanes),
+                        is_inverted ? 0 : address_register_index, written)) {
+            return false;
+        }
+        if (src2_lanes != 0 &&
+            !ReadSource(instr.common.GetSrc2(is_inverted),
+                        SelectedComponents<&SwizzlePattern::GetSelectorSrc2>(swizzle, src2_lanes),
+                        is_inverted ? address_register_index : 0, written)) {
+            return false;
+        }
+
+        switch (instr.opcode.Value().EffectiveOpCode()) {
+        case OpCode::Id::MOVA:
+            written.address |= dest_lanes & 0b0011;
+            break;
+        case OpCode::Id::CMP: {
+            // Unknown comparisons leave the conditional code unchanged
+            using CompareOp = Instruction::Common::CompareOpType::Op;
+            const auto is_known = [](CompareOp op) { return op <= CompareOp::GreaterEqual; };
+            if (is_known(instr.common.compare_op.x.Value())) {
+                written.conditional |= 0b01;
+            }
+            if (is_known(instr.common.compare_op.y.Value())) {
+                written.conditional |= 0b10;
+            }
+            break;
+        }
+        default:
+            WriteDest(instr.common.dest.Value(), dest_lanes, written);
+            break;
+        }
+        return true;
+    }
+
+    bool ExecuteMultiplyAdd(Instruction instr, WrittenRegisters& written) {
+        const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+        if (opcode != OpCode::Id::MAD && opcode != OpCode::Id::MADI) {
+            return false;
+        }
+
+        const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+        const bool is_inverted = opcode == OpCode::Id::MADI;
+
+        u32 lanes = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (swizzle.DestComponentEnabled(i)) {
+                lanes |= 1 << i;
+            }
+        }
+
+        const u32 address_register_index = instr.mad.address_register_index;
+        if (!ReadSource(instr.mad.GetSrc1(is_inverted),
+                        SelectedComponents<&SwizzlePattern::GetSelectorSrc1>(swizzle, lanes), 0,
+                        written) ||
+            !ReadSource(instr.mad.GetSrc2(is_inverted),
+                        SelectedComponents<&SwizzlePattern::GetSelectorSrc2>(swizzle, lanes),
+                        is_inverted ? 0 : address_register_index, written) ||
+            !ReadSource(instr.mad.GetSrc3(is_inverted),
+                        SelectedComponents<&SwizzlePattern::GetSelectorSrc3>(swizzle, lanes),
+                        is_inverted ? address_register_index : 0, written)) {
+            return false;
+        }
+
+        WriteDest(instr.mad.dest.Value(), lanes, written);
+        return true;
+    }
+
+    /// Returns whether the conditional codes tested by a flow control instruction were written
+    static bool ReadsWrittenConditions(Instruction::FlowControlType flow_control,
+                                       const WrittenRegisters& written) {
+        using Op = Instruction::FlowControlType::Op;
+
+        u8 codes;
+        switch (flow_control.op) {
+        case Op::Or:
+        case Op::And:
+            codes = 0b11;
+            break;
+        case Op::JustX:
+            codes = 0b01;
+            break;
+        case Op::JustY:
+            codes = 0b10;
+            break;
+        default:
+            return false;
+        }
+        return (written.conditional & codes) == codes;
+    }
+
+    /// Enters a scope, like the call function of the interpreter
+    bool Call(Path& path, u32 offset, u32 num_instructions, u32 return_offset, bool is_loop) {
+        if (path.scopes.size() >= MAX_SCOPES) {
+            failed = true;
+            return false;
+        }
+        path.scopes.push_back({offset + num_instructions, return_offset, offset, is_loop});
+        path.program_counter = offset;
+        return true;
+    }
+
+    /**
+     * Executes a flow control instruction, queueing the paths it branches to.
+     * @returns Whether the path continues at path.program_counter
+     */
+    bool ExecuteFlowControl(Instruction instr, Path& path) {
+        const auto& flow_control = instr.flow_control;
+        const u32 pc = path.program_counter;
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            unwritten_outputs |= ~path.written.outputs;
+            return false;
+
+        case OpCode::Id::NOP:
+            ++path.program_counter;
+            return true;
+
+        case OpCode::Id::JMPC:
+        case OpCode::Id::JMPU:
+            if (instr.opcode.Value() == OpCode::Id::JMPC &&
+                !ReadsWrittenConditions(flow_control, path.written)) {
+                failed = true;
+                return false;
+            }
+            pending.push_back({flow_control.dest_offset, path.scopes, path.written});
+            ++path.program_counter;
+            return true;
+
+        case OpCode::Id::CALL:
+            return Call(path, flow_control.dest_offset, flow_control.num_instructions, pc + 1,
+                        false);
+
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            if (instr.opcode.Value() == OpCode::Id::CALLC &&
+                !ReadsWrittenConditions(flow_control, path.written)) {
+                failed = true;
+                return false;
+            }
+            pending.push_back({pc + 1, path.scopes, path.written});
+            return Call(path, flow_control.dest_offset, flow_control.num_instructions, pc + 1,
+                        false);
+
+        case OpCode::Id::IFC:
+        case OpCode::Id::IFU: {
+            if (instr.opcode.Value() == OpCode::Id::IFC &&
+                !ReadsWrittenConditions(flow_control, path.written)) {
+                failed = true;
+                return false;
+            }
+            const u32 end = flow_control.dest_offset + flow_control.num_instructions;
+            Path else_path = path;
+            if (!Call(else_path, flow_control.dest_offset, flow_control.num_instructions, end,
+                      false)) {
+                return false;
+            }
+            pending.push_back(std::move(else_path));
+            return Call(path, pc + 1, flow_control.dest_offset - pc - 1, end, false);
+        }
+
+        case OpCode::Id::LOOP:
+            // The loop counter is set on entry, and the body runs at least once
+            path.written.address |= 0b100;
+            return Call(path, pc + 1, flow_control.dest_offset - pc, flow_control.dest_offset + 1,
+                        true);
+
+        case OpCode::Id::BREAKC: {
+            // The interpreter ignores BREAKC while the JIT leaves the innermost loop
+            if (!ReadsWrittenConditions(flow_control, path.written)) {
+                failed = true;
+                return false;
+            }
+            auto loop = path.scopes.rbegin();
+            while (loop != path.scopes.rend() && !loop->is_loop) {
+                ++loop;
+            }
+            if (loop == path.scopes.rend()) {
+                failed = true;
+                return false;
+            }
+            Path break_path = path;
+            break_path.program_counter = loop->return_address;
+            break_path.scopes.erase(break_path.scopes.begin() + (path.scopes.rend() - loop - 1),
+                                    break_path.scopes.end());
+            pending.push_back(std::move(break_path));
+            ++path.program_counter;
+            return true;
+        }
+
+        default:
+            // Geometry shader instructions and unknown instructions
+            failed = true;
+            return false;
+        }
+    }
+
+    const ProgramCode& program_code;
+    const SwizzleData& swizzle_data;
+
+    std::vector<Path> pending;
+    std::map<std::vector<u32>, WrittenRegisters> visited;
+    std::size_t steps = 0;
+    bool failed = false;
+
+    u16 read_inputs = 0;
+    u64 unwritten_outputs = 0;
+};
+
+} // Anonymous namespace
+
+StateUsage AnalyzeStateUsage(const ShaderSetup& setup, unsigned entry_point) {
+    return StateUsageAnalyzer(setup).Analyze(entry_point);
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,39 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Pica::Shader {
+
+struct ShaderSetup;
+
+/**
+ * Describes which registers of a shader unit a shader may use before writing them. Such registers
+ * hold whatever the previous invocation on the unit left in them, so the output of a shader that
+ * uses them depends on the vertices shaded before.
+ */
+struct StateUsage {
+    /**
+     * Whether the shader may read a temporary, address or conditional code register before writing
+     * it. This is also set for shaders that could not be analyzed.
+     */
+    bool reads_unwritten_registers = true;
+
+    /// Input registers the shader may read, one bit per register
+    u16 read_inputs = 0xFFFF;
+
+    /// Components of the output registers that may be left unwritten, four bits per register
+    u64 unwritten_outputs = ~u64{0};
+};
+
+/**
+ * Finds the registers a shader may use before writing them, over every path through the program,
+ * whatever the values of the uniforms and registers.
+ * @param entry_point Offset of the first instruction of the shader
+ */
+StateUsage AnalyzeStateUsage(const ShaderSetup& setup, unsigned entry_point);
+
+} // namespace Pica::Shader
@@ -27,6 +27,8 @@
 #include "video_core/swrasterizer/lighting.h"
 #include "video_core/swrasterizer/proctex.h"
 #include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/swrasterizer/span.h"
+#include "video_core/swrasterizer/texture_tile_cache.h"
 #include "video_core/swrasterizer/texturing.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
@@ -119,25 +121,65 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/// Converts a screen-space position to the 12.4 fixed point coordinates used by the rasterizer
+static Common::Vec3<Fix12P4> ScreenToRasterizerCoordinates(const Common::Vec3<float24>& vec) {
+    static auto FloatToFix = [](float24 flt) {
+        // TODO: Rounding here is necessary to prevent garbage pixels at
+        //       triangle borders. Is it that the correct solution, though?
+        return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
+    };
+    return Common::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
+}
+
+/// Calculates the pixel-aligned bounding box of a triangle given in rasterizer coordinates
+static ScreenRect GetBoundingBox(const Common::Vec3<Fix12P4> (&vtxpos)[3]) {
+    const auto& regs = g_state.regs;
+
+    u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
+    u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+    u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
+    u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+
+    // Convert the scissor box coordinates to 12.4 fixed point
+    u16 scissor_x1 = (u16)(regs.rasterizer.scissor_test.x1 << 4);
+    u16 scissor_y1 = (u16)(regs.rasterizer.scissor_test.y1 << 4);
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    u16 scissor_x2 = (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4);
+    u16 scissor_y2 = (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4);
+
+    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
+        // Calculate the new bounds
+        min_x = std::max(min_x, scissor_x1);
+        min_y = std::max(min_y, scissor_y1);
+        max_x = std::min(max_x, scissor_x2);
+        max_y = std::min(max_y, scissor_y2);
+    }
+
+    min_x &= Fix12P4::IntMask();
+    min_y &= Fix12P4::IntMask();
+    max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
+    max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
+
+    return {min_x, min_y, max_x, max_y};
+}
+
+ScreenRect GetTriangleBounds(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    const Common::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
+                                          ScreenToRasterizerCoordinates(v1.screenpos),
+                                          ScreenToRasterizerCoordinates(v2.screenpos)};
+    return GetBoundingBox(vtxpos);
+}
+
 /**
  * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
  * culling via recursion.
  */
 static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                    bool reversed = false) {
+                                    const ScreenRect& clip, bool reversed = false) {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
 
     // vertex positions in rasterizer coordinates
-    static auto FloatToFix = [](float24 flt) {
-        // TODO: Rounding here is necessary to prevent garbage pixels at
-        //       triangle borders. Is it that the correct solution, though?
-        return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
-    };
-    static auto ScreenToRasterizerCoordinates = [](const Common::Vec3<float24>& vec) {
-        return Common::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
-    };
-
     Common::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
                                     ScreenToRasterizerCoordinates(v1.screenpos),
                                     ScreenToRasterizerCoordinates(v2.screenpos)};
@@ -145,13 +187,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, clip, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, clip, true);
             return;
         }
 
@@ -160,10 +202,14 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             return;
     }
 
-    u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
-    u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
-    u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
-    u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+    const ScreenRect bounds = GetBoundingBox(vtxpos);
+
+    // Restrict the bounding box to the clip rectangle. Both are pixel aligned, so this visits
+    // exactly the pixel centers inside both of them.
+    const u16 min_x = std::max(bounds.min_x, clip.min_x);
+    const u16 min_y = std::max(bounds.min_y, clip.min_y);
+    const u16 max_x = std::min(bounds.max_x, clip.max_x);
+    const u16 max_y = std::min(bounds.max_y, clip.max_y);
 
     // Convert the scissor box coordinates to 12.4 fixed point
     u16 scissor_x1 = (u16)(regs.rasterizer.scissor_test.x1 << 4);
@@ -172,19 +218,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     u16 scissor_x2 = (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4);
     u16 scissor_y2 = (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4);
 
-    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
-        // Calculate the new bounds
-        min_x = std::max(min_x, scissor_x1);
-        min_y = std::max(min_y, scissor_y1);
-        max_x = std::min(max_x, scissor_x2);
-        max_y = std::min(max_y, scissor_y2);
-    }
-
-    min_x &= Fix12P4::IntMask();
-    min_y &= Fix12P4::IntMask();
-    max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
-    max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
-
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -210,7 +243,46 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
 
-    auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+    // Edge functions evaluating to the barycentric coordinates w0, w1 and w2 including the fill
+    // rule bias, i.e. w0 = bias0 + SignedArea(vtxpos[1], vtxpos[2], pixel) etc.
+    EdgeFunctions edges;
+    const std::array<int, 3> bias{bias0, bias1, bias2};
+    for (std::size_t i = 0; i < 3; ++i) {
+        const auto& from = vtxpos[(i + 1) % 3];
+        const auto& to = vtxpos[(i + 2) % 3];
+        edges.x1[i] = from.x;
+        edges.y1[i] = from.y;
+        edges.dx[i] = to.x - from.x;
+        edges.dy[i] = to.y - from.y;
+        edges.bias[i] = bias[i];
+    }
+    const SpanEvaluator evaluate_span = GetSpanEvaluator();
+    SpanWeights span_weights{};
+
+    // Attributes interpolated a span at a time, the others are interpolated per pixel when needed
+    const SpanInterpolator interpolate_span = GetSpanInterpolator();
+    SpanAttributes span_attributes;
+    TriangleAttributes triangle_attributes;
+    const auto ToFloats = [](float24 attr0, float24 attr1, float24 attr2) {
+        return std::array<float, 3>{attr0.ToFloat32(), attr1.ToFloat32(), attr2.ToFloat32()};
+    };
+    triangle_attributes.w_inverse = ToFloats(v0.pos.w, v1.pos.w, v2.pos.w);
+    triangle_attributes.z = ToFloats(v0.screenpos[2], v1.screenpos[2], v2.screenpos[2]);
+    for (std::size_t i = 0; i < 4; ++i) {
+        triangle_attributes.attributes[i] = ToFloats(v0.color[i], v1.color[i], v2.color[i]);
+    }
+    triangle_attributes.attributes[4] = ToFloats(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
+    triangle_attributes.attributes[5] = ToFloats(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
+    triangle_attributes.attributes[6] = ToFloats(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
+    triangle_attributes.attributes[7] = ToFloats(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
+    triangle_attributes.attributes[8] = ToFloats(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
+    triangle_attributes.attributes[9] = ToFloats(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+    triangle_attributes.depth_scale =
+        float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    triangle_attributes.depth_offset =
+        float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+    triangle_attributes.w_buffer =
+        regs.rasterizer.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering;
 
     auto textures = regs.texturing.GetTextures();
     auto tev_stages = regs.texturing.GetTevStages();
@@ -223,7 +295,20 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
     for (u16 y = min_y + 8; y < max_y; y += 0x10) {
+        u32 span_mask = 0;
+        u32 span_lane = SPAN_WIDTH;
         for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+            // Calculate the barycentric coordinates w0, w1 and w2 of the next SPAN_WIDTH pixels
+            if (span_lane == SPAN_WIDTH) {
+                const u32 span_size = std::min<u32>(SPAN_WIDTH, (max_x - x + 0xF) >> 4);
+                span_mask = evaluate_span(edges, x, y, span_size, span_weights);
+                if (span_mask != 0) {
+                    interpolate_span(triangle_attributes, span_weights, span_size,
+                                     span_attributes);
+                }
+                span_lane = 0;
+            }
+            const u32 lane = span_lane++;
 
             // Do not process the pixel if it's inside the scissor box and the scissor mode is set
             // to Exclude
@@ -232,45 +317,17 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     continue;
             }
 
-            // Calculate the barycentric coordinates w0, w1 and w2
-            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-            int wsum = w0 + w1 + w2;
-
             // If current pixel is not covered by the current primitive
-            if (w0 < 0 || w1 < 0 || w2 < 0)
+            if ((span_mask & (1u << lane)) == 0)
                 continue;
 
-            auto baricentric_coordinates =
-                Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
-                                float24::FromFloat32(static_cast<float>(w1)),
-                                float24::FromFloat32(static_cast<float>(w2)));
-            float24 interpolated_w_inverse =
-                float24::FromFloat32(1.0f) / Common::Dot(w_inverse, baricentric_coordinates);
-
-            // interpolated_z = z / w
-            float interpolated_z_over_w =
-                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                 v2.screenpos[2].ToFloat32() * w2) /
-                wsum;
-
-            // Not fully accurate. About 3 bits in precision are missing.
-            // Z-Buffer (z / w * scale + offset)
-            float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-            float depth_offset =
-                float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-            float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-            // Potentially switch to W-Buffer
-            if (regs.rasterizer.depthmap_enable ==
-                Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                depth *= interpolated_w_inverse.ToFloat32() * wsum;
-            }
-
-            // Clamp the result
-            depth = std::clamp(depth, 0.0f, 1.0f);
+            // Depth, primary color and texture coordinates were interpolated with the span
+            const auto baricentric_coordinates =
+                Common::MakeVec(float24::FromFloat32(span_attributes.b0[lane]),
+                                float24::FromFloat32(span_attributes.b1[lane]),
+                                float24::FromFloat32(span_attributes.b2[lane]));
+            const float24 interpolated_w_inverse = float24::FromFloat32(span_attributes.w[lane]);
+            const float depth = span_attributes.depth[lane];
 
             // Perspective correct attribute interpolation:
             // Attribute values cannot be calculated by simple linear interpolation since
@@ -294,28 +351,18 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 return interpolated_attr_over_w * interpolated_w_inverse;
             };
 
-            Common::Vec4<u8> primary_color{
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() *
-                    255)),
+            const Common::Vec4<u8> primary_color{
+                span_attributes.color[0][lane],
+                span_attributes.color[1][lane],
+                span_attributes.color[2][lane],
+                span_attributes.color[3][lane],
             };
 
             Common::Vec2<float24> uv[3];
-            uv[0].u() = GetInterpolatedAttribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-            uv[0].v() = GetInterpolatedAttribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-            uv[1].u() = GetInterpolatedAttribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-            uv[1].v() = GetInterpolatedAttribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-            uv[2].u() = GetInterpolatedAttribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-            uv[2].v() = GetInterpolatedAttribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+            for (std::size_t i = 0; i < 3; ++i) {
+                uv[i].u() = float24::FromFloat32(span_attributes.uv[2 * i][lane]);
+                uv[i].v() = float24::FromFloat32(span_attributes.uv[2 * i + 1][lane]);
+            }
 
             Common::Vec4<u8> texture_color[4]{};
             for (int i = 0; i < 3; ++i) {
@@ -410,7 +457,8 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
 
                     // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = Texture::LookupTexture(texture_data, s, t, info);
+                    texture_color[i] = TextureTileCache::GetThreadCache().LookupTexture(
+                        texture_address, texture_data, s, t, info);
                 }
 
                 if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -892,7 +940,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 }
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+    ProcessTriangleInternal(v0, v1, v2, UnboundedScreenRect);
+}
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, const ScreenRect& clip) {
+    ProcessTriangleInternal(v0, v1, v2, clip);
 }
 
 } // namespace Pica::Rasterizer
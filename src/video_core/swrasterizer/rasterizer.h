@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/common_types.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Rasterizer {
@@ -39,6 +40,30 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/// Screen-space rectangle in 12.4 fixed point rasterizer coordinates, with exclusive max bounds
+struct ScreenRect {
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
+/// Rectangle that does not restrict rasterization in any way
+constexpr ScreenRect UnboundedScreenRect{0, 0, 0xFFFF, 0xFFFF};
+
+/**
+ * Returns the pixel-aligned rectangle visited when rasterizing the given triangle, including the
+ * effect of an inclusive scissor test.
+ */
+ScreenRect GetTriangleBounds(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/**
+ * Rasterizes only the pixels of the triangle whose centers lie inside the given pixel-aligned
+ * rectangle. Rasterizing a triangle through a set of disjoint rectangles covering the screen is
+ * equivalent to rasterizing it in one piece.
+ */
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, const ScreenRect& clip);
+
 } // namespace Pica::Rasterizer
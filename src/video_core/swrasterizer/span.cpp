@@ -0,0 +1,139 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "common/vector_math.h"
+#include "video_core/pica_types.h"
+#include "video_core/swrasterizer/span.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Pica::Rasterizer {
+
+/// Evaluates an edge function with wrap-around arithmetic
+static s32 EvaluateEdge(const EdgeFunctions& edges, std::size_t i, s32 x, s32 y) {
+    const u32 area = static_cast<u32>(edges.dx[i]) * static_cast<u32>(y - edges.y1[i]) -
+                     static_cast<u32>(edges.dy[i]) * static_cast<u32>(x - edges.x1[i]);
+    return static_cast<s32>(area + static_cast<u32>(edges.bias[i]));
+}
+
+u32 EvaluateSpanScalar(const EdgeFunctions& edges, s32 x, s32 y, u32 count, SpanWeights& weights) {
+    u32 mask = 0;
+    for (u32 i = 0; i < count; ++i, x += 0x10) {
+        const s32 w0 = EvaluateEdge(edges, 0, x, y);
+        const s32 w1 = EvaluateEdge(edges, 1, x, y);
+        const s32 w2 = EvaluateEdge(edges, 2, x, y);
+        weights.w0[i] = w0;
+        weights.w1[i] = w1;
+        weights.w2[i] = w2;
+        if (w0 >= 0 && w1 >= 0 && w2 >= 0)
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+void InterpolateSpanScalar(const TriangleAttributes& triangle, const SpanWeights& weights,
+                           u32 count, SpanAttributes& attributes) {
+    const auto MakeVec24 = [](const std::array<float, 3>& values) {
+        return Common::MakeVec(float24::FromFloat32(values[0]), float24::FromFloat32(values[1]),
+                               float24::FromFloat32(values[2]));
+    };
+    const auto w_inverse = MakeVec24(triangle.w_inverse);
+
+    for (u32 i = 0; i < count; ++i) {
+        const s32 w0 = weights.w0[i];
+        const s32 w1 = weights.w1[i];
+        const s32 w2 = weights.w2[i];
+        const s32 wsum = static_cast<s32>(static_cast<u32>(w0) + static_cast<u32>(w1) +
+                                          static_cast<u32>(w2));
+
+        const auto baricentric_coordinates =
+            Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
+                            float24::FromFloat32(static_cast<float>(w1)),
+                            float24::FromFloat32(static_cast<float>(w2)));
+        const float24 interpolated_w_inverse =
+            float24::FromFloat32(1.0f) / Common::Dot(w_inverse, baricentric_coordinates);
+
+        // interpolated_z = z / w
+        const float interpolated_z_over_w =
+            (triangle.z[0] * w0 + triangle.z[1] * w1 + triangle.z[2] * w2) / wsum;
+
+        // Not fully accurate. About 3 bits in precision are missing.
+        // Z-Buffer (z / w * scale + offset)
+        float depth = interpolated_z_over_w * triangle.depth_scale + triangle.depth_offset;
+        if (triangle.w_buffer) {
+            // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+            depth *= interpolated_w_inverse.ToFloat32() * wsum;
+        }
+
+        attributes.b0[i] = baricentric_coordinates.x.ToFloat32();
+        attributes.b1[i] = baricentric_coordinates.y.ToFloat32();
+        attributes.b2[i] = baricentric_coordinates.z.ToFloat32();
+        attributes.w[i] = interpolated_w_inverse.ToFloat32();
+        attributes.depth[i] = std::clamp(depth, 0.0f, 1.0f);
+
+        // Perspective correct attribute interpolation, see ProcessTriangleInternal
+        const auto GetInterpolatedAttribute = [&](const std::array<float, 3>& attr) {
+            const float24 interpolated_attr_over_w =
+                Common::Dot(MakeVec24(attr), baricentric_coordinates);
+            return (interpolated_attr_over_w * interpolated_w_inverse).ToFloat32();
+        };
+        for (std::size_t c = 0; c < attributes.color.size(); ++c) {
+            attributes.color[c][i] =
+                static_cast<u8>(round(GetInterpolatedAttribute(triangle.attributes[c]) * 255));
+        }
+        for (std::size_t c = 0; c < attributes.uv.size(); ++c) {
+            attributes.uv[c][i] =
+                GetInterpolatedAttribute(triangle.attributes[attributes.color.size() + c]);
+        }
+    }
+}
+
+SpanEvaluator GetBestSpanEvaluator() {
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.avx2)
+        return EvaluateSpanAVX2;
+    if (caps.sse4_1)
+        return EvaluateSpanSSE41;
+#endif
+    return EvaluateSpanScalar;
+}
+
+static std::atomic<SpanEvaluator> span_evaluator{GetBestSpanEvaluator()};
+
+SpanEvaluator GetSpanEvaluator() {
+    return span_evaluator.load(std::memory_order_relaxed);
+}
+
+void SetSpanEvaluator(SpanEvaluator evaluator) {
+    span_evaluator.store(evaluator, std::memory_order_relaxed);
+}
+
+SpanInterpolator GetBestSpanInterpolator() {
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.avx2)
+        return InterpolateSpanAVX2;
+    if (caps.sse4_1)
+        return InterpolateSpanSSE41;
+#endif
+    return InterpolateSpanScalar;
+}
+
+static std::atomic<SpanInterpolator> span_interpolator{GetBestSpanInterpolator()};
+
+SpanInterpolator GetSpanInterpolator() {
+    return span_interpolator.load(std::memory_order_relaxed);
+}
+
+void SetSpanInterpolator(SpanInterpolator interpolator) {
+    span_interpolator.store(interpolator, std::memory_order_relaxed);
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,128 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Pica::Rasterizer {
+
+/// Number of horizontally adjacent pixels evaluated by one call to a SpanEvaluator
+constexpr u32 SPAN_WIDTH = 8;
+
+/**
+ * Edge functions of a triangle in 12.4 fixed point rasterizer coordinates. For a pixel center
+ * (x, y), the barycentric weight belonging to edge i is
+ *     dx[i] * (y - y1[i]) - dy[i] * (x - x1[i]) + bias[i]
+ * which is the signed area spanned by the edge and the pixel center, offset by the fill rule bias.
+ * Arithmetic wraps around on overflow.
+ */
+struct EdgeFunctions {
+    std::array<s32, 3> x1;
+    std::array<s32, 3> y1;
+    std::array<s32, 3> dx;
+    std::array<s32, 3> dy;
+    std::array<s32, 3> bias;
+};
+
+/// Barycentric weights of the pixels of a span
+struct SpanWeights {
+    alignas(32) std::array<s32, SPAN_WIDTH> w0;
+    alignas(32) std::array<s32, SPAN_WIDTH> w1;
+    alignas(32) std::array<s32, SPAN_WIDTH> w2;
+};
+
+/**
+ * Evaluates the edge functions for the `count` pixel centers (x, y), (x + 16, y), ... and returns
+ * a mask with bit i set if the i-th pixel is covered by the triangle, i.e. none of its weights is
+ * negative. Weights are written for all `count` pixels, covered or not.
+ * @pre 0 < count <= SPAN_WIDTH
+ */
+using SpanEvaluator = u32 (*)(const EdgeFunctions& edges, s32 x, s32 y, u32 count,
+                              SpanWeights& weights);
+
+u32 EvaluateSpanScalar(const EdgeFunctions& edges, s32 x, s32 y, u32 count, SpanWeights& weights);
+
+#ifdef ARCHITECTURE_x86_64
+u32 EvaluateSpanSSE41(const EdgeFunctions& edges, s32 x, s32 y, u32 count, SpanWeights& weights);
+u32 EvaluateSpanAVX2(const EdgeFunctions& edges, s32 x, s32 y, u32 count, SpanWeights& weights);
+#endif
+
+/// Number of attributes interpolated by a SpanInterpolator: the primary color's RGBA components,
+/// then the u and v coordinates of the three texture units
+constexpr std::size_t SPAN_NUM_ATTRIBUTES = 10;
+
+/// Per-vertex values of a triangle, interpolated over its pixels by a SpanInterpolator
+struct TriangleAttributes {
+    /// The w component of each vertex position
+    std::array<float, 3> w_inverse;
+    /// The screen space depth of each vertex
+    std::array<float, 3> z;
+    /// Each attribute for each vertex, in the order listed for SPAN_NUM_ATTRIBUTES
+    std::array<std::array<float, 3>, SPAN_NUM_ATTRIBUTES> attributes;
+
+    /// Viewport depth range and near plane, mapping the interpolated depth to the depth buffer
+    float depth_scale;
+    float depth_offset;
+    /// Whether the depth is multiplied by the interpolated w (W-buffering)
+    bool w_buffer;
+};
+
+/// Values interpolated for the pixels of a span, which are float24 values stored as floats
+struct SpanAttributes {
+    /// Barycentric coordinates w0, w1 and w2, converted to floats
+    alignas(32) std::array<float, SPAN_WIDTH> b0;
+    alignas(32) std::array<float, SPAN_WIDTH> b1;
+    alignas(32) std::array<float, SPAN_WIDTH> b2;
+    /// Interpolated w, the inverse of the interpolated w_inverse
+    alignas(32) std::array<float, SPAN_WIDTH> w;
+    /// Depth clamped to [0, 1]
+    alignas(32) std::array<float, SPAN_WIDTH> depth;
+    /// Primary color components scaled to [0, 255] and rounded
+    alignas(32) std::array<std::array<u8, SPAN_WIDTH>, 4> color;
+    /// Perspective corrected texture coordinates u0, v0, u1, v1, u2 and v2
+    alignas(32) std::array<std::array<float, SPAN_WIDTH>, 6> uv;
+};
+
+/**
+ * Interpolates the attributes of a triangle for the first `count` pixels of a span, from their
+ * barycentric weights. Products follow the PICA float24 rule of giving 0 instead of NaN when
+ * multiplying infinity by zero. Uncovered pixels are interpolated as well, and the values past
+ * the first `count` pixels are unspecified.
+ * @pre 0 < count <= SPAN_WIDTH
+ */
+using SpanInterpolator = void (*)(const TriangleAttributes& triangle, const SpanWeights& weights,
+                                  u32 count, SpanAttributes& attributes);
+
+void InterpolateSpanScalar(const TriangleAttributes& triangle, const SpanWeights& weights,
+                           u32 count, SpanAttributes& attributes);
+
+#ifdef ARCHITECTURE_x86_64
+void InterpolateSpanSSE41(const TriangleAttributes& triangle, const SpanWeights& weights,
+                          u32 count, SpanAttributes& attributes);
+void InterpolateSpanAVX2(const TriangleAttributes& triangle, const SpanWeights& weights,
+                         u32 count, SpanAttributes& attributes);
+#endif
+
+/// Returns the fastest span evaluator supported by the host CPU
+SpanEvaluator GetBestSpanEvaluator();
+
+/// Returns the span evaluator used by the rasterizer
+SpanEvaluator GetSpanEvaluator();
+
+/// Overrides the span evaluator used by the rasterizer, for example to compare implementations
+void SetSpanEvaluator(SpanEvaluator evaluator);
+
+/// Returns the fastest span interpolator supported by the host CPU
+SpanInterpolator GetBestSpanInterpolator();
+
+/// Returns the span interpolator used by the rasterizer
+SpanInterpolator GetSpanInterpolator();
+
+/// Overrides the span interpolator used by the rasterizer, for example to compare implementations
+void SetSpanInterpolator(SpanInterpolator interpolator);
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,117 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <immintrin.h>
+#include "video_core/swrasterizer/span.h"
+
+namespace Pica::Rasterizer {
+
+/// Evaluates an edge function for eight pixel centers with wrap-around arithmetic
+static __m256i EvaluateEdge(const EdgeFunctions& edges, std::size_t i, __m256i x, s32 y) {
+    const u32 row_term = static_cast<u32>(edges.dx[i]) * static_cast<u32>(y - edges.y1[i]) +
+                         static_cast<u32>(edges.bias[i]);
+    const __m256i x_term = _mm256_mullo_epi32(_mm256_set1_epi32(edges.dy[i]),
+                                              _mm256_sub_epi32(x, _mm256_set1_epi32(edges.x1[i])));
+    return _mm256_sub_epi32(_mm256_set1_epi32(static_cast<s32>(row_term)), x_term);
+}
+
+u32 EvaluateSpanAVX2(const EdgeFunctions& edges, s32 x, s32 y, u32 count, SpanWeights& weights) {
+    static_assert(SPAN_WIDTH == 8);
+
+    const __m256i xs = _mm256_add_epi32(
+        _mm256_set1_epi32(x), _mm256_setr_epi32(0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70));
+    const __m256i w0 = EvaluateEdge(edges, 0, xs, y);
+    const __m256i w1 = EvaluateEdge(edges, 1, xs, y);
+    const __m256i w2 = EvaluateEdge(edges, 2, xs, y);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(weights.w0.data()), w0);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(weights.w1.data()), w1);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(weights.w2.data()), w2);
+
+    // A pixel is not covered if the sign bit of any of its weights is set
+    const __m256i any = _mm256_or_si256(_mm256_or_si256(w0, w1), w2);
+    const u32 negative = static_cast<u32>(_mm256_movemask_ps(_mm256_castsi256_ps(any)));
+
+    return ~negative & ((1u << count) - 1);
+}
+
+/// Multiplies float24 values, which gives 0 instead of NaN when multiplying infinity by zero
+static __m256 MulFloat24(__m256 a, __m256 b) {
+    const __m256 product = _mm256_mul_ps(a, b);
+    const __m256 inf_times_zero = _mm256_and_ps(_mm256_cmp_ps(product, product, _CMP_UNORD_Q),
+                                                _mm256_cmp_ps(a, b, _CMP_ORD_Q));
+    return _mm256_andnot_ps(inf_times_zero, product);
+}
+
+/// Computes the float24 dot product of per-vertex values with the barycentric coordinates
+static __m256 DotFloat24(const std::array<float, 3>& values, __m256 b0, __m256 b1, __m256 b2) {
+    const __m256 sum = _mm256_add_ps(MulFloat24(_mm256_set1_ps(values[0]), b0),
+                                     MulFloat24(_mm256_set1_ps(values[1]), b1));
+    return _mm256_add_ps(sum, MulFloat24(_mm256_set1_ps(values[2]), b2));
+}
+
+/// Rounds halfway cases away from zero like std::round, which _mm256_round_ps can't
+static __m256 RoundHalfAway(__m256 x) {
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 truncated = _mm256_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    // Subtracting the truncated value is exact
+    const __m256 fraction = _mm256_andnot_ps(sign_mask, _mm256_sub_ps(x, truncated));
+    const __m256 one = _mm256_or_ps(_mm256_set1_ps(1.0f), _mm256_and_ps(sign_mask, x));
+    const __m256 halfway = _mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+    return _mm256_add_ps(truncated, _mm256_and_ps(halfway, one));
+}
+
+void InterpolateSpanAVX2(const TriangleAttributes& triangle, const SpanWeights& weights,
+                         u32 count, SpanAttributes& attributes) {
+    static_assert(SPAN_WIDTH == 8);
+
+    const __m256i w0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights.w0.data()));
+    const __m256i w1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights.w1.data()));
+    const __m256i w2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights.w2.data()));
+    const __m256 b0 = _mm256_cvtepi32_ps(w0);
+    const __m256 b1 = _mm256_cvtepi32_ps(w1);
+    const __m256 b2 = _mm256_cvtepi32_ps(w2);
+    const __m256 wsum = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(w0, w1), w2));
+    const __m256 w =
+        _mm256_div_ps(_mm256_set1_ps(1.0f), DotFloat24(triangle.w_inverse, b0, b1, b2));
+
+    // The depth products are plain float ones, as in the scalar interpolator
+    __m256 z_over_w = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(triangle.z[0]), b0),
+                                    _mm256_mul_ps(_mm256_set1_ps(triangle.z[1]), b1));
+    z_over_w = _mm256_div_ps(
+        _mm256_add_ps(z_over_w, _mm256_mul_ps(_mm256_set1_ps(triangle.z[2]), b2)), wsum);
+    __m256 depth = _mm256_add_ps(_mm256_mul_ps(z_over_w, _mm256_set1_ps(triangle.depth_scale)),
+                                 _mm256_set1_ps(triangle.depth_offset));
+    if (triangle.w_buffer) {
+        depth = _mm256_mul_ps(depth, _mm256_mul_ps(w, wsum));
+    }
+    // Clamps like std::clamp, which keeps NaN
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    depth = _mm256_blendv_ps(depth, one, _mm256_cmp_ps(one, depth, _CMP_LT_OQ));
+    depth = _mm256_blendv_ps(depth, zero, _mm256_cmp_ps(depth, zero, _CMP_LT_OQ));
+
+    _mm256_store_ps(attributes.b0.data(), b0);
+    _mm256_store_ps(attributes.b1.data(), b1);
+    _mm256_store_ps(attributes.b2.data(), b2);
+    _mm256_store_ps(attributes.w.data(), w);
+    _mm256_store_ps(attributes.depth.data(), depth);
+
+    for (std::size_t c = 0; c < attributes.color.size(); ++c) {
+        const __m256 value = MulFloat24(DotFloat24(triangle.attributes[c], b0, b1, b2), w);
+        const __m256 rounded = RoundHalfAway(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)));
+        // Keeps the low byte, as converting to u8 does
+        const __m256i bytes =
+            _mm256_and_si256(_mm256_cvttps_epi32(rounded), _mm256_set1_epi32(0xFF));
+        const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(bytes),
+                                               _mm256_extracti128_si256(bytes, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(attributes.color[c].data()),
+                         _mm_packus_epi16(words, words));
+    }
+    for (std::size_t c = 0; c < attributes.uv.size(); ++c) {
+        const auto& values = triangle.attributes[attributes.color.size() + c];
+        _mm256_store_ps(attributes.uv[c].data(), MulFloat24(DotFloat24(values, b0, b1, b2), w));
+    }
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,122 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <smmintrin.h>
+#include "video_core/swrasterizer/span.h"
+
+namespace Pica::Rasterizer {
+
+/// Evaluates an edge function for four pixel centers with wrap-around arithmetic
+static __m128i EvaluateEdge(const EdgeFunctions& edges, std::size_t i, __m128i x, s32 y) {
+    const u32 row_term = static_cast<u32>(edges.dx[i]) * static_cast<u32>(y - edges.y1[i]) +
+                         static_cast<u32>(edges.bias[i]);
+    const __m128i x_term = _mm_mullo_epi32(_mm_set1_epi32(edges.dy[i]),
+                                           _mm_sub_epi32(x, _mm_set1_epi32(edges.x1[i])));
+    return _mm_sub_epi32(_mm_set1_epi32(static_cast<s32>(row_term)), x_term);
+}
+
+u32 EvaluateSpanSSE41(const EdgeFunctions& edges, s32 x, s32 y, u32 count, SpanWeights& weights) {
+    static_assert(SPAN_WIDTH == 8);
+
+    u32 negative = 0;
+    for (u32 half = 0; half < 2; ++half) {
+        const __m128i xs = _mm_add_epi32(_mm_set1_epi32(x + static_cast<s32>(half) * 0x40),
+                                         _mm_setr_epi32(0x00, 0x10, 0x20, 0x30));
+        const __m128i w0 = EvaluateEdge(edges, 0, xs, y);
+        const __m128i w1 = EvaluateEdge(edges, 1, xs, y);
+        const __m128i w2 = EvaluateEdge(edges, 2, xs, y);
+        _mm_store_si128(reinterpret_cast<__m128i*>(&weights.w0[half * 4]), w0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(&weights.w1[half * 4]), w1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(&weights.w2[half * 4]), w2);
+
+        // A pixel is not covered if the sign bit of any of its weights is set
+        const __m128i any = _mm_or_si128(_mm_or_si128(w0, w1), w2);
+        negative |= static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(any))) << (half * 4);
+    }
+
+    return ~negative & ((1u << count) - 1);
+}
+
+/// Multiplies float24 values, which gives 0 instead of NaN when multiplying infinity by zero
+static __m128 MulFloat24(__m128 a, __m128 b) {
+    const __m128 product = _mm_mul_ps(a, b);
+    const __m128 inf_times_zero =
+        _mm_and_ps(_mm_cmpunord_ps(product, product), _mm_cmpord_ps(a, b));
+    return _mm_andnot_ps(inf_times_zero, product);
+}
+
+/// Computes the float24 dot product of per-vertex values with the barycentric coordinates
+static __m128 DotFloat24(const std::array<float, 3>& values, __m128 b0, __m128 b1, __m128 b2) {
+    const __m128 sum = _mm_add_ps(MulFloat24(_mm_set1_ps(values[0]), b0),
+                                  MulFloat24(_mm_set1_ps(values[1]), b1));
+    return _mm_add_ps(sum, MulFloat24(_mm_set1_ps(values[2]), b2));
+}
+
+/// Rounds halfway cases away from zero like std::round, which _mm_round_ps can't
+static __m128 RoundHalfAway(__m128 x) {
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 truncated = _mm_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    // Subtracting the truncated value is exact
+    const __m128 fraction = _mm_andnot_ps(sign_mask, _mm_sub_ps(x, truncated));
+    const __m128 one = _mm_or_ps(_mm_set1_ps(1.0f), _mm_and_ps(sign_mask, x));
+    return _mm_add_ps(truncated,
+                      _mm_and_ps(_mm_cmpge_ps(fraction, _mm_set1_ps(0.5f)), one));
+}
+
+void InterpolateSpanSSE41(const TriangleAttributes& triangle, const SpanWeights& weights,
+                          u32 count, SpanAttributes& attributes) {
+    static_assert(SPAN_WIDTH == 8);
+
+    for (u32 lane = 0; lane < count; lane += 4) {
+        const __m128i w0 = _mm_load_si128(reinterpret_cast<const __m128i*>(&weights.w0[lane]));
+        const __m128i w1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&weights.w1[lane]));
+        const __m128i w2 = _mm_load_si128(reinterpret_cast<const __m128i*>(&weights.w2[lane]));
+        const __m128 b0 = _mm_cvtepi32_ps(w0);
+        const __m128 b1 = _mm_cvtepi32_ps(w1);
+        const __m128 b2 = _mm_cvtepi32_ps(w2);
+        const __m128 wsum = _mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(w0, w1), w2));
+        const __m128 w = _mm_div_ps(_mm_set1_ps(1.0f), DotFloat24(triangle.w_inverse, b0, b1, b2));
+
+        // The depth products are plain float ones, as in the scalar interpolator
+        __m128 z_over_w = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.z[0]), b0),
+                                     _mm_mul_ps(_mm_set1_ps(triangle.z[1]), b1));
+        z_over_w = _mm_div_ps(_mm_add_ps(z_over_w, _mm_mul_ps(_mm_set1_ps(triangle.z[2]), b2)),
+                              wsum);
+        __m128 depth = _mm_add_ps(_mm_mul_ps(z_over_w, _mm_set1_ps(triangle.depth_scale)),
+                                  _mm_set1_ps(triangle.depth_offset));
+        if (triangle.w_buffer) {
+            depth = _mm_mul_ps(depth, _mm_mul_ps(w, wsum));
+        }
+        // Clamps like std::clamp, which keeps NaN
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        depth = _mm_blendv_ps(depth, one, _mm_cmplt_ps(one, depth));
+        depth = _mm_blendv_ps(depth, zero, _mm_cmplt_ps(depth, zero));
+
+        _mm_store_ps(&attributes.b0[lane], b0);
+        _mm_store_ps(&attributes.b1[lane], b1);
+        _mm_store_ps(&attributes.b2[lane], b2);
+        _mm_store_ps(&attributes.w[lane], w);
+        _mm_store_ps(&attributes.depth[lane], depth);
+
+        for (std::size_t c = 0; c < attributes.color.size(); ++c) {
+            const __m128 value = MulFloat24(DotFloat24(triangle.attributes[c], b0, b1, b2), w);
+            const __m128 rounded = RoundHalfAway(_mm_mul_ps(value, _mm_set1_ps(255.0f)));
+            // Keeps the low byte, as converting to u8 does
+            const __m128i bytes =
+                _mm_and_si128(_mm_cvttps_epi32(rounded), _mm_set1_epi32(0xFF));
+            const __m128i words = _mm_packus_epi32(bytes, bytes);
+            const s32 packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+            std::memcpy(&attributes.color[c][lane], &packed, sizeof(packed));
+        }
+        for (std::size_t c = 0; c < attributes.uv.size(); ++c) {
+            const auto& values = triangle.attributes[attributes.color.size() + c];
+            _mm_store_ps(&attributes.uv[c][lane],
+                         MulFloat24(DotFloat24(values, b0, b1, b2), w));
+        }
+    }
+}
+
+} // namespace Pica::Rasterizer
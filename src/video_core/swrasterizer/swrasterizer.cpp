@@ -4,13 +4,45 @@
 
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/swrasterizer/texture_tile_cache.h"
+#include "video_core/swrasterizer/tile_binner.h"
+#include "video_core/video_core.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    const u16 num_threads = g_sw_rasterizer_threads;
+    if (num_threads > 1) {
+        binner = std::make_unique<Pica::Rasterizer::TileBinner>(num_threads);
+    }
+}
+
+SWRasterizer::~SWRasterizer() = default;
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+    Pica::Clipper::ProcessTriangle(v0, v1, v2, binner.get());
+}
+
+void SWRasterizer::DrawTriangles() {
+    if (binner) {
+        binner->Flush();
+    }
+    // The draw may have rendered into a texture
+    Pica::Rasterizer::TextureTileCache::InvalidateAll();
+}
+
+void SWRasterizer::InvalidateRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::TextureTileCache::InvalidateAll();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::TextureTileCache::InvalidateAll();
+}
+
+void SWRasterizer::ClearAll(bool flush) {
+    Pica::Rasterizer::TextureTileCache::InvalidateAll();
 }
 
 } // namespace VideoCore
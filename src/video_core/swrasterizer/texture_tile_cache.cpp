@@ -0,0 +1,54 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include "video_core/swrasterizer/texture_tile_cache.h"
+
+namespace Pica::Rasterizer {
+
+/// Incremented to invalidate all caches. Entries start out with generation 0, which is never used.
+static std::atomic<u32> current_generation{1};
+
+TextureTileCache::TextureTileCache() : entries(NUM_ENTRIES) {}
+
+TextureTileCache& TextureTileCache::GetThreadCache() {
+    thread_local TextureTileCache cache;
+    return cache;
+}
+
+void TextureTileCache::InvalidateAll() {
+    u32 generation = current_generation.load(std::memory_order_relaxed);
+    if (++generation == 0) {
+        generation = 1;
+    }
+    current_generation.store(generation, std::memory_order_relaxed);
+}
+
+Common::Vec4<u8> TextureTileCache::LookupTexture(PAddr address, const u8* source, unsigned int x,
+                                                 unsigned int y,
+                                                 const Texture::TextureInfo& info) {
+    const unsigned int coarse_x = x / 8;
+    const unsigned int coarse_y = y / 8;
+    const std::size_t tile_offset =
+        coarse_y * info.stride + coarse_x * Texture::CalculateTileSize(info.format);
+    const PAddr tile_address = address + static_cast<PAddr>(tile_offset);
+
+    // Tiles are at least 32 bytes large
+    const std::size_t index = ((tile_address >> 5) ^ (tile_address >> 14)) % NUM_ENTRIES;
+    const u32 generation = current_generation.load(std::memory_order_relaxed);
+    Entry& entry = entries[index];
+    if (entry.generation != generation || entry.address != tile_address ||
+        entry.format != info.format) {
+        const u32 tile_x = coarse_x * 8;
+        const u32 tile_y = coarse_y * 8;
+        Texture::DecodeTextureRect(info, source, entry.texels[0].AsArray(),
+                                   {tile_x, tile_y, tile_x + 8, tile_y + 8});
+        entry.address = tile_address;
+        entry.format = info.format;
+        entry.generation = generation;
+    }
+    return entry.texels[(y % 8) * 8 + x % 8];
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,59 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Pica::Rasterizer {
+
+/**
+ * Cache of decoded 8x8 texture tiles for the texel fetches of the software rasterizer, so that
+ * each tile is decoded once instead of on every sample. This matters most for ETC1, where sampling
+ * a single texel decodes a whole block.
+ *
+ * Every rasterizer thread has its own cache. The software rasterizer invalidates the caches of all
+ * threads after each draw, since a draw may render into a texture sampled by the next one, and
+ * from its InvalidateRegion hooks.
+ */
+class TextureTileCache {
+public:
+    TextureTileCache();
+
+    /// Returns the cache of the calling thread
+    static TextureTileCache& GetThreadCache();
+
+    /// Invalidates the caches of all threads
+    static void InvalidateAll();
+
+    /**
+     * Looks up the texel at the given coordinates, decoding its tile if it is not cached.
+     * @param address Physical address of the texture, used to identify its tiles
+     * @param source Pointer to the texture data at address
+     * @param x,y Texture coordinates to read from
+     * @param info TextureInfo describing the texture setup
+     */
+    Common::Vec4<u8> LookupTexture(PAddr address, const u8* source, unsigned int x, unsigned int y,
+                                   const Texture::TextureInfo& info);
+
+private:
+    static constexpr std::size_t NUM_ENTRIES = 512;
+
+    struct Entry {
+        PAddr address = 0;
+        TexturingRegs::TextureFormat format{};
+        /// The entry is valid if this matches the current invalidation generation
+        u32 generation = 0;
+        std::array<Common::Vec4<u8>, 8 * 8> texels;
+    };
+
+    std::vector<Entry> entries;
+};
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,81 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "video_core/swrasterizer/tile_binner.h"
+
+namespace Pica::Rasterizer {
+
+MICROPROFILE_DEFINE(GPU_TileBinning, "GPU", "Tile Binning", MP_RGB(50, 100, 240));
+
+TileBinner::TileBinner(std::size_t num_threads)
+    : bins(NUM_TILES), thread_pool(num_threads, "SWRasterizer") {}
+
+TileBinner::~TileBinner() = default;
+
+void TileBinner::AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    const ScreenRect bounds = GetTriangleBounds(v0, v1, v2);
+
+    // Bounds are pixel aligned 12.4 fixed point values with exclusive max coordinates
+    const u32 min_x = bounds.min_x >> 4;
+    const u32 min_y = bounds.min_y >> 4;
+    const u32 max_x = bounds.max_x >> 4;
+    const u32 max_y = bounds.max_y >> 4;
+    if (min_x >= max_x || min_y >= max_y)
+        return;
+
+    const u32 index = static_cast<u32>(triangles.size());
+    triangles.push_back({v0, v1, v2});
+
+    for (u32 tile_y = min_y / TILE_SIZE; tile_y <= (max_y - 1) / TILE_SIZE; ++tile_y) {
+        for (u32 tile_x = min_x / TILE_SIZE; tile_x <= (max_x - 1) / TILE_SIZE; ++tile_x) {
+            const u32 tile = tile_y * TILES_PER_ROW + tile_x;
+            if (bins[tile].empty()) {
+                active_tiles.push_back(tile);
+            }
+            bins[tile].push_back(index);
+        }
+    }
+}
+
+void TileBinner::Flush() {
+    if (active_tiles.empty()) {
+        triangles.clear();
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_TileBinning);
+
+    thread_pool.ParallelFor(active_tiles.size(), [this](std::size_t i) {
+        const u32 tile = active_tiles[i];
+        const u32 tile_x = tile % TILES_PER_ROW;
+        const u32 tile_y = tile / TILES_PER_ROW;
+
+        // The last row and column of tiles end at the edge of the 12.4 coordinate space, which
+        // is not representable as an exclusive u16 bound
+        const auto TileStart = [](u32 tile_coord) {
+            return static_cast<u16>((tile_coord * TILE_SIZE) << 4);
+        };
+        const auto TileEnd = [](u32 tile_coord) -> u16 {
+            if (tile_coord + 1 == TILES_PER_ROW)
+                return 0xFFFF;
+            return static_cast<u16>(((tile_coord + 1) * TILE_SIZE) << 4);
+        };
+        const ScreenRect clip{TileStart(tile_x), TileStart(tile_y), TileEnd(tile_x),
+                              TileEnd(tile_y)};
+
+        for (const u32 index : bins[tile]) {
+            const Triangle& triangle = triangles[index];
+            ProcessTriangle(triangle.v0, triangle.v1, triangle.v2, clip);
+        }
+    });
+
+    for (const u32 tile : active_tiles) {
+        bins[tile].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,57 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Pica::Rasterizer {
+
+/**
+ * Defers rasterization of the triangles of a draw by sorting them into screen-space tiles, which
+ * are then shaded in parallel. Each tile draws its triangles in submission order and tiles never
+ * share a pixel, so the framebuffer contents are identical to rasterizing the triangles serially.
+ *
+ * All triangles queued between two calls to Flush must be drawn with the same Pica state, which
+ * holds as long as Flush is called at the end of every draw.
+ */
+class TileBinner {
+public:
+    /// Size of a tile in pixels along each axis
+    static constexpr u32 TILE_SIZE = 32;
+
+    explicit TileBinner(std::size_t num_threads);
+    ~TileBinner();
+
+    /// Queues a triangle for rasterization
+    void AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+    /// Rasterizes all queued triangles and returns once the framebuffer has been updated
+    void Flush();
+
+private:
+    /// Rasterizer coordinates span 4096 pixels in each direction
+    static constexpr u32 TILES_PER_ROW = 4096 / TILE_SIZE;
+    static constexpr u32 NUM_TILES = TILES_PER_ROW * TILES_PER_ROW;
+
+    struct Triangle {
+        Vertex v0;
+        Vertex v1;
+        Vertex v2;
+    };
+
+    std::vector<Triangle> triangles;
+    /// Indices into triangles of the triangles overlapping each tile, in submission order
+    std::vector<std::vector<u32>> bins;
+    /// Tiles with at least one triangle queued
+    std::vector<u32> active_tiles;
+
+    Common::ThreadPool thread_pool;
+};
+
+} // namespace Pica::Rasterizer
@@ -115,6 +115,51 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    void DecodeAll(std::array<Common::Vec3<u8>, 16>& texels) const {
+        // Each half of the subtile has its own base color and modifier table
+        std::array<Common::Vec3<int>, 2> base;
+        if (differential_mode) {
+            const Common::Vec3<int> first{static_cast<int>(differential.r),
+                                          static_cast<int>(differential.g),
+                                          static_cast<int>(differential.b)};
+            const Common::Vec3<int> second{first.r() + static_cast<int>(differential.dr),
+                                           first.g() + static_cast<int>(differential.dg),
+                                           first.b() + static_cast<int>(differential.db)};
+            for (std::size_t half = 0; half < 2; ++half) {
+                const auto& color = half == 0 ? first : second;
+                base[half] = {Color::Convert5To8(static_cast<u8>(color.r())),
+                              Color::Convert5To8(static_cast<u8>(color.g())),
+                              Color::Convert5To8(static_cast<u8>(color.b()))};
+            }
+        } else {
+            base[0] = {Color::Convert4To8(static_cast<u8>(separate.r1)),
+                       Color::Convert4To8(static_cast<u8>(separate.g1)),
+                       Color::Convert4To8(static_cast<u8>(separate.b1))};
+            base[1] = {Color::Convert4To8(static_cast<u8>(separate.r2)),
+                       Color::Convert4To8(static_cast<u8>(separate.g2)),
+                       Color::Convert4To8(static_cast<u8>(separate.b2))};
+        }
+        const std::array<unsigned, 2> table_indices{static_cast<unsigned>(table_index_1.Value()),
+                                                    static_cast<unsigned>(table_index_2.Value())};
+
+        for (unsigned y = 0; y < 4; ++y) {
+            for (unsigned x = 0; x < 4; ++x) {
+                const unsigned texel = 4 * x + y;
+                const std::size_t half = (flip ? y : x) >= 2 ? 1 : 0;
+
+                int modifier = etc1_modifier_table[table_indices[half]][GetTableSubIndex(texel)];
+                if (GetNegationFlag(texel))
+                    modifier *= -1;
+
+                const auto apply = [modifier](int value) {
+                    return static_cast<u8>(std::clamp(value + modifier, 0, 255));
+                };
+                texels[x + 4 * y] = {apply(base[half].r()), apply(base[half].g()),
+                                     apply(base[half].b())};
+            }
+        }
+    }
 };
 
 } // anonymous namespace
@@ -124,4 +169,9 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::array<Common::Vec3<u8>, 16>& texels) {
+    ETC1Tile tile{value};
+    tile.DecodeAll(texels);
+}
+
 } // namespace Pica::Texture
@@ -2,6 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -211,6 +217,302 @@ Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned in
     }
 }
 
+namespace {
+
+/// RGBA8 texels of a tile, with red in the lowest byte
+using TileTexels = std::array<u32, TILE_SIZE>;
+
+/// Decodes the texels of a tile in the order they are stored in, i.e. Morton order
+using MortonKernel = void (*)(const u8* source, u32* texels);
+
+u32 PackRGBA(const Common::Vec4<u8>& color) {
+    return color.r() | (color.g() << 8) | (color.b() << 16) | (u32{color.a()} << 24);
+}
+
+/// Reorders texels decoded in Morton order into rows of increasing y
+void UnswizzleTile(const TileTexels& morton, TileTexels& texels) {
+    // Every four consecutive texels form a 2x2 block
+    for (u32 block = 0; block < TILE_SIZE / 4; ++block) {
+        const u32 x = ((block & 1) << 1) | (block & 4);
+        const u32 y = (block & 2) | ((block & 8) >> 1);
+        std::memcpy(&texels[y * 8 + x], &morton[block * 4], 2 * sizeof(u32));
+        std::memcpy(&texels[(y + 1) * 8 + x], &morton[block * 4 + 2], 2 * sizeof(u32));
+    }
+}
+
+void DecodeTileRGB8(const u8* source, u32* texels) {
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        texels[i] = PackRGBA(Color::DecodeRGB8(source + i * 3));
+    }
+}
+
+void DecodeTileETC1(const u8* source, bool has_alpha, TileTexels& texels) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+    std::array<Common::Vec3<u8>, 16> colors;
+    for (u32 subtile = 0; subtile < ETC1_SUBTILES; ++subtile) {
+        const u8* subtile_ptr = source + subtile * subtile_size;
+        u64_le packed_alpha = 0xFFFFFFFFFFFFFFFF;
+        if (has_alpha) {
+            std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+        u64_le subtile_data;
+        std::memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, colors);
+
+        const u32 base_x = (subtile % 2) * 4;
+        const u32 base_y = (subtile / 2) * 4;
+        for (u32 y = 0; y < 4; ++y) {
+            for (u32 x = 0; x < 4; ++x) {
+                const u8 alpha = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                const auto& color = colors[x + 4 * y];
+                texels[(base_y + y) * 8 + base_x + x] =
+                    PackRGBA({color.r(), color.g(), color.b(), alpha});
+            }
+        }
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+/// Interleaves 16-bit lanes of red | green << 8 and blue | alpha << 8 into eight RGBA8 texels
+void StoreRGBA(__m128i rg, __m128i ba, u32* texels) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(texels), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(texels + 4), _mm_unpackhi_epi16(rg, ba));
+}
+
+/// Stores sixteen texels from bytes of intensity and alpha
+void StoreIntensityAlpha(__m128i intensity, __m128i alpha, u32* texels) {
+    StoreRGBA(_mm_unpacklo_epi8(intensity, intensity), _mm_unpacklo_epi8(intensity, alpha),
+              texels);
+    StoreRGBA(_mm_unpackhi_epi8(intensity, intensity), _mm_unpackhi_epi8(intensity, alpha),
+              texels + 8);
+}
+
+/// Stores sixteen black texels from bytes of alpha
+void StoreAlpha(__m128i alpha, u32* texels) {
+    const __m128i zero = _mm_setzero_si128();
+    StoreRGBA(zero, _mm_unpacklo_epi8(zero, alpha), texels);
+    StoreRGBA(zero, _mm_unpackhi_epi8(zero, alpha), texels + 8);
+}
+
+/// Expands 16-bit lanes of the given bit width to 8 bits, like Color::Convert*To8
+template <int bits>
+__m128i Expand(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 8 - bits), _mm_srli_epi16(value, 2 * bits - 8));
+}
+
+/// Expands each byte holding a 4-bit value to 8 bits
+__m128i ExpandNibbles(__m128i value) {
+    return _mm_or_si128(value, _mm_slli_epi16(value, 4));
+}
+
+__m128i Load(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+void DecodeTileRGBA8(const u8* source, u32* texels) {
+    const __m128i byte_mask = _mm_set1_epi32(0xFF00);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 4) {
+        // Texels are stored as A, B, G, R bytes, so reverse the bytes of each texel
+        const __m128i value = Load(source + i * 4);
+        const __m128i outer = _mm_or_si128(_mm_srli_epi32(value, 24), _mm_slli_epi32(value, 24));
+        const __m128i inner = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(value, 8), byte_mask),
+                                           _mm_slli_epi32(_mm_and_si128(value, byte_mask), 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(texels + i), _mm_or_si128(outer, inner));
+    }
+}
+
+void DecodeTileRGB5A1(const u8* source, u32* texels) {
+    const __m128i mask = _mm_set1_epi16(0x1F);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i alpha_mask = _mm_set1_epi16(static_cast<s16>(0xFF00));
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i pixel = Load(source + i * 2);
+        const __m128i r = Expand<5>(_mm_srli_epi16(pixel, 11));
+        const __m128i g = Expand<5>(_mm_and_si128(_mm_srli_epi16(pixel, 6), mask));
+        const __m128i b = Expand<5>(_mm_and_si128(_mm_srli_epi16(pixel, 1), mask));
+        const __m128i a = _mm_and_si128(
+            _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(pixel, one)), alpha_mask);
+        StoreRGBA(_mm_or_si128(r, _mm_slli_epi16(g, 8)), _mm_or_si128(b, a), texels + i);
+    }
+}
+
+void DecodeTileRGB565(const u8* source, u32* texels) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    const __m128i alpha = _mm_set1_epi16(static_cast<s16>(0xFF00));
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i pixel = Load(source + i * 2);
+        const __m128i r = Expand<5>(_mm_srli_epi16(pixel, 11));
+        const __m128i g = Expand<6>(_mm_and_si128(_mm_srli_epi16(pixel, 5), mask6));
+        const __m128i b = Expand<5>(_mm_and_si128(pixel, mask5));
+        StoreRGBA(_mm_or_si128(r, _mm_slli_epi16(g, 8)), _mm_or_si128(b, alpha), texels + i);
+    }
+}
+
+void DecodeTileRGBA4(const u8* source, u32* texels) {
+    const __m128i mask = _mm_set1_epi16(0xF);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i pixel = Load(source + i * 2);
+        const __m128i r = Expand<4>(_mm_srli_epi16(pixel, 12));
+        const __m128i g = Expand<4>(_mm_and_si128(_mm_srli_epi16(pixel, 8), mask));
+        const __m128i b = Expand<4>(_mm_and_si128(_mm_srli_epi16(pixel, 4), mask));
+        const __m128i a = Expand<4>(_mm_and_si128(pixel, mask));
+        StoreRGBA(_mm_or_si128(r, _mm_slli_epi16(g, 8)), _mm_or_si128(b, _mm_slli_epi16(a, 8)),
+                  texels + i);
+    }
+}
+
+void DecodeTileIA8(const u8* source, u32* texels) {
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        // Alpha is stored in the first byte, intensity in the second
+        const __m128i pixel = Load(source + i * 2);
+        const __m128i intensity = _mm_srli_epi16(pixel, 8);
+        StoreRGBA(_mm_or_si128(intensity, _mm_slli_epi16(intensity, 8)),
+                  _mm_or_si128(intensity, _mm_slli_epi16(pixel, 8)), texels + i);
+    }
+}
+
+void DecodeTileRG8(const u8* source, u32* texels) {
+    const __m128i alpha = _mm_set1_epi16(static_cast<s16>(0xFF00));
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        // Green is stored in the first byte, red in the second
+        const __m128i pixel = Load(source + i * 2);
+        StoreRGBA(_mm_or_si128(_mm_srli_epi16(pixel, 8), _mm_slli_epi16(pixel, 8)), alpha,
+                  texels + i);
+    }
+}
+
+void DecodeTileI8(const u8* source, u32* texels) {
+    const __m128i alpha = _mm_set1_epi8(static_cast<s8>(0xFF));
+    for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+        StoreIntensityAlpha(Load(source + i), alpha, texels + i);
+    }
+}
+
+void DecodeTileA8(const u8* source, u32* texels) {
+    for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+        StoreAlpha(Load(source + i), texels + i);
+    }
+}
+
+void DecodeTileIA4(const u8* source, u32* texels) {
+    const __m128i mask = _mm_set1_epi8(0xF);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+        // Intensity is stored in the upper nibble, alpha in the lower one
+        const __m128i pixel = Load(source + i);
+        const __m128i intensity = ExpandNibbles(_mm_and_si128(_mm_srli_epi16(pixel, 4), mask));
+        const __m128i alpha = ExpandNibbles(_mm_and_si128(pixel, mask));
+        StoreIntensityAlpha(intensity, alpha, texels + i);
+    }
+}
+
+/// Decodes 4-bit texels, storing thirty-two of them at a time through the store function
+template <void (*store)(__m128i, u32*)>
+void DecodeTile4Bit(const u8* source, u32* texels) {
+    const __m128i mask = _mm_set1_epi8(0xF);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 32) {
+        // The first texel of each byte is stored in the lower nibble
+        const __m128i pixel = Load(source + i / 2);
+        const __m128i low = _mm_and_si128(pixel, mask);
+        const __m128i high = _mm_and_si128(_mm_srli_epi16(pixel, 4), mask);
+        store(ExpandNibbles(_mm_unpacklo_epi8(low, high)), texels + i);
+        store(ExpandNibbles(_mm_unpackhi_epi8(low, high)), texels + i + 16);
+    }
+}
+
+void StoreIntensity(__m128i intensity, u32* texels) {
+    StoreIntensityAlpha(intensity, _mm_set1_epi8(static_cast<s8>(0xFF)), texels);
+}
+
+MortonKernel GetMortonKernel(TextureFormat format) {
+    switch (format) {
+    case TextureFormat::RGBA8:
+        return DecodeTileRGBA8;
+    case TextureFormat::RGB8:
+        return DecodeTileRGB8;
+    case TextureFormat::RGB5A1:
+        return DecodeTileRGB5A1;
+    case TextureFormat::RGB565:
+        return DecodeTileRGB565;
+    case TextureFormat::RGBA4:
+        return DecodeTileRGBA4;
+    case TextureFormat::IA8:
+        return DecodeTileIA8;
+    case TextureFormat::RG8:
+        return DecodeTileRG8;
+    case TextureFormat::I8:
+        return DecodeTileI8;
+    case TextureFormat::A8:
+        return DecodeTileA8;
+    case TextureFormat::IA4:
+        return DecodeTileIA4;
+    case TextureFormat::I4:
+        return DecodeTile4Bit<StoreIntensity>;
+    case TextureFormat::A4:
+        return DecodeTile4Bit<StoreAlpha>;
+    default:
+        return nullptr;
+    }
+}
+
+#else
+
+MortonKernel GetMortonKernel(TextureFormat format) {
+    return format == TextureFormat::RGB8 ? DecodeTileRGB8 : nullptr;
+}
+
+#endif
+
+/// Decodes a tile into rows of increasing y
+void DecodeTile(const u8* source, const TextureInfo& info, TileTexels& texels) {
+    if (info.format == TextureFormat::ETC1 || info.format == TextureFormat::ETC1A4) {
+        DecodeTileETC1(source, info.format == TextureFormat::ETC1A4, texels);
+        return;
+    }
+
+    if (const MortonKernel kernel = GetMortonKernel(info.format)) {
+        TileTexels morton;
+        kernel(source, morton.data());
+        UnswizzleTile(morton, texels);
+        return;
+    }
+
+    for (unsigned int y = 0; y < 8; ++y) {
+        for (unsigned int x = 0; x < 8; ++x) {
+            texels[y * 8 + x] = PackRGBA(LookupTexelInTile(source, x, y, info, false));
+        }
+    }
+}
+
+} // Anonymous namespace
+
+void DecodeTextureRect(const TextureInfo& info, const u8* source, u8* dest,
+                       const Common::Rectangle<u32>& rect) {
+    const std::size_t tile_size = CalculateTileSize(info.format);
+    const u32 width = rect.right - rect.left;
+
+    TileTexels texels;
+    for (u32 tile_y = rect.top & ~7; tile_y < rect.bottom; tile_y += 8) {
+        const u8* line = source + (tile_y / 8) * info.stride;
+        const u32 begin_y = std::max(tile_y, rect.top);
+        const u32 end_y = std::min(tile_y + 8, rect.bottom);
+
+        for (u32 tile_x = rect.left & ~7; tile_x < rect.right; tile_x += 8) {
+            DecodeTile(line + (tile_x / 8) * tile_size, info, texels);
+
+            const u32 begin_x = std::max(tile_x, rect.left);
+            const u32 end_x = std::min(tile_x + 8, rect.right);
+            for (u32 y = begin_y; y < end_y; ++y) {
+                u8* dest_row = dest + ((y - rect.top) * width + (begin_x - rect.left)) * 4;
+                std::memcpy(dest_row, &texels[(y - tile_y) * 8 + (begin_x - tile_x)],
+                            (end_x - begin_x) * 4);
+            }
+        }
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
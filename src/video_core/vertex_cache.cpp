@@ -0,0 +1,49 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/pica_state.h"
+#include "video_core/vertex_cache.h"
+
+namespace Pica {
+
+VertexCacheKey::VertexCacheKey(State& pica_state, const VertexLoader& loader,
+                               PAddr base_address) {
+    const auto& vs_regs = pica_state.regs.vs;
+
+    state.loader = loader.GetConfig().state;
+    state.base_address = base_address;
+    state.program_code_hash = pica_state.vs.GetProgramCodeHash();
+    state.swizzle_data_hash = pica_state.vs.GetSwizzleDataHash();
+    state.main_offset = vs_regs.main_offset;
+    state.max_input_attribute_index = vs_regs.max_input_attribute_index;
+    state.input_attribute_to_register_map_low = vs_regs.input_attribute_to_register_map_low;
+    state.input_attribute_to_register_map_high =
+        vs_regs.input_attribute_to_register_map_high;
+    state.output_mask = vs_regs.output_mask;
+    state.uniforms = pica_state.vs.uniforms;
+    state.default_attributes = pica_state.input_default_attributes;
+}
+
+VertexCache::VertexCache() : entries(NUM_SETS * NUM_WAYS) {
+    Invalidate();
+}
+
+VertexCache::~VertexCache() = default;
+
+void VertexCache::BeginDraw(const VertexCacheKey& new_key) {
+    if (!key || *key != new_key) {
+        Invalidate();
+        key = new_key;
+    }
+    hits = 0;
+    misses = 0;
+}
+
+void VertexCache::Invalidate() {
+    tags.fill(INVALID_TAG);
+    next_way.fill(0);
+    key.reset();
+}
+
+} // namespace Pica
@@ -0,0 +1,107 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+struct State;
+
+/// Draw state that determines the vertex shader output for a given vertex index
+struct VertexCacheKeyRaw {
+    VertexLoaderConfigRaw loader;
+    PAddr base_address;
+    u64 program_code_hash;
+    u64 swizzle_data_hash;
+    u32 main_offset;
+    u32 max_input_attribute_index;
+    u32 input_attribute_to_register_map_low;
+    u32 input_attribute_to_register_map_high;
+    u32 output_mask;
+    Shader::Uniforms uniforms;
+    Shader::AttributeBuffer default_attributes;
+};
+
+struct VertexCacheKey : Common::HashableStruct<VertexCacheKeyRaw> {
+    VertexCacheKey(State& pica_state, const VertexLoader& loader, PAddr base_address);
+};
+
+/**
+ * Set-associative cache of vertex shader outputs for indexed draws, tagged with the vertex index.
+ * Consecutive draws with the same VertexCacheKey share the cached vertices, which is only valid as
+ * long as the vertex data in memory does not change, so the cache must be invalidated whenever the
+ * emulated CPU may have run.
+ */
+class VertexCache {
+public:
+    /// Number of sets, indexed by the low bits of the vertex index
+    static constexpr std::size_t NUM_SETS = 64;
+    /// Number of vertices per set, replaced in FIFO order
+    static constexpr std::size_t NUM_WAYS = 4;
+
+    VertexCache();
+    ~VertexCache();
+
+    /// Prepares the cache for a draw, dropping all cached vertices if the key has changed
+    void BeginDraw(const VertexCacheKey& key);
+
+    /// Drops all cached vertices
+    void Invalidate();
+
+    /// Returns the cached output of the vertex, or nullptr if the vertex is not cached
+    const Shader::AttributeBuffer* Lookup(u32 vertex) {
+        const std::size_t set = vertex % NUM_SETS;
+        for (std::size_t way = 0; way < NUM_WAYS; ++way) {
+            if (tags[set * NUM_WAYS + way] == vertex) {
+                ++hits;
+                return &entries[set * NUM_WAYS + way];
+            }
+        }
+        ++misses;
+        return nullptr;
+    }
+
+    /// Stores the output of a vertex, evicting the oldest vertex of its set
+    void Insert(u32 vertex, const Shader::AttributeBuffer& output) {
+        const std::size_t set = vertex % NUM_SETS;
+        const std::size_t slot = set * NUM_WAYS + next_way[set];
+        tags[slot] = vertex;
+        entries[slot] = output;
+        next_way[set] = static_cast<u8>((next_way[set] + 1) % NUM_WAYS);
+    }
+
+    /// Number of lookups that hit since the last call to BeginDraw
+    u32 GetHits() const {
+        return hits;
+    }
+
+    /// Number of lookups that missed since the last call to BeginDraw
+    u32 GetMisses() const {
+        return misses;
+    }
+
+private:
+    /// Tag of an empty slot, vertex indices are at most 16 bits wide
+    static constexpr u32 INVALID_TAG = 0xFFFFFFFF;
+
+    std::array<u32, NUM_SETS * NUM_WAYS> tags;
+    std::array<u8, NUM_SETS> next_way;
+    std::vector<Shader::AttributeBuffer> entries;
+
+    std::optional<VertexCacheKey> key;
+
+    u32 hits = 0;
+    u32 misses = 0;
+};
+
+} // namespace Pica
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <unordered_map>
 #include <boost/range/algorithm/fill.hpp>
 #include "common/alignment.h"
 #include "common/assert.h"
@@ -13,20 +16,36 @@
 #include "video_core/regs_pipeline.h"
 #include "video_core/shader/shader.h"
 #include "video_core/vertex_loader.h"
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif // ARCHITECTURE_x86_64
 #include "video_core/video_core.h"
 
 namespace Pica {
 
-void VertexLoader::Setup(const PipelineRegs& regs) {
-    ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
+#ifdef ARCHITECTURE_x86_64
+static std::unordered_map<VertexLoaderConfig, std::unique_ptr<VertexLoaderJit>> jit_cache;
+#endif // ARCHITECTURE_x86_64
+
+static u32 GetFormatSizeInBytes(PipelineRegs::VertexAttributeFormat format) {
+    switch (format) {
+    case PipelineRegs::VertexAttributeFormat::FLOAT:
+        return 4;
+    case PipelineRegs::VertexAttributeFormat::SHORT:
+        return 2;
+    default:
+        return 1;
+    }
+}
 
+VertexLoaderConfig::VertexLoaderConfig(const PipelineRegs& regs) {
     const auto& attribute_config = regs.vertex_attributes;
-    num_total_attributes = attribute_config.GetNumTotalAttributes();
+    state.num_total_attributes = attribute_config.GetNumTotalAttributes();
 
-    boost::fill(vertex_attribute_sources, 0xdeadbeef);
+    boost::fill(state.sources, 0xdeadbeef);
 
     for (int i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
+        state.is_default[i] = attribute_config.IsDefaultAttribute(i);
     }
 
     // Setup attribute data from loaders
@@ -48,12 +67,10 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
             if (attribute_index < 12) {
                 offset = Common::AlignUp(offset,
                                          attribute_config.GetElementSizeInBytes(attribute_index));
-                vertex_attribute_sources[attribute_index] = loader_config.data_offset + offset;
-                vertex_attribute_strides[attribute_index] =
-                    static_cast<u32>(loader_config.byte_count);
-                vertex_attribute_formats[attribute_index] =
-                    attribute_config.GetFormat(attribute_index);
-                vertex_attribute_elements[attribute_index] =
+                state.sources[attribute_index] = loader_config.data_offset + offset;
+                state.strides[attribute_index] = static_cast<u32>(loader_config.byte_count);
+                state.formats[attribute_index] = attribute_config.GetFormat(attribute_index);
+                state.elements[attribute_index] =
                     attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
             } else if (attribute_index < 16) {
@@ -67,38 +84,104 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
             }
         }
     }
+}
+
+void VertexLoader::Setup(const PipelineRegs& regs) {
+    ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
+
+    config = VertexLoaderConfig(regs);
+
+#ifdef ARCHITECTURE_x86_64
+    if (VideoCore::g_shader_jit_enabled) {
+        auto& loader = jit_cache[config];
+        if (loader == nullptr) {
+            loader = std::make_unique<VertexLoaderJit>(config.state);
+        }
+        jit = loader.get();
+    }
+#endif // ARCHITECTURE_x86_64
 
     is_setup = true;
 }
 
+void VertexLoader::ClearJitCache() {
+#ifdef ARCHITECTURE_x86_64
+    jit_cache.clear();
+#endif // ARCHITECTURE_x86_64
+}
+
+#ifdef ARCHITECTURE_x86_64
+void VertexLoader::SetupJitPointers(u32 base_address) {
+    jit_base_address = base_address;
+    jit_pointers_valid = true;
+    jit_max_vertex = std::numeric_limits<s64>::max();
+
+    const auto& attribs = config.state;
+    for (int i = 0; i < attribs.num_total_attributes; ++i) {
+        if (attribs.elements[i] == 0)
+            continue;
+
+        const MemoryRef ref =
+            VideoCore::g_memory->GetPhysicalRef(base_address + attribs.sources[i]);
+        const s64 size =
+            static_cast<s64>(attribs.elements[i] * GetFormatSizeInBytes(attribs.formats[i]));
+        if (!ref || static_cast<s64>(ref.GetSize()) < size) {
+            jit_pointers_valid = false;
+            return;
+        }
+
+        jit_pointers[i] = ref.GetPtr();
+        if (attribs.strides[i] != 0) {
+            const s64 max_vertex = (static_cast<s64>(ref.GetSize()) - size) / attribs.strides[i];
+            jit_max_vertex = std::min(jit_max_vertex, max_vertex);
+        }
+    }
+}
+#endif // ARCHITECTURE_x86_64
+
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
                               Shader::AttributeBuffer& input,
                               DebugUtils::MemoryAccessTracker& memory_accesses) {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
-    for (int i = 0; i < num_total_attributes; ++i) {
-        if (vertex_attribute_elements[i] != 0) {
+#ifdef ARCHITECTURE_x86_64
+    // Memory access tracking and vertices reaching past the end of their memory region are left
+    // to the interpreter
+    if (jit && !(g_debug_context && g_debug_context->recorder)) {
+        if (!jit_pointers_valid || base_address != jit_base_address) {
+            SetupJitPointers(base_address);
+        }
+        if (jit_pointers_valid && vertex <= jit_max_vertex) {
+            jit->Load(jit_pointers, static_cast<u32>(vertex), input,
+                      g_state.input_default_attributes);
+            return;
+        }
+    }
+#endif // ARCHITECTURE_x86_64
+
+    LoadVertexInterpreted(base_address, index, vertex, input, memory_accesses);
+}
+
+void VertexLoader::LoadVertexInterpreted(u32 base_address, int index, int vertex,
+                                         Shader::AttributeBuffer& input,
+                                         DebugUtils::MemoryAccessTracker& memory_accesses) {
+    const auto& attribs = config.state;
+    for (int i = 0; i < attribs.num_total_attributes; ++i) {
+        if (attribs.elements[i] != 0) {
             // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+            u32 source_addr = base_address + attribs.sources[i] + attribs.strides[i] * vertex;
 
             if (g_debug_context && Pica::g_debug_context->recorder) {
-                memory_accesses.AddAccess(
-                    source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
-                             ? 4
-                             : (vertex_attribute_formats[i] ==
-                                PipelineRegs::VertexAttributeFormat::SHORT)
-                                   ? 2
-                                   : 1));
+                memory_accesses.AddAccess(source_addr,
+                                          attribs.elements[i] *
+                                              GetFormatSizeInBytes(attribs.formats[i]));
             }
 
-            switch (vertex_attribute_formats[i]) {
+            switch (attribs.formats[i]) {
             case PipelineRegs::VertexAttributeFormat::BYTE: {
                 const s8* srcdata = reinterpret_cast<const s8*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < attribs.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -106,7 +189,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::UBYTE: {
                 const u8* srcdata = reinterpret_cast<const u8*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < attribs.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -114,7 +197,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::SHORT: {
                 const s16* srcdata = reinterpret_cast<const s16*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < attribs.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -122,7 +205,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::FLOAT: {
                 const float* srcdata = reinterpret_cast<const float*>(
                     VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < attribs.elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -132,7 +215,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             // Default attribute values set if array elements have < 4 components. This
             // is *not* carried over from the default attribute settings even if they're
             // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
+            for (unsigned int comp = attribs.elements[i]; comp < 4; ++comp) {
                 input.attr[i][comp] =
                     comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
             }
@@ -140,11 +223,11 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             LOG_TRACE(HW_GPU,
                       "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
                       "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
-                      input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                      input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else if (vertex_attribute_is_default[i]) {
+                      attribs.elements[i], i, vertex, index, base_address, attribs.sources[i],
+                      attribs.strides[i] * vertex, input.attr[i][0].ToFloat32(),
+                      input.attr[i][1].ToFloat32(), input.attr[i][2].ToFloat32(),
+                      input.attr[i][3].ToFloat32());
+        } else if (attribs.is_default[i]) {
             // Load the default attribute if we're configured to do so
             input.attr[i] = g_state.input_default_attributes.attr[i];
             LOG_TRACE(
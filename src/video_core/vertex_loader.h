@@ -1,7 +1,9 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "video_core/regs_pipeline.h"
 
 namespace Pica {
@@ -14,6 +16,25 @@ namespace Shader {
 struct AttributeBuffer;
 }
 
+#ifdef ARCHITECTURE_x86_64
+class VertexLoaderJit;
+#endif // ARCHITECTURE_x86_64
+
+/// Layout of the vertex attributes in memory, as derived from the pipeline registers
+struct VertexLoaderConfigRaw {
+    std::array<u32, 16> sources;
+    std::array<u32, 16> strides;
+    std::array<PipelineRegs::VertexAttributeFormat, 16> formats;
+    std::array<u32, 16> elements;
+    std::array<bool, 16> is_default;
+    int num_total_attributes;
+};
+
+struct VertexLoaderConfig : Common::HashableStruct<VertexLoaderConfigRaw> {
+    VertexLoaderConfig() = default;
+    explicit VertexLoaderConfig(const PipelineRegs& regs);
+};
+
 class VertexLoader {
 public:
     VertexLoader() = default;
@@ -26,17 +47,45 @@ public:
                     DebugUtils::MemoryAccessTracker& memory_accesses);
 
     int GetNumTotalAttributes() const {
-        return num_total_attributes;
+        return config.state.num_total_attributes;
+    }
+
+    const VertexLoaderConfig& GetConfig() const {
+        return config;
     }
 
+    /// Releases all compiled vertex loaders
+    static void ClearJitCache();
+
 private:
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
-    int num_total_attributes = 0;
+    void LoadVertexInterpreted(u32 base_address, int index, int vertex,
+                               Shader::AttributeBuffer& input,
+                               DebugUtils::MemoryAccessTracker& memory_accesses);
+
+    VertexLoaderConfig config;
     bool is_setup = false;
+
+#ifdef ARCHITECTURE_x86_64
+    /// Resolves the host pointers of the attribute arrays for the given base address
+    void SetupJitPointers(u32 base_address);
+
+    const VertexLoaderJit* jit = nullptr;
+    /// Host pointers to the data of vertex 0 of each attribute at jit_base_address
+    std::array<const u8*, 16> jit_pointers{};
+    u32 jit_base_address = 0;
+    /// Highest vertex index whose attribute data lies within mapped memory for all attributes
+    s64 jit_max_vertex = -1;
+    bool jit_pointers_valid = false;
+#endif // ARCHITECTURE_x86_64
 };
 
 } // namespace Pica
+
+namespace std {
+template <>
+struct hash<Pica::VertexLoaderConfig> {
+    std::size_t operator()(const Pica::VertexLoaderConfig& k) const noexcept {
+        return k.Hash();
+    }
+};
+} // namespace std
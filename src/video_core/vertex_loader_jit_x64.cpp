@@ -0,0 +1,104 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+namespace Pica {
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+
+using VertexAttributeFormat = PipelineRegs::VertexAttributeFormat;
+
+/// Upper bound of the code size of a loader handling all 16 attributes
+constexpr std::size_t MAX_LOADER_SIZE = 4096;
+
+/// Offset of an attribute component within an AttributeBuffer
+static int AttributeOffset(int attribute, unsigned component = 0) {
+    return static_cast<int>(attribute * sizeof(Common::Vec4<float24>) +
+                            component * sizeof(float24));
+}
+
+VertexLoaderJit::VertexLoaderJit(const VertexLoaderConfigRaw& config)
+    : Xbyak::CodeGenerator(MAX_LOADER_SIZE) {
+    program = (CompiledLoader*)getCurr();
+
+    // Only caller-saved registers which are not used for argument passing in either the Windows or
+    // the System V ABI serve as scratch registers, so the arguments can stay where they are
+    const Reg64 POINTERS = ABI_PARAM1.cvt64();
+    const Reg64 VERTEX = r11;
+    const Reg64 INPUT = ABI_PARAM3.cvt64();
+    const Reg64 DEFAULTS = ABI_PARAM4.cvt64();
+    const Reg64 SRC = rax;
+    const Reg64 OFFSET = r10;
+    const Reg32 VALUE = r10d;
+
+    // Zero extends the vertex index to 64 bits
+    mov(VERTEX.cvt32(), ABI_PARAM2.cvt32());
+
+    for (int i = 0; i < config.num_total_attributes; ++i) {
+        const u32 elements = config.elements[i];
+        if (elements == 0) {
+            if (config.is_default[i]) {
+                movaps(xmm0, xword[DEFAULTS + AttributeOffset(i)]);
+                movaps(xword[INPUT + AttributeOffset(i)], xmm0);
+            }
+            // Otherwise the attribute keeps its previous value, as in the interpreter
+            continue;
+        }
+
+        mov(SRC, qword[POINTERS + i * sizeof(u8*)]);
+        if (config.strides[i] != 0) {
+            imul(OFFSET, VERTEX, static_cast<int>(config.strides[i]));
+            add(SRC, OFFSET);
+        }
+
+        for (unsigned comp = 0; comp < elements; ++comp) {
+            const auto dest = dword[INPUT + AttributeOffset(i, comp)];
+            switch (config.formats[i]) {
+            case VertexAttributeFormat::BYTE:
+                movsx(VALUE, byte[SRC + comp]);
+                cvtsi2ss(xmm0, VALUE);
+                movss(dest, xmm0);
+                break;
+            case VertexAttributeFormat::UBYTE:
+                movzx(VALUE, byte[SRC + comp]);
+                cvtsi2ss(xmm0, VALUE);
+                movss(dest, xmm0);
+                break;
+            case VertexAttributeFormat::SHORT:
+                movsx(VALUE, word[SRC + comp * sizeof(s16)]);
+                cvtsi2ss(xmm0, VALUE);
+                movss(dest, xmm0);
+                break;
+            case VertexAttributeFormat::FLOAT:
+                // float24 holds a host float, so the data is copied as is
+                mov(VALUE, dword[SRC + comp * sizeof(float)]);
+                mov(dest, VALUE);
+                break;
+            }
+        }
+
+        // Components missing from the array default to (0, 0, 0, 1)
+        for (unsigned comp = elements; comp < 4; ++comp) {
+            const u32 value = comp == 3 ? 0x3F800000 : 0; // 1.0f or 0.0f
+            mov(dword[INPUT + AttributeOffset(i, comp)], value);
+        }
+    }
+
+    ret();
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_LOADER_SIZE,
+               "Compiled a vertex loader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled vertex loader size={}", getSize());
+}
+
+} // namespace Pica
@@ -0,0 +1,47 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+namespace Shader {
+struct AttributeBuffer;
+}
+
+/**
+ * Vertex loader compiled for one attribute layout. It converts the attribute data of a vertex and
+ * writes the complete AttributeBuffer row, including padding components and default attributes.
+ */
+class VertexLoaderJit : public Xbyak::CodeGenerator {
+public:
+    explicit VertexLoaderJit(const VertexLoaderConfigRaw& config);
+
+    /**
+     * Loads a vertex.
+     * @param attribute_pointers Host pointers to the data of vertex 0 of each loaded attribute
+     * @param vertex Index of the vertex to load
+     * @param input Buffer receiving the attributes
+     * @param default_attributes Values of the default attributes
+     */
+    void Load(const std::array<const u8*, 16>& attribute_pointers, u32 vertex,
+              Shader::AttributeBuffer& input,
+              const Shader::AttributeBuffer& default_attributes) const {
+        program(attribute_pointers.data(), vertex, &input, &default_attributes);
+    }
+
+private:
+    using CompiledLoader = void(const u8* const* attribute_pointers, u32 vertex,
+                                Shader::AttributeBuffer* input,
+                                const Shader::AttributeBuffer* default_attributes);
+
+    CompiledLoader* program = nullptr;
+};
+
+} // namespace Pica
@@ -22,10 +22,15 @@ std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
 
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
+std::atomic<u16> g_shader_jit_cache_size;
+std::atomic<bool> g_use_disk_shader_jit_cache;
+std::atomic<bool> g_async_shader_jit;
 std::atomic<bool> g_hw_shader_enabled;
 std::atomic<bool> g_separable_shader_enabled;
 std::atomic<bool> g_hw_shader_accurate_mul;
 std::atomic<bool> g_use_disk_shader_cache;
+std::atomic<u16> g_sw_rasterizer_threads;
+std::atomic<u16> g_vertex_shader_threads;
 std::atomic<bool> g_renderer_bg_color_update_requested;
 std::atomic<bool> g_renderer_sampler_update_requested;
 std::atomic<bool> g_renderer_shader_update_requested;
@@ -30,10 +30,15 @@ extern std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
 // qt ui)
 extern std::atomic<bool> g_hw_renderer_enabled;
 extern std::atomic<bool> g_shader_jit_enabled;
+extern std::atomic<u16> g_shader_jit_cache_size;
+extern std::atomic<bool> g_use_disk_shader_jit_cache;
+extern std::atomic<bool> g_async_shader_jit;
 extern std::atomic<bool> g_hw_shader_enabled;
 extern std::atomic<bool> g_separable_shader_enabled;
 extern std::atomic<bool> g_hw_shader_accurate_mul;
 extern std::atomic<bool> g_use_disk_shader_cache;
+extern std::atomic<u16> g_sw_rasterizer_threads;
+extern std::atomic<u16> g_vertex_shader_threads;
 extern std::atomic<bool> g_renderer_bg_color_update_requested;
 extern std::atomic<bool> g_renderer_sampler_update_requested;
 extern std::atomic<bool> g_renderer_shader_update_requested;